@@ -13,11 +13,14 @@ constexpr auto DEFAULT_SAMPLE_RATE = 48000;
 AudioManager::AudioManager() {
 	m_initialized = false;
 	m_currentWindow = nullptr;
+	m_voicePool = new AudioVoicePool();
 	m_audios = std::unordered_map<std::string, Audio*>();
 	m_audioSamples = std::unordered_map<std::string, AudioSample*>();
 }
 
 AudioManager::~AudioManager() {
+	delete m_voicePool;
+
 	for (auto& it : m_audios) {
 		delete it.second;
 	}
@@ -215,6 +218,10 @@ AudioSample* AudioManager::GetSample(std::string id) {
 	return m_audioSamples[id];
 }
 
+AudioVoicePool* AudioManager::GetVoicePool() {
+	return m_voicePool;
+}
+
 bool AudioManager::Remove(std::string id) {
 	if (m_audios.find(id) == m_audios.end()) {
 		return false;
@@ -236,6 +243,8 @@ bool AudioManager::RemoveSample(std::string id) {
 
 	AudioSample* sample = m_audioSamples[id];
 	if (sample != nullptr) {
+		m_voicePool->Clear();
+
 		delete sample;
 		m_audioSamples.erase(id);
 	}
@@ -244,6 +253,9 @@ bool AudioManager::RemoveSample(std::string id) {
 }
 
 bool AudioManager::RemoveAll() {
+	// Voices point at these samples
+	m_voicePool->Clear();
+
 	for (auto& sample : m_audioSamples) {
 		delete sample.second;
 	}
@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include "Audio.hpp"
 #include "AudioSample.hpp"
+#include "AudioVoicePool.hpp"
 #include <filesystem>
 
 class Window;
@@ -21,6 +22,7 @@ public:
 
 	Audio* Get(std::string id);
 	AudioSample* GetSample(std::string id);
+	AudioVoicePool* GetVoicePool();
 
 	bool Remove(std::string id);
 	bool RemoveSample(std::string id);
@@ -44,6 +46,7 @@ private:
 	AudioSample* m_bootSample;
 
 	Window* m_currentWindow;
+	AudioVoicePool* m_voicePool;
 	std::unordered_map<std::string, Audio*> m_audios;
 	std::unordered_map<std::string, AudioSample*> m_audioSamples;
 };
\ No newline at end of file
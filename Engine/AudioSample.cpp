@@ -1,9 +1,13 @@
 #include "AudioSample.hpp"
 #include <bass.h>
 #include <fstream>
+#include <cstring>
 
 AudioSample::AudioSample(std::string id) {
 	m_silent = false;
+	m_stream = false;
+	m_analyzed = false;
+	m_trimmedLead = 0;
 	m_handle = NULL;
 	m_rate = 1.0;
 	m_vol = 50;
@@ -61,6 +65,15 @@ bool AudioSample::Create(std::filesystem::path path) {
 }
 
 bool AudioSample::CreateFromData(int sampleFlags, int sampleRate, int sampleChannels, int sampleLength, void* sampleData) {
+	if (!CreateFromMemory(sampleFlags, sampleRate, sampleChannels, sampleLength, sampleData)) {
+		return false;
+	}
+
+	delete[] sampleData;
+	return true;
+}
+
+bool AudioSample::CreateFromMemory(int sampleFlags, int sampleRate, int sampleChannels, int sampleLength, const void* sampleData) {
 	m_handle = BASS_SampleCreate(sampleLength, sampleRate, sampleChannels, 10, BASS_MUSIC_PRESCAN | BASS_SAMPLE_OVER_POS | sampleFlags);
 	if (!m_handle) {
 		std::cout << "Failed to create blank sample: " << BASS_ErrorGetCode() << std::endl;
@@ -74,10 +87,72 @@ bool AudioSample::CreateFromData(int sampleFlags, int sampleRate, int sampleChan
 	}
 
 	CheckAudioTime();
-	delete[] sampleData;
 	return true;
 }
 
+bool AudioSample::CreateStream(std::shared_ptr<const std::vector<uint8_t>> data) {
+	if (!data || data->empty()) {
+		return false;
+	}
+
+	/* make sure BASS can open it before any voice tries to */
+	HSTREAM probe = BASS_StreamCreateFile(TRUE, data->data(), 0, data->size(), BASS_STREAM_DECODE);
+	if (!probe) {
+		std::cout << "Failed to initialize STREAM Sample: " << BASS_ErrorGetCode() << std::endl;
+		return false;
+	}
+
+	BASS_StreamFree(probe);
+
+	m_stream = true;
+	m_streamData = data;
+	return true;
+}
+
+DWORD AudioSample::CreateStreamChannel() {
+	if (!m_stream) {
+		return 0;
+	}
+
+	HSTREAM stream = BASS_StreamCreateFile(TRUE, m_streamData->data(), 0, m_streamData->size(), 0);
+	if (stream) {
+		/* only a short ring buffer is decoded ahead of the play position */
+		BASS_ChannelSetAttribute(stream, BASS_ATTRIB_BUFFER, kStreamBufferLength);
+	}
+
+	return stream;
+}
+
+bool AudioSample::IsStream() const {
+	return m_stream;
+}
+
+double AudioSample::GetDuration(const uint8_t* buffer, size_t size) {
+	HSTREAM stream = BASS_StreamCreateFile(TRUE, buffer, 0, size, BASS_STREAM_DECODE);
+	if (!stream) {
+		return 0;
+	}
+
+	QWORD length = BASS_ChannelGetLength(stream, BASS_POS_BYTE);
+	double seconds = length == (QWORD)-1 ? 0 : BASS_ChannelBytes2Seconds(stream, length);
+
+	BASS_StreamFree(stream);
+	return seconds;
+}
+
+double AudioSample::GetDuration(std::filesystem::path path) {
+	HSTREAM stream = BASS_StreamCreateFile(FALSE, path.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_UNICODE);
+	if (!stream) {
+		return 0;
+	}
+
+	QWORD length = BASS_ChannelGetLength(stream, BASS_POS_BYTE);
+	double seconds = length == (QWORD)-1 ? 0 : BASS_ChannelBytes2Seconds(stream, length);
+
+	BASS_StreamFree(stream);
+	return seconds;
+}
+
 bool AudioSample::CreateSilent() {
 	m_silent = true;
 
@@ -92,6 +167,221 @@ std::string AudioSample::GetId() const {
 	return m_id;
 }
 
+DWORD AudioSample::GetHandle() const {
+	return m_handle;
+}
+
+float AudioSample::GetRate() const {
+	return m_rate;
+}
+
+DWORD AudioSample::GetFrequency() const {
+	BASS_SAMPLE info = {};
+	if (m_stream || m_handle == NULL || !BASS_SampleGetInfo(m_handle, &info)) {
+		return 0;
+	}
+
+	return info.freq;
+}
+
+bool AudioSample::IsSilent() const {
+	return m_silent;
+}
+
+bool AudioSample::Export(int& flags, int& frequency, int& channels, std::vector<char>& data) {
+	if (m_silent || m_handle == NULL) {
+		return false;
+	}
+
+	BASS_SAMPLE info = {};
+	if (!BASS_SampleGetInfo(m_handle, &info) || info.length == 0) {
+		return false;
+	}
+
+	data.resize(info.length);
+	if (!BASS_SampleGetData(m_handle, data.data())) {
+		return false;
+	}
+
+	flags = info.flags & (BASS_SAMPLE_8BITS | BASS_SAMPLE_FLOAT);
+	frequency = info.freq;
+	channels = info.chans;
+	return true;
+}
+
+size_t AudioSample::GetSize() const {
+	if (m_stream) {
+		return m_streamData->size();
+	}
+
+	if (m_silent || m_handle == NULL) {
+		return 0;
+	}
+
+	BASS_SAMPLE info = {};
+	if (!BASS_SampleGetInfo(m_handle, &info)) {
+		return 0;
+	}
+
+	return info.length;
+}
+
+double AudioSample::GetLength() const {
+	if (m_stream) {
+		return GetDuration(m_streamData->data(), m_streamData->size()) * 1000.0;
+	}
+
+	if (m_silent || m_handle == NULL) {
+		return 0;
+	}
+
+	BASS_SAMPLE info = {};
+	if (!BASS_SampleGetInfo(m_handle, &info) || info.freq == 0 || info.chans == 0) {
+		return 0;
+	}
+
+	int sampleSize = info.flags & BASS_SAMPLE_8BITS ? 1 : info.flags & BASS_SAMPLE_FLOAT ? 4 : 2;
+	return static_cast<double>(info.length) / (sampleSize * info.chans) * 1000.0 / info.freq;
+}
+
+bool AudioSample::Decode(std::vector<float>& pcm, int& channels, int& frequency) {
+	if (m_stream) {
+		HSTREAM stream = BASS_StreamCreateFile(TRUE, m_streamData->data(), 0, m_streamData->size(), BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+		if (!stream) {
+			return false;
+		}
+
+		BASS_CHANNELINFO info = {};
+		BASS_ChannelGetInfo(stream, &info);
+		channels = info.chans;
+		frequency = info.freq;
+
+		float block[4096];
+		while (true) {
+			DWORD read = BASS_ChannelGetData(stream, block, sizeof(block) | BASS_DATA_FLOAT);
+			if (read == (DWORD)-1 || read == 0) {
+				break;
+			}
+
+			pcm.insert(pcm.end(), block, block + read / sizeof(float));
+		}
+
+		BASS_StreamFree(stream);
+		return !pcm.empty();
+	}
+
+	if (m_silent || m_handle == NULL) {
+		return false;
+	}
+
+	BASS_SAMPLE info = {};
+	if (!BASS_SampleGetInfo(m_handle, &info)) {
+		return false;
+	}
+
+	std::vector<uint8_t> data(info.length);
+	if (!BASS_SampleGetData(m_handle, data.data())) {
+		return false;
+	}
+
+	channels = info.chans;
+	frequency = info.freq;
+
+	if (info.flags & BASS_SAMPLE_FLOAT) {
+		pcm.resize(info.length / sizeof(float));
+		memcpy(pcm.data(), data.data(), pcm.size() * sizeof(float));
+	}
+	else if (info.flags & BASS_SAMPLE_8BITS) {
+		pcm.resize(info.length);
+		for (size_t i = 0; i < pcm.size(); i++) {
+			pcm[i] = (static_cast<int>(data[i]) - 128) / 128.0f;
+		}
+	}
+	else {
+		auto samples = reinterpret_cast<const int16_t*>(data.data());
+		pcm.resize(info.length / sizeof(int16_t));
+		for (size_t i = 0; i < pcm.size(); i++) {
+			pcm[i] = samples[i] / 32768.0f;
+		}
+	}
+
+	return true;
+}
+
+namespace {
+	SampleFormat GetSampleFormat(int flags) {
+		if (flags & BASS_SAMPLE_FLOAT) {
+			return SampleFormat::F32;
+		}
+
+		return (flags & BASS_SAMPLE_8BITS) ? SampleFormat::U8 : SampleFormat::S16;
+	}
+}
+
+bool AudioSample::Analyze() {
+	int flags = 0, frequency = 0, channels = 0;
+	std::vector<char> data;
+	if (m_stream || !Export(flags, frequency, channels, data)) {
+		return false;
+	}
+
+	m_silence = SampleAnalysis::Analyze(data.data(), data.size(), GetSampleFormat(flags), channels);
+	m_analyzed = true;
+	return true;
+}
+
+bool AudioSample::IsAnalyzed() const {
+	return m_analyzed;
+}
+
+const SampleSilence& AudioSample::GetSilence() const {
+	return m_silence;
+}
+
+void AudioSample::SetSilence(const SampleSilence& silence) {
+	m_silence = silence;
+	m_analyzed = true;
+}
+
+bool AudioSample::TrimSilence() {
+	if (!m_analyzed || m_trimmedLead > 0) {
+		return false;
+	}
+
+	int flags = 0, frequency = 0, channels = 0;
+	std::vector<char> data;
+	if (!Export(flags, frequency, channels, data)) {
+		return false;
+	}
+
+	size_t frameSize = static_cast<size_t>(SampleAnalysis::GetSampleSize(GetSampleFormat(flags))) * channels;
+	if (data.size() / frameSize != m_silence.Length) {
+		return false;
+	}
+
+	uint32_t lead = 0, tail = 0;
+	SampleAnalysis::GetTrim(m_silence, frequency, lead, tail);
+	if (lead == 0 && tail == 0) {
+		return false;
+	}
+
+	size_t length = static_cast<size_t>(m_silence.Length - lead - tail) * frameSize;
+	HSAMPLE previous = m_handle;
+
+	if (!CreateFromMemory(flags, frequency, channels, static_cast<int>(length), data.data() + lead * frameSize)) {
+		m_handle = previous;
+		return false;
+	}
+
+	BASS_SampleFree(previous);
+	m_trimmedLead = lead * 1000.0 / frequency;
+	return true;
+}
+
+double AudioSample::GetTrimmedLead() const {
+	return m_trimmedLead;
+}
+
 std::unique_ptr<AudioSampleChannel> AudioSample::CreateChannel() {
 	if (m_silent) {
 		return std::make_unique<AudioSampleChannel>();
@@ -2,7 +2,13 @@
 #include "AudioSampleChannel.hpp"
 #include <iostream>
 #include <filesystem>
+#include <memory>
+#include <vector>
 #include "Data/WindowsTypes.hpp"
+#include "SampleAnalysis.hpp"
+
+// Playback buffer of streamed samples, in seconds
+constexpr float kStreamBufferLength = 0.1f;
 
 class AudioSample {
 public:
@@ -12,10 +18,53 @@ public:
 	bool Create(uint8_t* buffer, size_t size);
 	bool Create(std::filesystem::path path);
 	bool CreateFromData(int sampleFlags, int sampleRate, int sampleChannels, int sampleLength, void* sampleData);
+	/* same as CreateFromData but BASS copies the data, the caller keeps it */
+	bool CreateFromMemory(int sampleFlags, int sampleRate, int sampleChannels, int sampleLength, const void* sampleData);
 	bool CreateSilent();
+
+	/*
+	 * Keeps the compressed data and decodes while playing instead of up front,
+	 * for long BGM keysounds. Every voice playing it gets its own stream.
+	 */
+	bool CreateStream(std::shared_ptr<const std::vector<uint8_t>> data);
+	DWORD CreateStreamChannel();
+	bool IsStream() const;
+
+	/* length of encoded audio in seconds without decoding it, 0 when unknown */
+	static double GetDuration(const uint8_t* buffer, size_t size);
+	static double GetDuration(std::filesystem::path path);
 	void SetRate(double rate);
 
 	std::string GetId() const;
+	DWORD GetHandle() const;
+	float GetRate() const;
+	DWORD GetFrequency() const;
+	bool IsSilent() const;
+
+	/* bytes of sample data held by BASS */
+	size_t GetSize() const;
+
+	/* length of the held audio in ms at rate 1, 0 when silent */
+	double GetLength() const;
+
+	/* copies the decoded sample out as interleaved float PCM */
+	bool Decode(std::vector<float>& pcm, int& channels, int& frequency);
+
+	/* copies the sample data out in its stored format, for CreateFromMemory */
+	bool Export(int& flags, int& frequency, int& channels, std::vector<char>& data);
+
+	/* finds leading and trailing silence, or takes it from the PCM cache */
+	bool Analyze();
+	bool IsAnalyzed() const;
+	const SampleSilence& GetSilence() const;
+	void SetSilence(const SampleSilence& silence);
+
+	/*
+	 * Cuts off the silence found by Analyze. The sound then starts
+	 * GetTrimmedLead() ms (at rate 1) earlier, callers delay it by that much.
+	 */
+	bool TrimSilence();
+	double GetTrimmedLead() const;
 
 	std::unique_ptr<AudioSampleChannel> CreateChannel();
 
@@ -30,4 +79,11 @@ private:
 
 	bool m_silent;
 	bool m_pitch;
+
+	bool m_analyzed;
+	SampleSilence m_silence;
+	double m_trimmedLead;
+
+	bool m_stream;
+	std::shared_ptr<const std::vector<uint8_t>> m_streamData;
 };
\ No newline at end of file
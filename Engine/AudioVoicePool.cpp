@@ -0,0 +1,270 @@
+#include "AudioVoicePool.hpp"
+#include <bass.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "AudioSample.hpp"
+
+AudioVoicePool::AudioVoicePool() : m_commands(kVoiceCommandCapacity), m_signal(0) {
+	m_stealing = VoiceStealing::OLDEST;
+	m_triggerCount = 0;
+	m_dropped = false;
+}
+
+AudioVoicePool::~AudioVoicePool() {
+	Clear();
+}
+
+void AudioVoicePool::Allocate(std::vector<AudioSample*> samples, int voiceCount, VoiceStealing stealing) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	for (auto& voice : m_voices) {
+		StopVoice(voice);
+	}
+
+	m_commands.Clear();
+	m_samples = samples;
+	m_sampleVoice.assign(m_samples.size(), -1);
+	m_voices.assign((std::max)(voiceCount, 1), Voice{ 0, -1, 0, 0 });
+	m_stealing = stealing;
+	m_triggerCount = 0;
+	m_dropped = false;
+}
+
+void AudioVoicePool::Clear() {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	for (auto& voice : m_voices) {
+		StopVoice(voice);
+	}
+
+	m_commands.Clear();
+	m_samples.clear();
+	m_sampleVoice.clear();
+	m_voices.clear();
+}
+
+void AudioVoicePool::SetSample(int index, AudioSample* sample) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (index < 0 || index >= m_samples.size() || m_samples[index] == sample) {
+		return;
+	}
+
+	int voice = m_sampleVoice[index];
+	if (voice != -1) {
+		StopVoice(m_voices[voice]);
+	}
+
+	m_samples[index] = sample;
+}
+
+void AudioVoicePool::Play(int sample, int volume, int pan) {
+	Push({ VoiceCommandType::PLAY, sample, volume, pan });
+}
+
+void AudioVoicePool::Stop(int sample) {
+	Push({ VoiceCommandType::STOP, sample, 0, 0 });
+}
+
+void AudioVoicePool::StopAll() {
+	Push({ VoiceCommandType::STOP_ALL, -1, 0, 0 });
+}
+
+void AudioVoicePool::PauseAll() {
+	Push({ VoiceCommandType::PAUSE_ALL, -1, 0, 0 });
+}
+
+void AudioVoicePool::ResumeAll() {
+	Push({ VoiceCommandType::RESUME_ALL, -1, 0, 0 });
+}
+
+void AudioVoicePool::Process(double timeout) {
+	auto wait = std::chrono::duration<double>(timeout);
+	if (m_signal.try_acquire_for(wait)) {
+		/* several pushes may have signaled, one drain covers all of them */
+		while (m_signal.try_acquire()) {}
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	VoiceCommand command;
+	while (m_commands.TryPop(command)) {
+		Execute(command);
+	}
+}
+
+int AudioVoicePool::GetVoiceCount() {
+	std::lock_guard<std::mutex> lock(m_lock);
+	return static_cast<int>(m_voices.size());
+}
+
+int AudioVoicePool::GetActiveVoices() {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	int count = 0;
+	for (auto& voice : m_voices) {
+		if (voice.Channel && BASS_ChannelIsActive(voice.Channel) == BASS_ACTIVE_PLAYING) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+void AudioVoicePool::Push(VoiceCommand command) {
+	if (!m_commands.TryPush(command)) {
+		if (!m_dropped.exchange(true)) {
+			std::cout << "[AudioVoicePool] Command queue is full, dropping keysound commands" << std::endl;
+		}
+
+		return;
+	}
+
+	m_signal.release();
+}
+
+void AudioVoicePool::Execute(const VoiceCommand& command) {
+	switch (command.Type) {
+		case VoiceCommandType::PLAY: {
+			PlayVoice(command);
+			break;
+		}
+
+		case VoiceCommandType::STOP: {
+			if (command.Sample < 0 || command.Sample >= m_sampleVoice.size()) {
+				break;
+			}
+
+			int index = m_sampleVoice[command.Sample];
+			if (index != -1 && m_voices[index].Channel) {
+				BASS_ChannelStop(m_voices[index].Channel);
+			}
+			break;
+		}
+
+		case VoiceCommandType::STOP_ALL: {
+			for (auto& voice : m_voices) {
+				if (voice.Channel) {
+					BASS_ChannelStop(voice.Channel);
+				}
+			}
+			break;
+		}
+
+		case VoiceCommandType::PAUSE_ALL: {
+			for (auto& voice : m_voices) {
+				if (voice.Channel && BASS_ChannelIsActive(voice.Channel) == BASS_ACTIVE_PLAYING) {
+					BASS_ChannelPause(voice.Channel);
+				}
+			}
+			break;
+		}
+
+		case VoiceCommandType::RESUME_ALL: {
+			for (auto& voice : m_voices) {
+				if (voice.Channel && BASS_ChannelIsActive(voice.Channel) == BASS_ACTIVE_PAUSED) {
+					BASS_ChannelPlay(voice.Channel, FALSE);
+				}
+			}
+			break;
+		}
+	}
+}
+
+void AudioVoicePool::PlayVoice(const VoiceCommand& command) {
+	if (command.Sample < 0 || command.Sample >= m_samples.size()) {
+		return;
+	}
+
+	AudioSample* sample = m_samples[command.Sample];
+	if (sample == nullptr || sample->IsSilent() || m_voices.empty()) {
+		return;
+	}
+
+	/* a sample cuts its own previous trigger, reuse its channel when it still has one */
+	int index = m_sampleVoice[command.Sample];
+	if (index == -1) {
+		index = AcquireVoice();
+
+		Voice& voice = m_voices[index];
+		StopVoice(voice);
+
+		voice.Channel = sample->IsStream()
+			? sample->CreateStreamChannel()
+			: BASS_SampleGetChannel(sample->GetHandle(), 0);
+
+		if (!voice.Channel) {
+			::printf("[BASS] Error: %d\n", BASS_ErrorGetCode());
+			return;
+		}
+
+		voice.Sample = command.Sample;
+		m_sampleVoice[command.Sample] = index;
+
+		BASS_CHANNELINFO info = {};
+		if (sample->GetRate() != 1.0f && BASS_ChannelGetInfo(voice.Channel, &info)) {
+			BASS_ChannelSetAttribute(voice.Channel, BASS_ATTRIB_FREQ, info.freq * sample->GetRate());
+		}
+	}
+
+	Voice& voice = m_voices[index];
+	voice.Volume = command.Volume;
+	voice.Started = ++m_triggerCount;
+
+	BASS_ChannelSetAttribute(voice.Channel, BASS_ATTRIB_VOL, command.Volume / 100.0f);
+	BASS_ChannelSetAttribute(voice.Channel, BASS_ATTRIB_PAN, command.Pan / 100.0f);
+
+	if (!BASS_ChannelPlay(voice.Channel, TRUE)) {
+		::printf("Failed to play index %d\n", command.Sample);
+	}
+}
+
+void AudioVoicePool::StopVoice(Voice& voice) {
+	if (voice.Channel) {
+		BASS_ChannelStop(voice.Channel);
+		BASS_ChannelFree(voice.Channel);
+		voice.Channel = 0;
+	}
+
+	if (voice.Sample != -1 && voice.Sample < m_sampleVoice.size()) {
+		m_sampleVoice[voice.Sample] = -1;
+	}
+
+	voice.Sample = -1;
+	voice.Volume = 0;
+}
+
+int AudioVoicePool::AcquireVoice() {
+	// An empty voice first, then the stopped voice triggered longest ago, so
+	// samples keep their channels attached while the pool has room. Only when
+	// every voice is playing is one stolen.
+	int stopped = -1;
+	int best = 0;
+
+	for (int i = 0; i < m_voices.size(); i++) {
+		auto& voice = m_voices[i];
+		if (!voice.Channel) {
+			return i;
+		}
+
+		if (BASS_ChannelIsActive(voice.Channel) == BASS_ACTIVE_STOPPED) {
+			if (stopped == -1 || voice.Started < m_voices[stopped].Started) {
+				stopped = i;
+			}
+
+			continue;
+		}
+
+		auto& current = m_voices[best];
+		bool better = m_stealing == VoiceStealing::QUIETEST
+			? voice.Volume < current.Volume || (voice.Volume == current.Volume && voice.Started < current.Started)
+			: voice.Started < current.Started;
+
+		if (better) {
+			best = i;
+		}
+	}
+
+	return stopped != -1 ? stopped : best;
+}
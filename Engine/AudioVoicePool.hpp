@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <semaphore>
+#include <vector>
+#include "Threading/MpscQueue.hpp"
+#include "Data/WindowsTypes.hpp"
+
+class AudioSample;
+
+// Size of the trigger queue between game threads and the audio thread
+constexpr int kVoiceCommandCapacity = 4096;
+constexpr int kDefaultVoiceCount = 128;
+
+enum class VoiceStealing {
+	OLDEST,
+	QUIETEST
+};
+
+enum class VoiceCommandType : uint8_t {
+	PLAY,
+	STOP,
+	STOP_ALL,
+	PAUSE_ALL,
+	RESUME_ALL
+};
+
+struct VoiceCommand {
+	VoiceCommandType Type;
+	int Sample;
+	int Volume;
+	int Pan;
+};
+
+/*
+ * Fixed set of keysound voices allocated when a chart loads. Game threads only
+ * push commands into a lock-free queue, the audio thread drains it and owns
+ * every BASS channel. A sample keeps its channel between triggers so a
+ * retrigger is a restart instead of a new channel, and when every voice is busy
+ * one is taken from the oldest or quietest sound.
+ */
+class AudioVoicePool {
+public:
+	AudioVoicePool();
+	~AudioVoicePool();
+
+	/* loading thread, samples are indexed by keysound id, nullptr for gaps */
+	void Allocate(std::vector<AudioSample*> samples, int voiceCount, VoiceStealing stealing);
+	void Clear();
+
+	/* swaps one sample after Allocate, a voice still on the old one is stopped */
+	void SetSample(int index, AudioSample* sample);
+
+	/* any thread */
+	void Play(int sample, int volume, int pan);
+	void Stop(int sample);
+	void StopAll();
+	void PauseAll();
+	void ResumeAll();
+
+	/* audio thread, waits up to `timeout` seconds for commands and runs them */
+	void Process(double timeout);
+
+	int GetVoiceCount();
+	int GetActiveVoices();
+
+private:
+	struct Voice {
+		DWORD Channel;
+		int Sample;
+		int Volume;
+		uint64_t Started;
+	};
+
+	void Push(VoiceCommand command);
+	void Execute(const VoiceCommand& command);
+
+	void PlayVoice(const VoiceCommand& command);
+	void StopVoice(Voice& voice);
+	int AcquireVoice();
+
+	MpscQueue<VoiceCommand> m_commands;
+	std::counting_semaphore<> m_signal;
+
+	/* held by the audio thread while processing and by Allocate/Clear */
+	std::mutex m_lock;
+
+	std::vector<AudioSample*> m_samples;
+	std::vector<int> m_sampleVoice;
+	std::vector<Voice> m_voices;
+	VoiceStealing m_stealing;
+	uint64_t m_triggerCount;
+
+	std::atomic<bool> m_dropped;
+};
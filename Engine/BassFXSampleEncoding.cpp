@@ -1,10 +1,109 @@
 #include "BassFXSampleEncoding.hpp"
+#include "PcmDiskCache.hpp"
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <bass.h>
 #include <bass_fx.h>
 #include <vector>
+#include <iomanip>
+#include <thread>
+#include <cstring>
+
+namespace {
+	// Bump whenever Encode output changes, old cache files are then ignored
+	constexpr int kEncodingVersion = 1;
+	const char kCacheMagic[4] = { 'T', 'M', 'P', 'O' };
+
+	struct CacheHeader {
+		char Magic[4];
+		int Version;
+		int Flags;
+		int Frequency;
+		int Channels;
+		int Length;
+	};
+
+	uint64_t HashData(const void* data, size_t size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = 14695981039346656037ull;
+
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	std::filesystem::path GetCachePath(std::filesystem::path cacheDir, const void* data, size_t size, float rate) {
+		std::stringstream ss;
+		ss << std::hex << std::setfill('0') << std::setw(16) << HashData(data, size)
+			<< std::dec << "_" << size << "_" << static_cast<int>(rate * 1000.0f) << "_v" << kEncodingVersion << ".pcm";
+
+		return cacheDir / ss.str();
+	}
+
+	std::tuple<int, int, int, int, void*> ReadCache(std::filesystem::path path) {
+		std::fstream fs(path, std::ios::binary | std::ios::in);
+		if (!fs.is_open()) {
+			return { 0, 0, 0, 0, nullptr };
+		}
+
+		CacheHeader header = {};
+		fs.read((char*)&header, sizeof(CacheHeader));
+
+		if (!fs || memcmp(header.Magic, kCacheMagic, 4) != 0 || header.Version != kEncodingVersion || header.Length <= 0) {
+			return { 0, 0, 0, 0, nullptr };
+		}
+
+		char* data = new char[header.Length];
+		fs.read(data, header.Length);
+
+		if (fs.gcount() != header.Length) {
+			delete[] data;
+			return { 0, 0, 0, 0, nullptr };
+		}
+
+		return { header.Flags, header.Frequency, header.Channels, header.Length, data };
+	}
+
+	void WriteCache(std::filesystem::path path, const std::tuple<int, int, int, int, void*>& encoded) {
+		CacheHeader header = {};
+		memcpy(header.Magic, kCacheMagic, 4);
+		header.Version = kEncodingVersion;
+		header.Flags = std::get<0>(encoded);
+		header.Frequency = std::get<1>(encoded);
+		header.Channels = std::get<2>(encoded);
+		header.Length = std::get<3>(encoded);
+
+		// Write beside the final name and rename, a crash never leaves a half file behind
+		std::filesystem::path tmpPath = path;
+		tmpPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+		{
+			std::fstream fs(tmpPath, std::ios::binary | std::ios::out | std::ios::trunc);
+			if (!fs.is_open()) {
+				return;
+			}
+
+			fs.write((char*)&header, sizeof(CacheHeader));
+			fs.write((char*)std::get<4>(encoded), header.Length);
+
+			if (!fs.good()) {
+				fs.close();
+				std::filesystem::remove(tmpPath);
+				return;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, path, ec);
+		if (ec) {
+			std::filesystem::remove(tmpPath, ec);
+		}
+	}
+}
 
 std::tuple<int, int, int, int, void*> BASS_FX_SampleEncoding::Encode(void* audioData, size_t size, float rate) {
 	HCHANNEL channel = BASS_StreamCreateFile(TRUE, audioData, 0, size, BASS_STREAM_DECODE);
@@ -55,3 +154,31 @@ std::tuple<int, int, int, int, void*> BASS_FX_SampleEncoding::Encode(void* audio
 	// return tuple: sampleFalgs, sampleRate, sampleChannels, sampleLength, void*
 	return { tempoInfo.flags, tempoInfo.freq, tempoInfo.chans, size2, data2 };
 }
+
+std::tuple<int, int, int, int, void*> BASS_FX_SampleEncoding::EncodeCached(void* audioData, size_t size, float rate, std::filesystem::path cacheDir) {
+	auto path = GetCachePath(cacheDir, audioData, size, rate);
+
+	auto cached = ReadCache(path);
+	if (std::get<4>(cached) != nullptr) {
+		/* write time doubles as the LRU stamp for TrimCache */
+		std::error_code ec;
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+		return cached;
+	}
+
+	auto encoded = Encode(audioData, size, rate);
+	if (std::get<4>(encoded) == nullptr) {
+		return encoded;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(cacheDir, ec);
+	WriteCache(path, encoded);
+
+	return encoded;
+}
+
+void BASS_FX_SampleEncoding::TrimCache(std::filesystem::path cacheDir, uint64_t capacity) {
+	PcmDiskCache::TrimDirectory(cacheDir, ".pcm", capacity);
+}
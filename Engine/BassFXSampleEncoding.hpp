@@ -1,10 +1,22 @@
 #pragma once
+#include <cstdint>
 #include <tuple>
 #include <string>
+#include <filesystem>
+
+// Default size cap of Cache/Tempo, in bytes
+constexpr uint64_t kDefaultTempoCacheCapacity = 1024ull * 1024 * 1024;
 
 namespace BASS_FX_SampleEncoding {
 	// std::tuple<int, int, int, int, void*>
 	// sampleFalgs, sampleRate, sampleChannels, sampleLength, void*
 	std::tuple<int, int, int, int, void*> Encode(void* audioData, size_t size, float rate);
 	std::tuple<int, int, int, int, void*> Encode(std::string filePath, float rate);
+
+	// Same as Encode, but reuses the result from `cacheDir` when the same audio
+	// data was already encoded at this rate. Safe to call from several threads.
+	std::tuple<int, int, int, int, void*> EncodeCached(void* audioData, size_t size, float rate, std::filesystem::path cacheDir);
+
+	// Drops least recently used entries of `cacheDir` until it fits `capacity` bytes
+	void TrimCache(std::filesystem::path cacheDir, uint64_t capacity);
 }
\ No newline at end of file
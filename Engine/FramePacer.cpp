@@ -0,0 +1,151 @@
+#include "FramePacer.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace {
+	// Deadline is restarted from now when a frame is this late (window drag,
+	// breakpoint, loading), instead of rushing frames to catch up.
+	constexpr std::chrono::milliseconds kMaxLag(30);
+
+	double ToMilliseconds(int64_t nanoseconds) {
+		return static_cast<double>(nanoseconds) / 1000000.0;
+	}
+}
+
+FramePacer::FramePacer(std::string name) {
+	m_name = name;
+	m_slack = std::chrono::milliseconds(1);
+
+	m_started = false;
+	m_frameTimes.resize(kFramePacerWindow, 0);
+	m_frameIndex = 0;
+	m_frames = 0;
+	m_overBudget = 0;
+	m_budget = clock::duration::zero();
+}
+
+void FramePacer::SetSlack(double milliseconds) {
+	m_slack = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>((std::max)(milliseconds, 0.0)));
+}
+
+double FramePacer::Wait(double frameRate) {
+	auto now = clock::now();
+	auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / frameRate));
+
+	if (!m_started) {
+		m_started = true;
+		m_deadline = now;
+		m_lastFrame = now;
+		m_workStart = now;
+	}
+
+	auto work = now - m_workStart;
+
+	m_deadline += period;
+	if (now - m_deadline > kMaxLag) {
+		m_deadline = now;
+	}
+
+	auto remaining = m_deadline - now;
+	if (remaining > m_slack) {
+		std::this_thread::sleep_for(remaining - m_slack);
+	}
+
+	while (clock::now() < m_deadline) {
+		std::this_thread::yield();
+	}
+
+	now = clock::now();
+	m_workStart = now;
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		if (work > period) {
+			m_overBudget++;
+		}
+	}
+
+	return Record(now, period);
+}
+
+double FramePacer::Tick() {
+	auto now = clock::now();
+
+	if (!m_started) {
+		m_started = true;
+		m_lastFrame = now;
+		m_workStart = now;
+	}
+
+	return Record(now, clock::duration::zero());
+}
+
+void FramePacer::Reset() {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	std::fill(m_frameTimes.begin(), m_frameTimes.end(), 0);
+	m_frameIndex = 0;
+	m_frames = 0;
+	m_overBudget = 0;
+}
+
+double FramePacer::Record(clock::time_point now, clock::duration budget) {
+	auto frameTime = now - m_lastFrame;
+	m_lastFrame = now;
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		m_frameTimes[m_frameIndex] = std::chrono::duration_cast<std::chrono::nanoseconds>(frameTime).count();
+		m_frameIndex = (m_frameIndex + 1) % m_frameTimes.size();
+		m_frames++;
+		m_budget = budget;
+	}
+
+	return std::chrono::duration<double>(frameTime).count();
+}
+
+FrameStats FramePacer::GetStats() {
+	std::vector<int64_t> samples;
+	FrameStats stats = {};
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		size_t count = static_cast<size_t>((std::min)(m_frames, static_cast<uint64_t>(m_frameTimes.size())));
+		samples.assign(m_frameTimes.begin(), m_frameTimes.begin() + count);
+
+		stats.Budget = ToMilliseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(m_budget).count());
+		stats.Frames = m_frames;
+		stats.OverBudget = m_overBudget;
+	}
+
+	if (samples.empty()) {
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	auto percentile = [&](double p) {
+		size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+		return ToMilliseconds(samples[index]);
+	};
+
+	int64_t total = 0;
+	for (auto sample : samples) {
+		total += sample;
+	}
+
+	stats.Average = ToMilliseconds(total) / samples.size();
+	stats.P50 = percentile(0.50);
+	stats.P95 = percentile(0.95);
+	stats.P99 = percentile(0.99);
+	stats.Max = ToMilliseconds(samples.back());
+
+	return stats;
+}
+
+std::string FramePacer::GetName() const {
+	return m_name;
+}
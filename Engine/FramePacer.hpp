@@ -0,0 +1,66 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Number of most recent frames the percentiles are taken from
+constexpr int kFramePacerWindow = 1024;
+
+struct FrameStats {
+	/* milliseconds */
+	double Budget = 0;
+	double Average = 0;
+	double P50 = 0;
+	double P95 = 0;
+	double P99 = 0;
+	double Max = 0;
+
+	uint64_t Frames = 0;
+	uint64_t OverBudget = 0;
+};
+
+/*
+ * Paces one loop (render, audio, input...) to a target rate using the steady
+ * clock. Waiting sleeps until `slack` before the deadline and spins the rest,
+ * so OS sleep granularity doesn't turn into frame time jitter. Frame times are
+ * kept in a ring for percentiles, GetStats can be called from any thread.
+ */
+class FramePacer {
+public:
+	FramePacer(std::string name);
+
+	void SetSlack(double milliseconds);
+
+	// Wait for the next frame at `frameRate`, returns seconds since the last frame
+	double Wait(double frameRate);
+
+	// Measure only, for loops that block on something else
+	double Tick();
+
+	void Reset();
+
+	FrameStats GetStats();
+	std::string GetName() const;
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	double Record(clock::time_point now, clock::duration budget);
+
+	std::string m_name;
+	clock::duration m_slack;
+
+	bool m_started;
+	clock::time_point m_deadline;
+	clock::time_point m_lastFrame;
+	clock::time_point m_workStart;
+
+	std::mutex m_lock;
+	std::vector<int64_t> m_frameTimes;
+	size_t m_frameIndex;
+	uint64_t m_frames;
+	uint64_t m_overBudget;
+	clock::duration m_budget;
+};
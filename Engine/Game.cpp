@@ -4,6 +4,7 @@
 #include "framework.h"
 #include "Window.hpp"
 #include "AudioManager.hpp"
+#include "SampleCache.hpp"
 #include "Imgui/imgui_impl_sdl2.h"
 #include "FontResources.hpp"
 #include "MsgBox.hpp"
@@ -13,10 +14,13 @@
 #include "Imgui/imgui_impl_sdlrenderer2.h"
 #include "VulkanDriver/VulkanEngine.h"
 #include "MathUtils.hpp"
+#include "Threading/JobSystem.hpp"
+#include <iomanip>
 
 namespace {
-	thread_local double curTick = 0.0;
-	thread_local double lastTick = 0.0;
+	// Longest the input thread sleeps in the OS queue without an event, keeps
+	// message boxes and scene Input running at roughly menu rate.
+	constexpr int kInputWaitTimeout = 16;
 
 	bool InitSDL() {
 		if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
@@ -30,30 +34,17 @@ namespace {
 		SDL_Quit();
 		IMG_Quit();
 	}
-
-	// Improve accuracy frame limiter also fix framedrop if fps limit is enabled
-	double FrameLimit(double MaxFrameRate) {
-		double newTick = SDL_GetTicks();
-		double deltaTick = 1000.0 / MaxFrameRate - (newTick - lastTick);
-
-		if (deltaTick > 0.0) {
-			int delayTicks = static_cast<int>(deltaTick);
-			SDL_Delay(delayTicks);
-			newTick += delayTicks;
-			deltaTick -= delayTicks;
-		}
-
-		lastTick = (deltaTick < -30.0) ? newTick : newTick + deltaTick;
-
-		double delta = (newTick - curTick) / 1000.0;
-		curTick = newTick;
-
-		return delta;
-	}
 }
 
 Game::Game() {
 	m_frameLimit = 60.0;
+	m_tickRate = 1000.0;
+	m_tickAccumulator = 0.0;
+	m_gameplayPacer.SetSlack(0.0);
+	m_frameStatsOverlay = false;
+	m_frameInterval = 0.0;
+	m_frameCount = 0;
+	m_currentFrameCount = 0;
 	m_running = false;
 	m_notify = false;
 
@@ -78,6 +69,8 @@ Game::~Game() {
 	}
 
 	// Release the resources
+	JobSystem::Release();
+	SampleCache::Release();
 	AudioManager::Release();
 	SceneManager::Release();
 	InputManager::Release();
@@ -132,6 +125,9 @@ bool Game::Init() {
 		return false;
 	}
 
+	std::cout << "JobSystem::Create << " << std::endl;
+	JobSystem::GetInstance();
+
 	FontResources::PreloadFontCaches();
 	m_frameText = new Text(13);
 	m_currentFade = 0;
@@ -146,25 +142,41 @@ void Game::Run(double frameRate) {
 	m_frameLimit = frameRate;
 	m_frameLimitMode = FrameLimitMode::MENU;
 
+	// The audio thread sleeps on the keysound queue so triggers are played as
+	// soon as they are pushed, BASS housekeeping still runs at about 60 Hz.
 	mAudioThread.Run([&] {
-		double delta = FrameLimit(60.0);
-		AudioManager::GetInstance()->Update(delta);
+		auto audioManager = AudioManager::GetInstance();
+
+		audioManager->GetVoicePool()->Process(1.0 / 60.0);
+		audioManager->Update(m_audioPacer.Tick());
 	}, true);
 
 	std::mutex m1, m2;
 
+	// Gameplay simulation runs on its own thread at a fixed rate so judgement
+	// and note spawning don't depend on how fast the renderer is going.
+	mGameplayThread.Run([&] {
+		if (m_threadMode == ThreadMode::MULTI_THREAD) {
+			double delta = m_gameplayPacer.Wait(m_tickRate);
+			StepFixedUpdate(delta);
+		}
+		else {
+			m_gameplayPacer.Wait(30.0);
+		}
+	}, true);
+
 	mRenderThread.Run([&] {
 		if (m_threadMode == ThreadMode::MULTI_THREAD) {
 			double delta = 0;
 
 			switch (m_frameLimitMode) {
 				case FrameLimitMode::GAME: {
-					delta = FrameLimit(m_frameLimit);
+					delta = m_renderPacer.Wait(m_frameLimit);
 					break;
 				}
 
 				case FrameLimitMode::MENU: {
-					delta = FrameLimit(60.0);
+					delta = m_renderPacer.Wait(60.0);
 					break;
 				}
 			}
@@ -213,12 +225,14 @@ void Game::Run(double frameRate) {
 						drawList->AddRectFilled(ImVec2(0, 0), MathUtil::ScaleVec2(m_window->GetBufferWidth(), m_window->GetBufferHeight()), IM_COL32(0, 0, 0, a * 255));
 					}
 
+					DrawFPS(delta);
+
 					m_renderer->EndRender();
 				}
 			}
 		}
 		else {
-			FrameLimit(30.0f);
+			m_renderPacer.Wait(30.0);
 		}
 	}, true);
 
@@ -243,22 +257,34 @@ void Game::Run(double frameRate) {
 	m_minimized = false;
 	mLocalThread.Run([&] {
 		double delta = 0;
-		switch (m_frameLimitMode) {
-			case FrameLimitMode::GAME: {
-				delta = FrameLimit(m_threadMode == ThreadMode::MULTI_THREAD ? 1000.0 : m_frameLimit);
-				break;
-			}
+		bool hasEvent = false;
+		SDL_Event event;
 
-			case FrameLimitMode::MENU: {
-				delta = FrameLimit(60.0);
-				break;
+		if (m_threadMode == ThreadMode::MULTI_THREAD) {
+			// Block in the OS until input arrives instead of polling, key events
+			// are only stamped and queued here, gameplay consumes them on its own step.
+			hasEvent = SDL_WaitEventTimeout(&event, kInputWaitTimeout) != 0;
+			delta = m_inputPacer.Tick();
+		}
+		else {
+			switch (m_frameLimitMode) {
+				case FrameLimitMode::GAME: {
+					delta = m_inputPacer.Wait(m_frameLimit);
+					break;
+				}
+
+				case FrameLimitMode::MENU: {
+					delta = m_inputPacer.Wait(60.0);
+					break;
+				}
 			}
+
+			hasEvent = SDL_PollEvent(&event) != 0;
 		}
 
 		m_imguiInterval += delta;
 
-		SDL_Event event;
-		while (SDL_PollEvent(&event)) {
+		while (hasEvent) {
 			switch (event.type) {
 			case SDL_QUIT:
 				MsgBox::Show("Quit", "Quit confirmation", "Are you sure you want to quit?", MsgBoxType::YESNO);
@@ -268,6 +294,8 @@ void Game::Run(double frameRate) {
 			m_minimized = SDL_GetWindowFlags(m_window->GetWindow()) & SDL_WINDOW_MINIMIZED;
 			ImGui_ImplSDL2_ProcessEvent(&event);
 			m_inputManager->Update(event);
+
+			hasEvent = SDL_PollEvent(&event) != 0;
 		}
 
 		if (MsgBox::GetResult("Quit") == 1) {
@@ -302,6 +330,7 @@ void Game::Run(double frameRate) {
 
 			Input(delta);
 
+			StepFixedUpdate(delta);
 			Update(delta);
 
 			if (static_cast<int>(m_currentFade) != static_cast<int>(m_targetFade)) {
@@ -333,6 +362,8 @@ void Game::Run(double frameRate) {
 						drawList->AddRectFilled(ImVec2(0, 0), MathUtil::ScaleVec2(m_window->GetBufferWidth(), m_window->GetBufferHeight()), IM_COL32(0, 0, 0, a * 255));
 					}
 
+					DrawFPS(delta);
+
 					m_renderer->EndRender();
 				}
 			}
@@ -344,8 +375,18 @@ void Game::Run(double frameRate) {
 	}
 
 	mAudioThread.Stop();
+	mGameplayThread.Stop();
 	mRenderThread.Stop();
 
+	for (auto pacer : { &m_renderPacer, &m_audioPacer, &m_inputPacer, &m_gameplayPacer }) {
+		FrameStats stats = pacer->GetStats();
+
+		std::cout << "[FramePacer] " << pacer->GetName() << std::fixed << std::setprecision(2)
+			<< ": frames=" << stats.Frames
+			<< " avg=" << stats.Average << "ms p50=" << stats.P50 << "ms p95=" << stats.P95
+			<< "ms p99=" << stats.P99 << "ms max=" << stats.Max << "ms over=" << stats.OverBudget << std::endl;
+	}
+
 	m_notify = false;
 }
 
@@ -369,6 +410,21 @@ void Game::SetFramelimit(double frameRate) {
 	m_frameLimit = frameRate;
 }
 
+void Game::SetTickRate(double tickRate) {
+	m_tickRate = tickRate;
+}
+
+void Game::SetFrameSlack(double milliseconds) {
+	// Gameplay keeps sleeping only, its accumulator already absorbs wake-up jitter
+	m_renderPacer.SetSlack(milliseconds);
+	m_audioPacer.SetSlack(milliseconds);
+	m_inputPacer.SetSlack(milliseconds);
+}
+
+void Game::SetFrameStatsOverlay(bool enabled) {
+	m_frameStatsOverlay = enabled;
+}
+
 void Game::SetBufferSize(int width, int height) {
 	m_bufferWidth = width;
 	m_bufferHeight = height;
@@ -387,6 +443,10 @@ GameThread* Game::GetRenderThread() {
 	return &mRenderThread;
 }
 
+GameThread* Game::GetGameplayThread() {
+	return &mGameplayThread;
+}
+
 GameThread* Game::GetMainThread() {
 	return &mLocalThread;
 }
@@ -403,10 +463,30 @@ ThreadMode Game::GetThreadMode() {
 	return m_threadMode;
 }
 
+FrameStats Game::GetFrameStats(PacedThread thread) {
+	switch (thread) {
+		case PacedThread::AUDIO:
+			return m_audioPacer.GetStats();
+
+		case PacedThread::INPUT:
+			return m_inputPacer.GetStats();
+
+		case PacedThread::GAMEPLAY:
+			return m_gameplayPacer.GetStats();
+
+		default:
+			return m_renderPacer.GetStats();
+	}
+}
+
 void Game::Update(double deltaTime) {
 
 }
 
+void Game::FixedUpdate(double deltaTime) {
+
+}
+
 void Game::Render(double deltaTime) {
 
 }
@@ -419,6 +499,22 @@ void Game::Mouse(double deltaTime) {
 
 }
 
+void Game::StepFixedUpdate(double delta) {
+	double step = 1.0 / m_tickRate;
+
+	// A long stall (loading, window drag) would otherwise be replayed as
+	// thousands of steps, drop it and carry on from one step.
+	m_tickAccumulator += delta;
+	if (m_tickAccumulator > 1.0) {
+		m_tickAccumulator = step;
+	}
+
+	while (m_tickAccumulator >= step) {
+		FixedUpdate(step);
+		m_tickAccumulator -= step;
+	}
+}
+
 void Game::DrawFPS(double delta) {
 	m_frameInterval += delta;
 	m_frameCount += 1;
@@ -428,19 +524,43 @@ void Game::DrawFPS(double delta) {
 
 		m_currentFrameCount = m_frameCount;
 		m_frameCount = 0;
+
+		// Percentiles sort the whole window, so they follow the once a second counter
+		if (m_frameStatsOverlay) {
+			FramePacer* pacers[] = { &m_renderPacer, &m_audioPacer, &m_inputPacer, &m_gameplayPacer };
+			for (int i = 0; i < 4; i++) {
+				m_overlayStats[i] = pacers[i]->GetStats();
+			}
+		}
+	}
+
+	if (!m_frameStatsOverlay) {
+		return;
 	}
 
+	ImU32 color = IM_COL32(255, 255, 255, 255);
 	if (m_currentFrameCount >= 35 && m_currentFrameCount < 60) {
-		m_frameText->Color3 = Color3(1.0f, 0.8f, 0.0f);
+		color = IM_COL32(255, 204, 0, 255);
 	}
 	else if (m_currentFrameCount >= 0 && m_currentFrameCount < 35) {
-		m_frameText->Color3 = Color3(1.0f, 0.0f, 0.0f);
-	}
-	else {
-		m_frameText->Color3 = Color3(1.0f, 1.0f, 1.0f);
+		color = IM_COL32(255, 0, 0, 255);
 	}
 
-	m_frameText->Position = UDim2::fromOffset(5, 5);
-	m_frameText->DrawOverEverything = true;
-	//m_frameText->Draw("FPS: " + std::to_string(m_currentFrameCount));
+	auto drawList = ImGui::GetForegroundDrawList();
+	ImVec2 pos = MathUtil::ScaleVec2(5, 5);
+	float lineHeight = ImGui::GetFontSize();
+
+	char line[160];
+	snprintf(line, sizeof(line), "FPS: %d", m_currentFrameCount);
+	drawList->AddText(pos, color, line);
+
+	const char* names[] = { "Render", "Audio", "Input", "Gameplay" };
+	for (int i = 0; i < 4; i++) {
+		const FrameStats& stats = m_overlayStats[i];
+		snprintf(line, sizeof(line), "%-8s p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms  over %llu",
+			names[i], stats.P50, stats.P95, stats.P99, stats.Max, static_cast<unsigned long long>(stats.OverBudget));
+
+		pos.y += lineHeight;
+		drawList->AddText(pos, stats.P99 > stats.Budget && stats.Budget > 0 ? IM_COL32(255, 204, 0, 255) : IM_COL32(255, 255, 255, 255), line);
+	}
 }
@@ -6,6 +6,7 @@
 #include "Text.hpp"
 #include "ResizableImage.hpp"
 #include "Threading/GameThread.hpp"
+#include "FramePacer.hpp"
 
 enum class ThreadMode {
 	SINGLE_THREAD,
@@ -17,6 +18,13 @@ enum class FrameLimitMode {
 	GAME
 };
 
+enum class PacedThread {
+	RENDER,
+	AUDIO,
+	INPUT,
+	GAMEPLAY
+};
+
 class Game {
 public:
 	Game();
@@ -30,20 +38,26 @@ public:
 	void SetRenderMode(RendererMode mode);
 	void SetFrameLimitMode(FrameLimitMode mode);
 	void SetFramelimit(double frameRate);
+	void SetTickRate(double tickRate);
+	void SetFrameSlack(double milliseconds);
+	void SetFrameStatsOverlay(bool enabled);
 
 	void SetBufferSize(int width, int height);
 	void SetWindowSize(int width, int height);
 	void SetFullscreen(bool fullscreen);
 
 	GameThread* GetRenderThread();
+	GameThread* GetGameplayThread();
 	GameThread* GetMainThread();
 
 	void DisplayFade(int transparency);
 	float GetDisplayFade();
 	ThreadMode GetThreadMode();
+	FrameStats GetFrameStats(PacedThread thread);
 	
 protected:
 	virtual void Update(double deltaTime);
+	virtual void FixedUpdate(double deltaTime);
 	virtual void Render(double deltaTime);
 	virtual void Input(double deltaTime);
 	virtual void Mouse(double deltaTime);
@@ -55,10 +69,13 @@ protected:
 
 private:
 	void DrawFPS(double delta);
+	void StepFixedUpdate(double delta);
 	double m_frameInterval;
 	double m_imguiInterval;
 	int m_frameCount;
 	int m_currentFrameCount;
+	bool m_frameStatsOverlay;
+	FrameStats m_overlayStats[4];
 	float m_currentFade;
 	float m_targetFade;
 
@@ -68,6 +85,8 @@ private:
 	bool m_fullscreen;
 
 	double m_frameLimit;
+	double m_tickRate;
+	double m_tickAccumulator;
 
 	int m_bufferWidth, m_bufferHeight;
 	int m_windowWidth, m_windowHeight;
@@ -77,9 +96,15 @@ private:
 	FrameLimitMode m_frameLimitMode;
 
 	GameThread mRenderThread;
+	GameThread mGameplayThread;
 	GameThread mAudioThread;
 	GameThread mLocalThread;
 
+	FramePacer m_renderPacer{ "Render" };
+	FramePacer m_audioPacer{ "Audio" };
+	FramePacer m_inputPacer{ "Input" };
+	FramePacer m_gameplayPacer{ "Gameplay" };
+
 	Text* m_frameText;
 	ResizableImage* m_fadeBox;
 };
\ No newline at end of file
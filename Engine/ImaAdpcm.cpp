@@ -0,0 +1,159 @@
+#include "ImaAdpcm.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	const int kIndexTable[16] = {
+		-1, -1, -1, -1, 2, 4, 6, 8,
+		-1, -1, -1, -1, 2, 4, 6, 8
+	};
+
+	const int kStepTable[89] = {
+		7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+		19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+		50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+		130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+		337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+		876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+		2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+		5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+		15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+	};
+
+	// Bytes per block for each channel, 2041 frames per block at this size
+	constexpr int kChannelBlockSize = 1024;
+
+	struct Channel {
+		int Predictor;
+		int Index;
+	};
+
+	int16_t ToPCM16(float value) {
+		return static_cast<int16_t>(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+	}
+
+	uint8_t EncodeNibble(Channel& channel, int sample) {
+		int step = kStepTable[channel.Index];
+		int diff = sample - channel.Predictor;
+
+		uint8_t nibble = 0;
+		if (diff < 0) {
+			nibble = 8;
+			diff = -diff;
+		}
+
+		/* same rounding as the decoder so encoder and decoder state match */
+		int delta = step >> 3;
+		if (diff >= step) {
+			nibble |= 4;
+			diff -= step;
+			delta += step;
+		}
+
+		step >>= 1;
+		if (diff >= step) {
+			nibble |= 2;
+			diff -= step;
+			delta += step;
+		}
+
+		step >>= 1;
+		if (diff >= step) {
+			nibble |= 1;
+			delta += step;
+		}
+
+		channel.Predictor += (nibble & 8) ? -delta : delta;
+		channel.Predictor = std::clamp(channel.Predictor, -32768, 32767);
+		channel.Index = std::clamp(channel.Index + kIndexTable[nibble], 0, 88);
+
+		return nibble;
+	}
+
+	template <typename T>
+	void Write(std::fstream& fs, T value) {
+		fs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+}
+
+bool ImaAdpcm::WriteWav(std::filesystem::path path, const std::vector<float>& pcm, int channels, int frequency) {
+	if (channels < 1 || channels > 2) {
+		return false;
+	}
+
+	std::fstream fs(path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!fs.is_open()) {
+		std::cout << "[ImaAdpcm] Failed to open " << path.string() << std::endl;
+		return false;
+	}
+
+	uint16_t blockAlign = static_cast<uint16_t>(kChannelBlockSize * channels);
+	uint16_t framesPerBlock = static_cast<uint16_t>((kChannelBlockSize - 4) * 2 + 1);
+	uint32_t frames = static_cast<uint32_t>(pcm.size() / channels);
+	uint32_t blocks = (frames + framesPerBlock - 1) / framesPerBlock;
+	uint32_t dataSize = blocks * blockAlign;
+
+	fs.write("RIFF", 4);
+	Write<uint32_t>(fs, 4 + (8 + 20) + (8 + 4) + (8 + dataSize));
+	fs.write("WAVE", 4);
+
+	fs.write("fmt ", 4);
+	Write<uint32_t>(fs, 20);
+	Write<uint16_t>(fs, 0x11);
+	Write<uint16_t>(fs, static_cast<uint16_t>(channels));
+	Write<uint32_t>(fs, static_cast<uint32_t>(frequency));
+	Write<uint32_t>(fs, static_cast<uint32_t>(static_cast<uint64_t>(frequency) * blockAlign / framesPerBlock));
+	Write<uint16_t>(fs, blockAlign);
+	Write<uint16_t>(fs, 4);
+	Write<uint16_t>(fs, 2);
+	Write<uint16_t>(fs, framesPerBlock);
+
+	fs.write("fact", 4);
+	Write<uint32_t>(fs, 4);
+	Write<uint32_t>(fs, frames);
+
+	fs.write("data", 4);
+	Write<uint32_t>(fs, dataSize);
+
+	auto sampleAt = [&](uint32_t frame, int channel) -> int {
+		return frame < frames ? ToPCM16(pcm[static_cast<size_t>(frame) * channels + channel]) : 0;
+	};
+
+	std::vector<uint8_t> block(blockAlign);
+	Channel state[2] = {};
+
+	for (uint32_t b = 0; b < blocks; b++) {
+		uint32_t first = b * framesPerBlock;
+		std::fill(block.begin(), block.end(), 0);
+
+		/* block header, the first frame is stored as-is */
+		for (int c = 0; c < channels; c++) {
+			state[c].Predictor = sampleAt(first, c);
+
+			int16_t predictor = static_cast<int16_t>(state[c].Predictor);
+			memcpy(&block[c * 4], &predictor, 2);
+			block[c * 4 + 2] = static_cast<uint8_t>(state[c].Index);
+		}
+
+		/* then groups of 8 frames per channel, 4 bytes each, low nibble first */
+		size_t offset = channels * 4;
+		for (uint32_t group = 0; group < (framesPerBlock - 1) / 8; group++) {
+			for (int c = 0; c < channels; c++) {
+				for (int i = 0; i < 8; i += 2) {
+					uint32_t frame = first + 1 + group * 8 + i;
+
+					uint8_t low = EncodeNibble(state[c], sampleAt(frame, c));
+					uint8_t high = EncodeNibble(state[c], sampleAt(frame + 1, c));
+					block[offset++] = low | (high << 4);
+				}
+			}
+		}
+
+		fs.write(reinterpret_cast<const char*>(block.data()), block.size());
+	}
+
+	return fs.good();
+}
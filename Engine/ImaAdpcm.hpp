@@ -0,0 +1,13 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+
+/*
+ * IMA ADPCM (WAVE_FORMAT_IMA_ADPCM) WAV writer, 4 bits per sample so about a
+ * quarter of 16-bit PCM. BASS plays it back through the system ACM codec like
+ * any other WAV.
+ */
+namespace ImaAdpcm {
+	/* pcm is interleaved float, 1 or 2 channels */
+	bool WriteWav(std::filesystem::path path, const std::vector<float>& pcm, int channels, int frequency);
+}
@@ -1,5 +1,6 @@
 #include "InputManager.hpp"
 #include "Window.hpp"
+#include <chrono>
 
 InputManager::InputManager() {
 	for (Keys i = Keys::A; i != Keys::INVALID_KEY; i = static_cast<Keys>(static_cast<int>(i) + 1)) {
@@ -86,6 +87,7 @@ void InputManager::OnKeyEvent(SDL_Event& event, bool isDown) {
 
 	int lastState = m_keyStates[key];
 	KeyState state = { key, isDown ? KeyEventType::KEY_DOWN : KeyEventType::KEY_UP };
+	state.time = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
 
 	if (isDown) {
 		m_keyStates[key] = true;
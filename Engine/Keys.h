@@ -116,6 +116,9 @@ enum class MouseButton { LEFT, RIGHT, MIDDLE, INVALID_BUTTON };
 struct KeyState {
 	Keys key;
 	KeyEventType type;
+
+	/* steady clock seconds of when the event was taken off the OS queue */
+	double time = 0;
 };
 
 struct MouseState {
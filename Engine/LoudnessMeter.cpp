@@ -0,0 +1,120 @@
+#include "LoudnessMeter.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	constexpr double kPi = 3.14159265358979323846;
+	constexpr double kAbsoluteGate = -70.0;
+	constexpr double kRelativeGate = -10.0;
+
+	double ToEnergy(double lufs) {
+		return std::pow(10.0, (lufs + 0.691) / 10.0);
+	}
+
+	double ToLoudness(double energy) {
+		return -0.691 + 10.0 * std::log10(energy);
+	}
+}
+
+double LoudnessMeter::Biquad::Run(int channel, double input) {
+	/* transposed direct form II */
+	double output = B0 * input + Z1[channel];
+	Z1[channel] = B1 * input - A1 * output + Z2[channel];
+	Z2[channel] = B2 * input - A2 * output;
+
+	return output;
+}
+
+LoudnessMeter::LoudnessMeter(int sampleRate) {
+	// K-weighting coefficients for any sample rate, the BS.1770 tables only
+	// list 48 kHz.
+	double f0 = 1681.974450955533;
+	double gain = 3.999843853973347;
+	double q = 0.7071752369554196;
+
+	double k = std::tan(kPi * f0 / sampleRate);
+	double vh = std::pow(10.0, gain / 20.0);
+	double vb = std::pow(vh, 0.4996667741545416);
+	double a0 = 1.0 + k / q + k * k;
+
+	m_shelf = {};
+	m_shelf.B0 = (vh + vb * k / q + k * k) / a0;
+	m_shelf.B1 = 2.0 * (k * k - vh) / a0;
+	m_shelf.B2 = (vh - vb * k / q + k * k) / a0;
+	m_shelf.A1 = 2.0 * (k * k - 1.0) / a0;
+	m_shelf.A2 = (1.0 - k / q + k * k) / a0;
+
+	f0 = 38.13547087602444;
+	q = 0.5003270373238773;
+	k = std::tan(kPi * f0 / sampleRate);
+	a0 = 1.0 + k / q + k * k;
+
+	m_highPass = {};
+	m_highPass.B0 = 1.0;
+	m_highPass.B1 = -2.0;
+	m_highPass.B2 = 1.0;
+	m_highPass.A1 = 2.0 * (k * k - 1.0) / a0;
+	m_highPass.A2 = (1.0 - k / q + k * k) / a0;
+
+	m_subBlockCount = 0;
+	m_subEnergy = 0;
+	m_subFrames = 0;
+	m_subBlockLength = static_cast<size_t>(sampleRate / 10);
+
+	for (auto& it : m_subBlocks) {
+		it = 0;
+	}
+}
+
+void LoudnessMeter::Process(const float* pcm, size_t frames) {
+	for (size_t i = 0; i < frames; i++) {
+		for (int c = 0; c < 2; c++) {
+			double value = m_highPass.Run(c, m_shelf.Run(c, pcm[i * 2 + c]));
+			m_subEnergy += value * value;
+		}
+
+		if (++m_subFrames < m_subBlockLength) {
+			continue;
+		}
+
+		m_subBlocks[m_subBlockCount % 4] = m_subEnergy;
+		m_subBlockCount++;
+		m_subEnergy = 0;
+		m_subFrames = 0;
+
+		if (m_subBlockCount >= 4) {
+			double energy = m_subBlocks[0] + m_subBlocks[1] + m_subBlocks[2] + m_subBlocks[3];
+			m_blocks.push_back(energy / (m_subBlockLength * 4));
+		}
+	}
+}
+
+double LoudnessMeter::GetIntegratedLoudness() const {
+	auto gatedMean = [&](double threshold, double& mean) {
+		double sum = 0;
+		size_t count = 0;
+
+		for (double energy : m_blocks) {
+			if (energy > threshold) {
+				sum += energy;
+				count++;
+			}
+		}
+
+		mean = count ? sum / count : 0;
+		return count > 0;
+	};
+
+	double absolute = ToEnergy(kAbsoluteGate);
+	double mean = 0;
+	if (!gatedMean(absolute, mean)) {
+		return kLoudnessSilence;
+	}
+
+	double relative = ToEnergy(ToLoudness(mean) + kRelativeGate);
+	if (!gatedMean((std::max)(absolute, relative), mean)) {
+		return kLoudnessSilence;
+	}
+
+	return ToLoudness(mean);
+}
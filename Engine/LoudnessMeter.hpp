@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Reported when every block falls below the absolute gate, in LUFS
+constexpr double kLoudnessSilence = -70.0;
+
+/*
+ * Integrated loudness after ITU-R BS.1770: K-weighting, 400 ms blocks with
+ * 75% overlap, then the absolute (-70 LUFS) and relative (-10 LU) gates.
+ * Takes stereo interleaved float as SoftwareMixer renders it, so a chart can
+ * be measured offline without an audio device.
+ */
+class LoudnessMeter {
+public:
+	LoudnessMeter(int sampleRate);
+
+	void Process(const float* pcm, size_t frames);
+	double GetIntegratedLoudness() const;
+
+private:
+	struct Biquad {
+		double B0, B1, B2, A1, A2;
+		double Z1[2], Z2[2];
+
+		double Run(int channel, double input);
+	};
+
+	Biquad m_shelf;
+	Biquad m_highPass;
+
+	/* energy of the last four 100 ms sub-blocks, a block is their sum */
+	double m_subBlocks[4];
+	int m_subBlockCount;
+	double m_subEnergy;
+	size_t m_subFrames;
+	size_t m_subBlockLength;
+
+	/* mean square of every 400 ms block */
+	std::vector<double> m_blocks;
+};
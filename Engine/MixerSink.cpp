@@ -0,0 +1,237 @@
+#include "MixerSink.hpp"
+#include <bass.h>
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <iostream>
+#include "SoftwareMixer.hpp"
+
+namespace {
+	// Frames rendered per call by the offline sinks
+	constexpr int kOfflineBlockFrames = 1024;
+}
+
+BassMixerSink::BassMixerSink() {
+	m_stream = 0;
+	m_mixer = nullptr;
+}
+
+BassMixerSink::~BassMixerSink() {
+	Stop();
+}
+
+bool BassMixerSink::Start(SoftwareMixer* mixer) {
+	Stop();
+
+	m_mixer = mixer;
+	m_stream = BASS_StreamCreate(mixer->GetSampleRate(), 2, BASS_SAMPLE_FLOAT, &BassMixerSink::StreamProc, this);
+	if (!m_stream) {
+		std::cout << "[MixerSink] Failed to create BASS stream: " << BASS_ErrorGetCode() << std::endl;
+		return false;
+	}
+
+	/* render at mix time so the mixer clock stays on what is being played */
+	BASS_ChannelSetAttribute(m_stream, BASS_ATTRIB_BUFFER, 0);
+
+	return BASS_ChannelPlay(m_stream, FALSE);
+}
+
+void BassMixerSink::Stop() {
+	if (m_stream) {
+		BASS_StreamFree(m_stream);
+		m_stream = 0;
+	}
+}
+
+void BassMixerSink::Pause() {
+	if (m_stream) {
+		BASS_ChannelPause(m_stream);
+	}
+}
+
+void BassMixerSink::Resume() {
+	if (m_stream) {
+		BASS_ChannelPlay(m_stream, FALSE);
+	}
+}
+
+DWORD CALLBACK BassMixerSink::StreamProc(DWORD handle, void* buffer, DWORD length, void* user) {
+	auto self = static_cast<BassMixerSink*>(user);
+	int frames = length / (sizeof(float) * 2);
+
+	self->m_mixer->Render(static_cast<float*>(buffer), frames);
+	return frames * sizeof(float) * 2;
+}
+
+SDLMixerSink::SDLMixerSink() {
+	m_device = 0;
+	m_mixer = nullptr;
+}
+
+SDLMixerSink::~SDLMixerSink() {
+	Stop();
+}
+
+bool SDLMixerSink::Start(SoftwareMixer* mixer) {
+	Stop();
+
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+		std::cout << "[MixerSink] Failed to init SDL audio: " << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	m_mixer = mixer;
+
+	SDL_AudioSpec want = {}, have = {};
+	want.freq = mixer->GetSampleRate();
+	want.format = AUDIO_F32SYS;
+	want.channels = 2;
+	want.samples = 512;
+	want.callback = &SDLMixerSink::AudioCallback;
+	want.userdata = this;
+
+	m_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+	if (m_device == 0) {
+		std::cout << "[MixerSink] Failed to open SDL audio device: " << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	SDL_PauseAudioDevice(m_device, 0);
+	return true;
+}
+
+void SDLMixerSink::Stop() {
+	if (m_device != 0) {
+		SDL_CloseAudioDevice(m_device);
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		m_device = 0;
+	}
+}
+
+void SDLMixerSink::AudioCallback(void* user, uint8_t* stream, int length) {
+	auto self = static_cast<SDLMixerSink*>(user);
+	self->m_mixer->Render(reinterpret_cast<float*>(stream), length / static_cast<int>(sizeof(float) * 2));
+}
+
+WavMixerSink::WavMixerSink(std::filesystem::path path) {
+	m_path = path;
+	m_mixer = nullptr;
+	m_frames = 0;
+}
+
+WavMixerSink::~WavMixerSink() {
+	Stop();
+}
+
+bool WavMixerSink::Start(SoftwareMixer* mixer) {
+	Stop();
+
+	m_file.open(m_path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!m_file.is_open()) {
+		std::cout << "[MixerSink] Failed to open " << m_path.string() << std::endl;
+		return false;
+	}
+
+	m_mixer = mixer;
+	m_frames = 0;
+	m_block.resize(kOfflineBlockFrames * 2);
+
+	/* sizes are patched in once the render is done */
+	WriteHeader();
+	return true;
+}
+
+void WavMixerSink::Stop() {
+	if (!m_file.is_open()) {
+		return;
+	}
+
+	m_file.seekp(0, std::ios::beg);
+	WriteHeader();
+	m_file.close();
+}
+
+void WavMixerSink::Render(int frames) {
+	if (!m_file.is_open()) {
+		return;
+	}
+
+	while (frames > 0) {
+		int count = (std::min)(frames, kOfflineBlockFrames);
+
+		m_mixer->Render(m_block.data(), count);
+		m_file.write(reinterpret_cast<const char*>(m_block.data()), sizeof(float) * count * 2);
+
+		m_frames += count;
+		frames -= count;
+	}
+}
+
+void WavMixerSink::WriteHeader() {
+	uint32_t sampleRate = m_mixer ? m_mixer->GetSampleRate() : 48000;
+	uint16_t channels = 2;
+	uint16_t bits = 32;
+	uint16_t format = 3; /* WAVE_FORMAT_IEEE_FLOAT */
+	uint16_t blockAlign = channels * bits / 8;
+	uint32_t byteRate = sampleRate * blockAlign;
+	uint32_t dataSize = static_cast<uint32_t>(m_frames * blockAlign);
+	uint32_t riffSize = 36 + dataSize;
+	uint32_t fmtSize = 16;
+
+	m_file.write("RIFF", 4);
+	m_file.write(reinterpret_cast<const char*>(&riffSize), 4);
+	m_file.write("WAVEfmt ", 8);
+	m_file.write(reinterpret_cast<const char*>(&fmtSize), 4);
+	m_file.write(reinterpret_cast<const char*>(&format), 2);
+	m_file.write(reinterpret_cast<const char*>(&channels), 2);
+	m_file.write(reinterpret_cast<const char*>(&sampleRate), 4);
+	m_file.write(reinterpret_cast<const char*>(&byteRate), 4);
+	m_file.write(reinterpret_cast<const char*>(&blockAlign), 2);
+	m_file.write(reinterpret_cast<const char*>(&bits), 2);
+	m_file.write("data", 4);
+	m_file.write(reinterpret_cast<const char*>(&dataSize), 4);
+}
+
+NullMixerSink::NullMixerSink(bool recordStarts) {
+	m_mixer = nullptr;
+	m_recordStarts = recordStarts;
+}
+
+bool NullMixerSink::Start(SoftwareMixer* mixer) {
+	m_mixer = mixer;
+	m_starts.clear();
+
+	if (m_recordStarts) {
+		mixer->SetStartCallback([this](int buffer, uint64_t frame) {
+			m_starts.push_back({ buffer, frame });
+		});
+	}
+
+	return true;
+}
+
+void NullMixerSink::Stop() {
+	if (m_mixer && m_recordStarts) {
+		m_mixer->SetStartCallback(nullptr);
+	}
+
+	m_mixer = nullptr;
+}
+
+void NullMixerSink::Render(int frames, int blockFrames) {
+	if (m_mixer == nullptr) {
+		return;
+	}
+
+	/* odd block sizes are useful to check starts that land mid-block */
+	m_block.resize((std::max)(blockFrames, 1) * 2);
+
+	while (frames > 0) {
+		int count = (std::min)(frames, (std::max)(blockFrames, 1));
+		m_mixer->Render(m_block.data(), count);
+		frames -= count;
+	}
+}
+
+const std::vector<MixerStart>& NullMixerSink::GetStarts() const {
+	return m_starts;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "Data/WindowsTypes.hpp"
+
+class SoftwareMixer;
+
+struct MixerStart {
+	int Buffer;
+	uint64_t Frame;
+};
+
+/*
+ * Where SoftwareMixer output goes. Device sinks pull from the mixer on their
+ * own audio thread once started, offline sinks (WAV file, null) render only
+ * when asked so the output is deterministic.
+ */
+class MixerSink {
+public:
+	virtual ~MixerSink() = default;
+
+	virtual bool Start(SoftwareMixer* mixer) = 0;
+	virtual void Stop() = 0;
+};
+
+/* BASS user stream on the current BASS device */
+class BassMixerSink : public MixerSink {
+public:
+	BassMixerSink();
+	~BassMixerSink() override;
+
+	bool Start(SoftwareMixer* mixer) override;
+	void Stop() override;
+
+	void Pause();
+	void Resume();
+
+private:
+	static DWORD CALLBACK StreamProc(DWORD handle, void* buffer, DWORD length, void* user);
+
+	DWORD m_stream;
+	SoftwareMixer* m_mixer;
+};
+
+/* SDL audio device, works wherever SDL does */
+class SDLMixerSink : public MixerSink {
+public:
+	SDLMixerSink();
+	~SDLMixerSink() override;
+
+	bool Start(SoftwareMixer* mixer) override;
+	void Stop() override;
+
+private:
+	static void AudioCallback(void* user, uint8_t* stream, int length);
+
+	uint32_t m_device;
+	SoftwareMixer* m_mixer;
+};
+
+/* 32-bit float stereo WAV file */
+class WavMixerSink : public MixerSink {
+public:
+	WavMixerSink(std::filesystem::path path);
+	~WavMixerSink() override;
+
+	bool Start(SoftwareMixer* mixer) override;
+	void Stop() override;
+
+	void Render(int frames);
+
+private:
+	void WriteHeader();
+
+	std::filesystem::path m_path;
+	std::fstream m_file;
+	SoftwareMixer* m_mixer;
+
+	std::vector<float> m_block;
+	uint64_t m_frames;
+};
+
+/* discards everything, for measuring the mixer alone or checking start timing */
+class NullMixerSink : public MixerSink {
+public:
+	NullMixerSink(bool recordStarts = false);
+
+	bool Start(SoftwareMixer* mixer) override;
+	void Stop() override;
+
+	void Render(int frames, int blockFrames = 1024);
+	const std::vector<MixerStart>& GetStarts() const;
+
+private:
+	SoftwareMixer* m_mixer;
+	std::vector<float> m_block;
+
+	bool m_recordStarts;
+	std::vector<MixerStart> m_starts;
+};
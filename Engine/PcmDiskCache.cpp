@@ -0,0 +1,302 @@
+#include "PcmDiskCache.hpp"
+#include "AudioSample.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// Bump whenever the layout changes, old files are then ignored
+	constexpr int kPcmCacheVersion = 2;
+	const char kPcmCacheMagic[4] = { 'P', 'C', 'M', 'C' };
+
+	struct PcmHeader {
+		char Magic[4];
+		int Version;
+		int Flags;
+		int Frequency;
+		int Channels;
+		int Length;
+		uint64_t KeyHash;
+
+		/* silence analysis of the data, Frames is 0 when it wasn't analyzed */
+		uint32_t Onset;
+		uint32_t Tail;
+		uint32_t Frames;
+		uint32_t Reserved;
+	};
+
+	std::atomic<uint64_t> s_capacity = kDefaultPcmCacheCapacity;
+	std::mutex s_trimLock;
+
+	uint64_t HashKey(const std::string& key) {
+		uint64_t hash = 14695981039346656037ull;
+
+		for (unsigned char c : key) {
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	std::filesystem::path GetCacheDirectory() {
+		return std::filesystem::current_path() / "Cache" / "PCM";
+	}
+
+	std::filesystem::path GetCachePath(uint64_t hash) {
+		std::stringstream ss;
+		ss << std::hex << std::setfill('0') << std::setw(16) << hash << ".pcm";
+
+		return GetCacheDirectory() / ss.str();
+	}
+
+	// Read-only view of a whole file, unmapped on destruction
+	class MappedFile {
+	public:
+		MappedFile(const std::filesystem::path& path) {
+#if _WIN32
+			m_file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (m_file == INVALID_HANDLE_VALUE) {
+				return;
+			}
+
+			LARGE_INTEGER size = {};
+			if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+				return;
+			}
+
+			m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (m_mapping == NULL) {
+				return;
+			}
+
+			m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+			if (m_data != nullptr) {
+				m_size = static_cast<size_t>(size.QuadPart);
+			}
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				return;
+			}
+
+			off_t size = lseek(fd, 0, SEEK_END);
+			if (size > 0) {
+				void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data != MAP_FAILED) {
+					m_data = data;
+					m_size = static_cast<size_t>(size);
+				}
+			}
+
+			close(fd);
+#endif
+		}
+
+		~MappedFile() {
+#if _WIN32
+			if (m_data != nullptr) {
+				UnmapViewOfFile(m_data);
+			}
+
+			if (m_mapping != NULL) {
+				CloseHandle(m_mapping);
+			}
+
+			if (m_file != INVALID_HANDLE_VALUE) {
+				CloseHandle(m_file);
+			}
+#else
+			if (m_data != nullptr) {
+				munmap(m_data, m_size);
+			}
+#endif
+		}
+
+		const uint8_t* Data() const {
+			return static_cast<const uint8_t*>(m_data);
+		}
+
+		size_t Size() const {
+			return m_size;
+		}
+
+	private:
+#if _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = NULL;
+#endif
+		void* m_data = nullptr;
+		size_t m_size = 0;
+	};
+}
+
+void PcmDiskCache::SetCapacity(uint64_t bytes) {
+	s_capacity = bytes;
+}
+
+bool PcmDiskCache::IsEnabled() {
+	return s_capacity > 0;
+}
+
+bool PcmDiskCache::Load(const std::string& key, AudioSample* sample) {
+	if (!IsEnabled()) {
+		return false;
+	}
+
+	uint64_t hash = HashKey(key);
+	std::filesystem::path path = GetCachePath(hash);
+
+	bool loaded = false;
+	{
+		MappedFile file(path);
+		if (file.Size() < sizeof(PcmHeader)) {
+			return false;
+		}
+
+		PcmHeader header = {};
+		memcpy(&header, file.Data(), sizeof(PcmHeader));
+
+		if (memcmp(header.Magic, kPcmCacheMagic, 4) != 0
+			|| header.Version != kPcmCacheVersion
+			|| header.KeyHash != hash
+			|| header.Length <= 0
+			|| file.Size() - sizeof(PcmHeader) < static_cast<size_t>(header.Length)) {
+			return false;
+		}
+
+		loaded = sample->CreateFromMemory(header.Flags, header.Frequency, header.Channels, header.Length, file.Data() + sizeof(PcmHeader));
+
+		if (loaded && header.Frames > 0) {
+			SampleSilence silence = {};
+			silence.Onset = header.Onset;
+			silence.Tail = header.Tail;
+			silence.Length = header.Frames;
+
+			sample->SetSilence(silence);
+		}
+	}
+
+	if (loaded) {
+		/* write time doubles as the LRU stamp for Trim */
+		std::error_code ec;
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+	}
+
+	return loaded;
+}
+
+void PcmDiskCache::Store(const std::string& key, AudioSample* sample) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	PcmHeader header = {};
+	std::vector<char> data;
+	if (!sample->Export(header.Flags, header.Frequency, header.Channels, data)) {
+		return;
+	}
+
+	memcpy(header.Magic, kPcmCacheMagic, 4);
+	header.Version = kPcmCacheVersion;
+	header.Length = static_cast<int>(data.size());
+	header.KeyHash = HashKey(key);
+
+	if (sample->IsAnalyzed()) {
+		header.Onset = sample->GetSilence().Onset;
+		header.Tail = sample->GetSilence().Tail;
+		header.Frames = sample->GetSilence().Length;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(GetCacheDirectory(), ec);
+
+	// Write beside the final name and rename, a crash never leaves a half file behind
+	std::filesystem::path path = GetCachePath(header.KeyHash);
+	std::filesystem::path tmpPath = path;
+	tmpPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+	{
+		std::fstream fs(tmpPath, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!fs.is_open()) {
+			return;
+		}
+
+		fs.write((char*)&header, sizeof(PcmHeader));
+		fs.write(data.data(), data.size());
+
+		if (!fs.good()) {
+			fs.close();
+			std::filesystem::remove(tmpPath, ec);
+			return;
+		}
+	}
+
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		std::filesystem::remove(tmpPath, ec);
+	}
+}
+
+void PcmDiskCache::Trim() {
+	TrimDirectory(GetCacheDirectory(), ".pcm", s_capacity);
+}
+
+void PcmDiskCache::TrimDirectory(const std::filesystem::path& directory, const std::string& extension, uint64_t capacity) {
+	std::lock_guard<std::mutex> lock(s_trimLock);
+
+	struct Entry {
+		std::filesystem::path Path;
+		std::filesystem::file_time_type Time;
+		uint64_t Size;
+	};
+
+	std::vector<Entry> entries;
+	uint64_t total = 0;
+
+	std::error_code ec;
+	for (auto& it : std::filesystem::directory_iterator(directory, ec)) {
+		if (!it.is_regular_file(ec) || it.path().extension() != extension) {
+			continue;
+		}
+
+		Entry entry = { it.path(), it.last_write_time(ec), it.file_size(ec) };
+		if (ec) {
+			continue;
+		}
+
+		total += entry.Size;
+		entries.push_back(entry);
+	}
+
+	if (total <= capacity) {
+		return;
+	}
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.Time < b.Time;
+	});
+
+	for (auto& entry : entries) {
+		if (total <= capacity) {
+			break;
+		}
+
+		if (std::filesystem::remove(entry.Path, ec)) {
+			total -= entry.Size;
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+class AudioSample;
+
+// Default size cap of Cache/PCM, in bytes
+constexpr uint64_t kDefaultPcmCacheCapacity = 1024ull * 1024 * 1024;
+
+/*
+ * Optional on-disk cache of decoded keysound PCM in Cache/PCM. Each entry is
+ * a small header followed by the raw sample data, loads map the file and hand
+ * it straight to BASS instead of decoding the OGG/WAV again. The header also
+ * keeps the sample's silence analysis so it isn't redone on every load. Files are written
+ * to a temp name and renamed, anything that fails validation is ignored, so
+ * the folder can be deleted at any time.
+ */
+namespace PcmDiskCache {
+	/* 0 disables the cache */
+	void SetCapacity(uint64_t bytes);
+	bool IsEnabled();
+
+	/* key must change whenever the source does, e.g. path + size + write time */
+	bool Load(const std::string& key, AudioSample* sample);
+	/* stores the data as it is, call before AudioSample::TrimSilence */
+	void Store(const std::string& key, AudioSample* sample);
+
+	/* drops least recently used entries until the folder fits the cap */
+	void Trim();
+
+	/* same LRU trim for another cache folder, file write times are the use stamps */
+	void TrimDirectory(const std::filesystem::path& directory, const std::string& extension, uint64_t capacity);
+}
@@ -0,0 +1,96 @@
+#include "SampleAnalysis.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	float ReadSample(const uint8_t* data, size_t index, SampleFormat format) {
+		switch (format) {
+			case SampleFormat::U8: {
+				return (static_cast<int>(data[index]) - 128) / 128.0f;
+			}
+
+			case SampleFormat::S16: {
+				int16_t value = static_cast<int16_t>(data[index * 2] | (data[index * 2 + 1] << 8));
+				return value / 32768.0f;
+			}
+
+			default: {
+				float value;
+				memcpy(&value, data + index * 4, sizeof(float));
+				return value;
+			}
+		}
+	}
+
+	bool IsAudible(const uint8_t* data, size_t frame, SampleFormat format, int channels, float threshold) {
+		for (int c = 0; c < channels; c++) {
+			if (std::fabs(ReadSample(data, frame * channels + c, format)) > threshold) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+int SampleAnalysis::GetSampleSize(SampleFormat format) {
+	switch (format) {
+		case SampleFormat::U8:
+			return 1;
+		case SampleFormat::S16:
+			return 2;
+		default:
+			return 4;
+	}
+}
+
+SampleSilence SampleAnalysis::Analyze(const void* pcm, size_t bytes, SampleFormat format, int channels, float threshold) {
+	SampleSilence result = {};
+	if (pcm == nullptr || channels <= 0) {
+		return result;
+	}
+
+	const uint8_t* data = static_cast<const uint8_t*>(pcm);
+	size_t frames = bytes / (GetSampleSize(format) * channels);
+	result.Length = static_cast<uint32_t>(frames);
+
+	size_t onset = 0;
+	while (onset < frames && !IsAudible(data, onset, format, channels, threshold)) {
+		onset++;
+	}
+
+	result.Onset = static_cast<uint32_t>(onset);
+	if (onset == frames) {
+		return result;
+	}
+
+	size_t end = frames;
+	while (end > onset && !IsAudible(data, end - 1, format, channels, threshold)) {
+		end--;
+	}
+
+	result.Tail = static_cast<uint32_t>(frames - end);
+	return result;
+}
+
+void SampleAnalysis::GetTrim(const SampleSilence& silence, int frequency, uint32_t& lead, uint32_t& tail) {
+	lead = 0;
+	tail = 0;
+
+	/* a silent sample stays as it is, there's nothing to line up */
+	if (silence.IsSilent() || frequency <= 0) {
+		return;
+	}
+
+	uint32_t margin = static_cast<uint32_t>(kTrimMargin * frequency / 1000.0);
+	uint32_t minimumLead = static_cast<uint32_t>(kMinimumTrimLead * frequency / 1000.0);
+
+	if (silence.Onset > margin && silence.Onset - margin >= minimumLead) {
+		lead = silence.Onset - margin;
+	}
+
+	if (silence.Tail > margin) {
+		tail = silence.Tail - margin;
+	}
+}
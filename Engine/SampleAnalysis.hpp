@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Anything quieter than this (about -60 dBFS) counts as silence
+constexpr float kSilenceThreshold = 0.001f;
+
+// Kept around the sound when trimming so attacks and release tails aren't
+// cut off, and the least leading silence worth trimming, in ms
+constexpr double kTrimMargin = 2.0;
+constexpr double kMinimumTrimLead = 5.0;
+
+enum class SampleFormat {
+	U8,
+	S16,
+	F32
+};
+
+/* leading and trailing silence of a sample, in frames */
+struct SampleSilence {
+	uint32_t Onset = 0;
+	uint32_t Tail = 0;
+	uint32_t Length = 0;
+
+	bool IsSilent() const {
+		return Onset >= Length;
+	}
+};
+
+/*
+ * Finds where a keysound actually starts and stops. Works on raw interleaved
+ * PCM only, no audio device or BASS handle involved.
+ */
+namespace SampleAnalysis {
+	SampleSilence Analyze(const void* pcm, size_t bytes, SampleFormat format, int channels, float threshold = kSilenceThreshold);
+
+	/* frames to cut from each end, keeping kTrimMargin and skipping leads under kMinimumTrimLead */
+	void GetTrim(const SampleSilence& silence, int frequency, uint32_t& lead, uint32_t& tail);
+
+	int GetSampleSize(SampleFormat format);
+}
@@ -0,0 +1,105 @@
+#include "SampleCache.hpp"
+#include "AudioSample.hpp"
+
+SampleCache* SampleCache::s_instance = nullptr;
+
+SampleCache::SampleCache() {
+	m_stats.Budget = kDefaultSampleCacheBudget;
+}
+
+SampleCache::~SampleCache() {
+	Clear();
+}
+
+std::shared_ptr<AudioSample> SampleCache::Get(const std::string& key) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	auto it = m_index.find(key);
+	if (it == m_index.end()) {
+		m_stats.Misses++;
+		return nullptr;
+	}
+
+	m_stats.Hits++;
+	m_entries.splice(m_entries.begin(), m_entries, it->second);
+	return it->second->Sample;
+}
+
+void SampleCache::Insert(const std::string& key, std::shared_ptr<AudioSample> sample) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	auto it = m_index.find(key);
+	if (it != m_index.end()) {
+		m_stats.Bytes -= it->second->Size;
+		m_entries.erase(it->second);
+		m_index.erase(it);
+	}
+
+	size_t size = sample->GetSize();
+	m_entries.push_front({ key, sample, size });
+	m_index[key] = m_entries.begin();
+	m_stats.Bytes += size;
+
+	Evict();
+}
+
+void SampleCache::SetBudget(size_t bytes) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	m_stats.Budget = bytes;
+	Evict();
+}
+
+void SampleCache::Trim() {
+	std::lock_guard<std::mutex> lock(m_lock);
+	Evict();
+}
+
+void SampleCache::Clear() {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	m_entries.clear();
+	m_index.clear();
+	m_stats.Bytes = 0;
+}
+
+SampleCacheStats SampleCache::GetStats() {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	SampleCacheStats stats = m_stats;
+	stats.Count = m_entries.size();
+	return stats;
+}
+
+void SampleCache::Evict() {
+	auto it = m_entries.end();
+
+	while (m_stats.Bytes > m_stats.Budget && it != m_entries.begin()) {
+		--it;
+
+		/* still referenced by the loaded chart */
+		if (it->Sample.use_count() > 1) {
+			continue;
+		}
+
+		m_stats.Bytes -= it->Size;
+		m_stats.Evictions++;
+		m_index.erase(it->Key);
+		it = m_entries.erase(it);
+	}
+}
+
+SampleCache* SampleCache::GetInstance() {
+	if (s_instance == nullptr) {
+		s_instance = new SampleCache();
+	}
+
+	return s_instance;
+}
+
+void SampleCache::Release() {
+	if (s_instance != nullptr) {
+		delete s_instance;
+		s_instance = nullptr;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class AudioSample;
+
+// Default budget when Game.ini has none, in bytes
+constexpr size_t kDefaultSampleCacheBudget = 512ull * 1024 * 1024;
+
+struct SampleCacheStats {
+	uint64_t Hits = 0;
+	uint64_t Misses = 0;
+	uint64_t Evictions = 0;
+
+	size_t Bytes = 0;
+	size_t Budget = 0;
+	size_t Count = 0;
+};
+
+/*
+ * Process-wide keysound cache so a retry or another difficulty of the same
+ * song reuses the samples it already decoded. Entries are evicted least
+ * recently used first once the byte budget is exceeded, samples still held
+ * outside the cache (the chart being played) are never evicted.
+ */
+class SampleCache {
+public:
+	std::shared_ptr<AudioSample> Get(const std::string& key);
+	void Insert(const std::string& key, std::shared_ptr<AudioSample> sample);
+
+	void SetBudget(size_t bytes);
+	void Trim();
+	void Clear();
+
+	SampleCacheStats GetStats();
+
+	static SampleCache* GetInstance();
+	static void Release();
+
+private:
+	SampleCache();
+	~SampleCache();
+
+	struct Entry {
+		std::string Key;
+		std::shared_ptr<AudioSample> Sample;
+		size_t Size;
+	};
+
+	void Evict();
+
+	static SampleCache* s_instance;
+
+	std::mutex m_lock;
+
+	/* front is the most recently used */
+	std::list<Entry> m_entries;
+	std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+
+	SampleCacheStats m_stats;
+};
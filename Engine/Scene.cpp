@@ -18,6 +18,10 @@ void Scene::Update(double delta) {
 
 }
 
+void Scene::FixedUpdate(double delta) {
+
+}
+
 void Scene::Render(double delta) {
 
 }
@@ -12,6 +12,7 @@ public:
 	virtual bool Detach();
 	
 	virtual void Update(double delta);
+	virtual void FixedUpdate(double delta);
 	virtual void Render(double delta);
 	virtual void Input(double delta);
 
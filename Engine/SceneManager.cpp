@@ -66,6 +66,14 @@ void SceneManager::Update(double delta) {
 	}
 }
 
+// Called from the simulation thread, holds the scene lock so a scene is never
+// attached or detached in the middle of a step.
+void SceneManager::FixedUpdate(double delta) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_currentScene) m_currentScene->FixedUpdate(delta);
+}
+
 void SceneManager::Render(double delta) {
 	m_renderId = std::this_thread::get_id();
 
@@ -147,9 +155,14 @@ void SceneManager::SetFrameLimitMode(FrameLimitMode mode) {
 	m_parent->SetFrameLimitMode(mode);
 }
 
+void SceneManager::SetFrameStatsOverlay(bool enabled) {
+	m_parent->SetFrameStatsOverlay(enabled);
+}
+
 void SceneManager::DisplayFade(int transparency, std::function<void()> callback) {
 	std::thread([&, transparency, callback] {
-		std::lock_guard<std::mutex> lock(s_instance->m_mutex);
+		/* fades only queue behind each other, the scene lock stays free for FixedUpdate */
+		std::lock_guard<std::mutex> lock(s_instance->m_fadeMutex);
 
 		s_instance->m_parent->DisplayFade(transparency);
 		while (static_cast<int>(s_instance->m_parent->GetDisplayFade()) != transparency) {
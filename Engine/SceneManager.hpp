@@ -24,6 +24,7 @@ struct QueueInfo {
 class SceneManager {
 public:
 	void Update(double delta);
+	void FixedUpdate(double delta);
 	void Render(double delta);
 	void Input(double delta);
 
@@ -38,6 +39,7 @@ public:
 	void SetParent(Game* parent);
 	void SetFrameLimit(double frameLimit);
 	void SetFrameLimitMode(FrameLimitMode mode);
+	void SetFrameStatsOverlay(bool enabled);
 	void StopGame();
 
 	static void DisplayFade(int transparency, std::function<void()> callback);
@@ -62,6 +64,7 @@ private:
 	Scene* m_currentScene = nullptr;
 
 	std::mutex m_mutex;
+	std::mutex m_fadeMutex;
 
 	std::thread::id m_renderId;
 	std::thread::id m_inputId;
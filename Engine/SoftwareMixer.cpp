@@ -0,0 +1,298 @@
+#include "SoftwareMixer.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE__)
+#include <xmmintrin.h>
+#define MIXER_SSE 1
+#endif
+
+namespace {
+	/* output[i] += input[i] * gain[i % 2], stereo interleaved, `count` floats */
+	void MixStereo(float* output, const float* input, size_t count, float left, float right) {
+		size_t i = 0;
+
+#if MIXER_SSE
+		__m128 gain = _mm_setr_ps(left, right, left, right);
+		for (; i + 4 <= count; i += 4) {
+			__m128 in = _mm_loadu_ps(input + i);
+			__m128 out = _mm_loadu_ps(output + i);
+			_mm_storeu_ps(output + i, _mm_add_ps(out, _mm_mul_ps(in, gain)));
+		}
+#endif
+
+		for (; i < count; i += 2) {
+			output[i] += input[i] * left;
+			output[i + 1] += input[i + 1] * right;
+		}
+	}
+
+	void ScaleClamp(float* output, size_t count, float volume) {
+		size_t i = 0;
+
+#if MIXER_SSE
+		__m128 gain = _mm_set1_ps(volume);
+		__m128 low = _mm_set1_ps(-1.0f);
+		__m128 high = _mm_set1_ps(1.0f);
+		for (; i + 4 <= count; i += 4) {
+			__m128 value = _mm_mul_ps(_mm_loadu_ps(output + i), gain);
+			_mm_storeu_ps(output + i, _mm_min_ps(_mm_max_ps(value, low), high));
+		}
+#endif
+
+		for (; i < count; i++) {
+			output[i] = std::clamp(output[i] * volume, -1.0f, 1.0f);
+		}
+	}
+}
+
+SoftwareMixer::SoftwareMixer(int sampleRate, int voiceCount) : m_commands(kMixerCommandCapacity) {
+	m_sampleRate = sampleRate;
+	m_masterVolume = 1.0f;
+	m_voices.resize((std::max)(voiceCount, 1), Voice{ nullptr, 0, 0, 0, 0, 0, 0, false });
+	m_triggerCount = 0;
+	m_renderedFrames = 0;
+	m_activeVoices = 0;
+
+	for (auto& chunk : m_slots) {
+		chunk = nullptr;
+	}
+}
+
+SoftwareMixer::~SoftwareMixer() {
+	for (auto& chunk : m_slots) {
+		delete[] chunk.load();
+	}
+}
+
+int SoftwareMixer::AddBuffer(std::vector<float> pcm, int channels, int frequency) {
+	MixerBuffer buffer = {};
+	buffer.Frequency = frequency;
+
+	if (channels == 1) {
+		buffer.Data.resize(pcm.size() * 2);
+		for (size_t i = 0; i < pcm.size(); i++) {
+			buffer.Data[i * 2] = pcm[i];
+			buffer.Data[i * 2 + 1] = pcm[i];
+		}
+	}
+	else {
+		/* anything past stereo keeps the front pair */
+		size_t frames = pcm.size() / (std::max)(channels, 1);
+		buffer.Data.resize(frames * 2);
+		for (size_t i = 0; i < frames; i++) {
+			buffer.Data[i * 2] = pcm[i * channels];
+			buffer.Data[i * 2 + 1] = pcm[i * channels + 1];
+		}
+	}
+
+	buffer.Frames = buffer.Data.size() / 2;
+
+	std::lock_guard<std::mutex> lock(m_addLock);
+
+	int index = static_cast<int>(m_buffers.size());
+	if (index >= kMixerBufferChunk * kMixerBufferChunks) {
+		return -1;
+	}
+
+	auto& chunk = m_slots[index / kMixerBufferChunk];
+	if (chunk.load(std::memory_order_relaxed) == nullptr) {
+		auto slots = new std::atomic<const MixerBuffer*>[kMixerBufferChunk];
+		for (int i = 0; i < kMixerBufferChunk; i++) {
+			slots[i].store(nullptr, std::memory_order_relaxed);
+		}
+
+		chunk.store(slots, std::memory_order_release);
+	}
+
+	/* the buffer is complete before Render can see it, and never moves afterwards */
+	m_buffers.push_back(std::make_unique<MixerBuffer>(std::move(buffer)));
+	chunk.load(std::memory_order_relaxed)[index % kMixerBufferChunk].store(m_buffers.back().get(), std::memory_order_release);
+
+	return index;
+}
+
+void SoftwareMixer::ClearBuffers() {
+	std::lock_guard<std::mutex> lock(m_addLock);
+
+	for (auto& voice : m_voices) {
+		voice.Active = false;
+	}
+
+	for (size_t i = 0; i < m_buffers.size(); i++) {
+		m_slots[i / kMixerBufferChunk].load(std::memory_order_relaxed)[i % kMixerBufferChunk].store(nullptr, std::memory_order_relaxed);
+	}
+
+	m_commands.Clear();
+	m_scheduled.clear();
+	m_buffers.clear();
+	m_activeVoices = 0;
+}
+
+void SoftwareMixer::Play(int buffer, float volume, float pan, float rate) {
+	m_commands.TryPush({ 0, buffer, volume, pan, rate });
+}
+
+void SoftwareMixer::PlayAt(uint64_t frame, int buffer, float volume, float pan, float rate) {
+	m_commands.TryPush({ frame, buffer, volume, pan, rate });
+}
+
+void SoftwareMixer::StopAll() {
+	m_commands.TryPush({ 0, -1, 0, 0, 0 });
+}
+
+void SoftwareMixer::SetMasterVolume(float volume) {
+	m_masterVolume = (std::max)(volume, 0.0f);
+}
+
+void SoftwareMixer::Render(float* output, int frames) {
+	std::memset(output, 0, sizeof(float) * frames * 2);
+
+	uint64_t blockStart = m_renderedFrames.load(std::memory_order_relaxed);
+	uint64_t blockEnd = blockStart + frames;
+
+	auto later = [](const Command& a, const Command& b) {
+		return a.Frame > b.Frame;
+	};
+
+	Command command;
+	while (m_commands.TryPop(command)) {
+		if (command.Frame > blockStart) {
+			m_scheduled.push_back(command);
+			std::push_heap(m_scheduled.begin(), m_scheduled.end(), later);
+		}
+		else {
+			Start(command, 0);
+		}
+	}
+
+	/* scheduled voices start mid-block at their exact frame */
+	while (m_scheduled.size() && m_scheduled.front().Frame < blockEnd) {
+		std::pop_heap(m_scheduled.begin(), m_scheduled.end(), later);
+		Start(m_scheduled.back(), static_cast<int>(m_scheduled.back().Frame - blockStart));
+		m_scheduled.pop_back();
+	}
+
+	int active = 0;
+	for (auto& voice : m_voices) {
+		if (voice.Active) {
+			MixVoice(voice, output, frames);
+			active += voice.Active;
+		}
+	}
+
+	ScaleClamp(output, static_cast<size_t>(frames) * 2, m_masterVolume);
+
+	m_activeVoices = active;
+	m_renderedFrames.store(blockEnd, std::memory_order_release);
+}
+
+int SoftwareMixer::GetSampleRate() const {
+	return m_sampleRate;
+}
+
+int SoftwareMixer::GetActiveVoices() const {
+	return m_activeVoices;
+}
+
+uint64_t SoftwareMixer::GetRenderedFrames() const {
+	return m_renderedFrames.load(std::memory_order_acquire);
+}
+
+void SoftwareMixer::SetStartCallback(std::function<void(int buffer, uint64_t frame)> callback) {
+	m_startCallback = callback;
+}
+
+const MixerBuffer* SoftwareMixer::GetBuffer(int index) const {
+	if (index < 0 || index >= kMixerBufferChunk * kMixerBufferChunks) {
+		return nullptr;
+	}
+
+	auto chunk = m_slots[index / kMixerBufferChunk].load(std::memory_order_acquire);
+	return chunk ? chunk[index % kMixerBufferChunk].load(std::memory_order_acquire) : nullptr;
+}
+
+void SoftwareMixer::Start(const Command& command, int delay) {
+	if (command.Buffer == -1) {
+		for (auto& voice : m_voices) {
+			voice.Active = false;
+		}
+
+		m_scheduled.clear();
+		return;
+	}
+
+	const MixerBuffer* buffer = GetBuffer(command.Buffer);
+	if (buffer == nullptr || command.Rate <= 0.0f) {
+		return;
+	}
+
+	/* free voice first, otherwise the oldest one */
+	Voice* target = &m_voices[0];
+	for (auto& voice : m_voices) {
+		if (!voice.Active) {
+			target = &voice;
+			break;
+		}
+
+		if (voice.Started < target->Started) {
+			target = &voice;
+		}
+	}
+
+	float pan = std::clamp(command.Pan, -1.0f, 1.0f);
+
+	target->Buffer = buffer;
+	target->Position = 0;
+	target->Step = static_cast<double>(buffer->Frequency) / m_sampleRate * command.Rate;
+	target->Left = command.Volume * (pan > 0.0f ? 1.0f - pan : 1.0f);
+	target->Right = command.Volume * (pan < 0.0f ? 1.0f + pan : 1.0f);
+	target->Started = ++m_triggerCount;
+	target->Delay = delay;
+	target->Active = true;
+
+	if (m_startCallback) {
+		m_startCallback(command.Buffer, m_renderedFrames.load(std::memory_order_relaxed) + delay);
+	}
+}
+
+void SoftwareMixer::MixVoice(Voice& voice, float* output, int frames) {
+	auto& buffer = *voice.Buffer;
+	const float* data = buffer.Data.data();
+
+	if (voice.Delay > 0) {
+		int delay = (std::min)(voice.Delay, frames);
+		output += delay * 2;
+		frames -= delay;
+		voice.Delay -= delay;
+	}
+
+	if (voice.Step == 1.0) {
+		size_t position = static_cast<size_t>(voice.Position);
+		size_t count = (std::min)(static_cast<size_t>(frames), buffer.Frames - position);
+
+		MixStereo(output, data + position * 2, count * 2, voice.Left, voice.Right);
+
+		voice.Position += count;
+		voice.Active = voice.Position < buffer.Frames;
+		return;
+	}
+
+	/* resampled voices use linear interpolation */
+	for (int i = 0; i < frames; i++) {
+		size_t index = static_cast<size_t>(voice.Position);
+		if (index + 1 >= buffer.Frames) {
+			voice.Active = false;
+			return;
+		}
+
+		float t = static_cast<float>(voice.Position - index);
+		const float* a = data + index * 2;
+		const float* b = a + 2;
+
+		output[i * 2] += (a[0] + (b[0] - a[0]) * t) * voice.Left;
+		output[i * 2 + 1] += (a[1] + (b[1] - a[1]) * t) * voice.Right;
+
+		voice.Position += voice.Step;
+	}
+}
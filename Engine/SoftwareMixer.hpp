@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Threading/MpscQueue.hpp"
+
+constexpr int kMixerDefaultVoices = 256;
+constexpr int kMixerCommandCapacity = 4096;
+
+// Buffer table, allocated a chunk of slots at a time so published buffers never move
+constexpr int kMixerBufferChunk = 1024;
+constexpr int kMixerBufferChunks = 256;
+
+/* decoded once at load, always stereo interleaved float */
+struct MixerBuffer {
+	std::vector<float> Data;
+	int Frequency;
+	size_t Frames;
+};
+
+/*
+ * In-house keysound mixer. Samples are decoded once to float PCM, Render sums
+ * every active voice with volume, pan and rate into a stereo float block and
+ * doesn't depend on any audio library, so the same output can go to a device,
+ * a WAV file or nowhere (see MixerSink). Play/Stop can be called from any
+ * thread, they are queued and picked up at the start of the next Render, which
+ * makes offline renders sample accurate when Render is split at event frames.
+ * PlayAt takes an absolute output frame instead, the voice then starts at that
+ * exact offset inside whichever block covers it. Loaders add buffers while the
+ * output thread renders, a new buffer is published to Render with an atomic
+ * store so the audio callback never takes a lock.
+ */
+class SoftwareMixer {
+public:
+	SoftwareMixer(int sampleRate = 48000, int voiceCount = kMixerDefaultVoices);
+	~SoftwareMixer();
+
+	/* any thread, takes interleaved float PCM with 1 or 2 channels, -1 when the table is full */
+	int AddBuffer(std::vector<float> pcm, int channels, int frequency);
+	/* only while nothing renders, e.g. after the sink stopped */
+	void ClearBuffers();
+
+	/* any thread, volume 0..1, pan -1..1 */
+	void Play(int buffer, float volume, float pan = 0.0f, float rate = 1.0f);
+	void PlayAt(uint64_t frame, int buffer, float volume, float pan = 0.0f, float rate = 1.0f);
+	void StopAll();
+	void SetMasterVolume(float volume);
+
+	/* output thread, writes `frames` stereo frames */
+	void Render(float* output, int frames);
+
+	int GetSampleRate() const;
+	int GetActiveVoices() const;
+
+	/* audio clock, frames rendered so far, safe from any thread */
+	uint64_t GetRenderedFrames() const;
+
+	/* called from Render with the absolute frame every voice starts at, set it while nothing renders */
+	void SetStartCallback(std::function<void(int buffer, uint64_t frame)> callback);
+
+private:
+	struct Command {
+		/* 0 plays at the start of the next block */
+		uint64_t Frame;
+		int Buffer;
+		float Volume;
+		float Pan;
+		float Rate;
+	};
+
+	struct Voice {
+		const MixerBuffer* Buffer;
+		double Position;
+		double Step;
+		float Left;
+		float Right;
+		uint64_t Started;
+
+		/* frames of the current block left before the voice starts */
+		int Delay;
+		bool Active;
+	};
+
+	const MixerBuffer* GetBuffer(int index) const;
+	void Start(const Command& command, int delay);
+	void MixVoice(Voice& voice, float* output, int frames);
+
+	int m_sampleRate;
+	float m_masterVolume;
+
+	MpscQueue<Command> m_commands;
+
+	/* serializes AddBuffer callers only, Render reads the published slots */
+	std::mutex m_addLock;
+	std::vector<std::unique_ptr<MixerBuffer>> m_buffers;
+	std::atomic<std::atomic<const MixerBuffer*>*> m_slots[kMixerBufferChunks];
+
+	std::vector<Voice> m_voices;
+
+	/* min-heap on Frame, only touched by Render */
+	std::vector<Command> m_scheduled;
+	std::function<void(int, uint64_t)> m_startCallback;
+
+	uint64_t m_triggerCount;
+	std::atomic<uint64_t> m_renderedFrames;
+	std::atomic<int> m_activeVoices;
+};
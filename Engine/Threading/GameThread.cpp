@@ -20,13 +20,7 @@ void GameThread::Run(std::function<void()> callback, bool background) {
 		m_thread = std::thread([&] {
 			while (m_run) {
 				m_main_cb();
-
-				if (m_queue_cb.size()) {
-					std::function<void()> queue_cb = m_queue_cb.back();
-					m_queue_cb.pop_back();
-
-					queue_cb();
-				}
+				RunQueued();
 			}
 		});
 	}
@@ -38,19 +32,32 @@ void GameThread::Update() {
 	}
 
 	m_main_cb();
-	
-	if (m_queue_cb.size()) {
-		std::function<void()> queue_cb = m_queue_cb.back();
-		m_queue_cb.pop_back();
-
-		queue_cb();
-	}
+	RunQueued();
 }
 
 void GameThread::QueueAction(std::function<void()> callback) {
+	std::lock_guard<std::mutex> lock(m_queue_lock);
 	m_queue_cb.push_back(callback);
 }
 
+void GameThread::RunQueued() {
+	{
+		std::lock_guard<std::mutex> lock(m_queue_lock);
+		if (m_queue_cb.empty()) {
+			return;
+		}
+
+		m_run_cb.swap(m_queue_cb);
+	}
+
+	// Actions queued while these run wait for the next frame
+	for (auto& callback : m_run_cb) {
+		callback();
+	}
+
+	m_run_cb.clear();
+}
+
 void GameThread::Stop() {
 	if (m_background) {
 		m_run = false;
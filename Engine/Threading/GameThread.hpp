@@ -1,6 +1,7 @@
 #pragma once
 #include <thread>
 #include <functional>
+#include <mutex>
 #include <vector>
 
 class GameThread {
@@ -14,11 +15,16 @@ public:
 	void Update();
 	void Stop();
 private:
+	void RunQueued();
+
 	bool m_run;
 	bool m_background;
 
 	std::thread m_thread;
 
 	std::function<void()> m_main_cb;
+	/* FIFO, can be filled from any thread (job workers included) */
+	std::mutex m_queue_lock;
 	std::vector<std::function<void()>> m_queue_cb;
+	std::vector<std::function<void()>> m_run_cb;
 };
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+
+namespace {
+	// Render, gameplay, audio and input already own a core each on a typical
+	// machine, keep the pool from oversubscribing them.
+	constexpr int kReservedThreads = 3;
+
+	thread_local int t_workerIndex = -1;
+
+	// Priority of the job running on this thread, -1 outside of one
+	thread_local int t_priority = -1;
+}
+
+JobSystem* JobSystem::s_instance = nullptr;
+
+JobSystem::JobSystem() {
+	int count = (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()) - kReservedThreads);
+
+	m_nextWorker = 0;
+	m_waiters = 0;
+	m_running = true;
+
+	for (auto& queued : m_queued) {
+		queued = 0;
+	}
+
+	for (int i = 0; i < count; i++) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+
+	for (int i = 0; i < count; i++) {
+		m_workers[i]->Thread = std::thread([this, i] {
+			WorkerLoop(i);
+		});
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		m_running = false;
+	}
+
+	m_wake.notify_all();
+
+	for (auto& worker : m_workers) {
+		if (worker->Thread.joinable()) {
+			worker->Thread.join();
+		}
+	}
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> callback, JobPriority priority) {
+	return Schedule(callback, {}, priority);
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> callback, const std::vector<JobHandle>& dependencies, JobPriority priority) {
+	auto job = std::make_shared<Job>();
+	job->Callback = callback;
+	job->Priority = priority;
+
+	// Hold one count ourselves so a dependency finishing mid-loop can't queue it early
+	job->Pending = 1;
+
+	for (auto& dependency : dependencies) {
+		if (!dependency) {
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(dependency->Lock);
+		if (!dependency->Done) {
+			job->Pending++;
+			dependency->Dependents.push_back(job);
+		}
+	}
+
+	if (--job->Pending == 0) {
+		Enqueue(job);
+	}
+
+	return job;
+}
+
+void JobSystem::Wait(const JobHandle& job) {
+	if (!job) {
+		return;
+	}
+
+	// Only help with work at least as urgent as the caller's (the waited job's
+	// on threads outside the pool), so a loading screen waiting on a decode
+	// never ends up rendering a LOW priority preview. A job waiting on a less
+	// urgent one still helps at that level, otherwise nothing might run it.
+	int limit = static_cast<int>(job->Priority);
+	if (t_priority >= 0) {
+		limit = (std::max)(limit, t_priority);
+	}
+
+	while (!job->Done) {
+		JobHandle next = Next(t_workerIndex, limit);
+
+		if (next) {
+			Execute(next);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepLock);
+		m_waiters++;
+		m_finished.wait(lock, [&] {
+			return job->Done || HasQueued(limit);
+		});
+		m_waiters--;
+	}
+}
+
+bool JobSystem::IsDone(const JobHandle& job) {
+	return !job || job->Done;
+}
+
+int JobSystem::GetWorkerCount() {
+	return static_cast<int>(m_workers.size());
+}
+
+void JobSystem::WorkerLoop(int index) {
+	t_workerIndex = index;
+
+	while (m_running) {
+		JobHandle job = Next(index, kJobPriorityCount - 1);
+
+		if (job) {
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepLock);
+		m_wake.wait(lock, [this] {
+			return !m_running || HasQueued(kJobPriorityCount - 1);
+		});
+	}
+}
+
+void JobSystem::Enqueue(const JobHandle& job) {
+	// Workers push onto their own deque, everyone else spreads round-robin
+	int index = t_workerIndex;
+	if (index < 0) {
+		index = m_nextWorker++ % m_workers.size();
+	}
+
+	{
+		auto& worker = m_workers[index];
+		std::lock_guard<std::mutex> lock(worker->Lock);
+		worker->Queues[static_cast<int>(job->Priority)].push_back(job);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		m_queued[static_cast<int>(job->Priority)]++;
+	}
+
+	m_wake.notify_one();
+	if (m_waiters > 0) {
+		m_finished.notify_all();
+	}
+}
+
+void JobSystem::Execute(const JobHandle& job) {
+	int previous = t_priority;
+	t_priority = static_cast<int>(job->Priority);
+
+	job->Callback();
+	job->Callback = nullptr;
+
+	t_priority = previous;
+
+	std::vector<JobHandle> dependents;
+	{
+		std::lock_guard<std::mutex> lock(job->Lock);
+		job->Done = true;
+		dependents.swap(job->Dependents);
+	}
+
+	// Waiters check Done under the sleep lock, taking it here means a waiter
+	// can't miss this between its check and going to sleep
+	if (m_waiters > 0) {
+		{
+			std::lock_guard<std::mutex> lock(m_sleepLock);
+		}
+
+		m_finished.notify_all();
+	}
+
+	for (auto& dependent : dependents) {
+		if (--dependent->Pending == 0) {
+			Enqueue(dependent);
+		}
+	}
+}
+
+JobHandle JobSystem::Pop(int index, int priority) {
+	auto& worker = m_workers[index];
+	std::lock_guard<std::mutex> lock(worker->Lock);
+
+	auto& queue = worker->Queues[priority];
+	if (queue.size()) {
+		JobHandle job = queue.back();
+		queue.pop_back();
+		m_queued[priority]--;
+
+		return job;
+	}
+
+	return nullptr;
+}
+
+JobHandle JobSystem::Steal(int thief, int priority) {
+	int count = static_cast<int>(m_workers.size());
+	int start = thief < 0 ? 0 : thief + 1;
+
+	for (int i = 0; i < count; i++) {
+		int victim = (start + i) % count;
+		if (victim == thief) {
+			continue;
+		}
+
+		auto& worker = m_workers[victim];
+		std::lock_guard<std::mutex> lock(worker->Lock);
+
+		auto& queue = worker->Queues[priority];
+		if (queue.size()) {
+			JobHandle job = queue.front();
+			queue.pop_front();
+			m_queued[priority]--;
+
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+JobHandle JobSystem::Next(int index, int limit) {
+	// Priorities are global, a HIGH job on any worker goes before our own NORMAL ones
+	for (int priority = 0; priority <= limit; priority++) {
+		if (m_queued[priority] <= 0) {
+			continue;
+		}
+
+		if (index >= 0) {
+			JobHandle job = Pop(index, priority);
+			if (job) {
+				return job;
+			}
+		}
+
+		JobHandle job = Steal(index, priority);
+		if (job) {
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+bool JobSystem::HasQueued(int limit) {
+	for (int priority = 0; priority <= limit; priority++) {
+		if (m_queued[priority] > 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+JobSystem* JobSystem::GetInstance() {
+	if (s_instance == nullptr) {
+		s_instance = new JobSystem();
+	}
+
+	return s_instance;
+}
+
+void JobSystem::Release() {
+	if (s_instance != nullptr) {
+		delete s_instance;
+		s_instance = nullptr;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class JobPriority {
+	HIGH,
+	NORMAL,
+	LOW
+};
+
+constexpr int kJobPriorityCount = 3;
+
+struct Job;
+typedef std::shared_ptr<Job> JobHandle;
+
+struct Job {
+	std::function<void()> Callback;
+	JobPriority Priority = JobPriority::NORMAL;
+
+	/* dependencies left before the job can be queued, +1 while scheduling */
+	std::atomic<int> Pending{ 0 };
+	std::atomic<bool> Done{ false };
+
+	std::mutex Lock;
+	std::vector<JobHandle> Dependents;
+};
+
+/*
+ * Shared worker pool for background work (chart parsing, sample decoding,
+ * library scans). Every worker owns a deque per priority, it pops its own
+ * newest job and steals the oldest one from the others when it runs dry.
+ * Priorities hold across the pool: no worker starts a LOW job while a HIGH
+ * one is queued anywhere. Jobs only get queued once all their dependencies
+ * have finished.
+ *
+ * Jobs must not block on the render/input threads, use GameThread::QueueAction
+ * to hand results back to them.
+ */
+class JobSystem {
+public:
+	JobHandle Schedule(std::function<void()> callback, JobPriority priority = JobPriority::NORMAL);
+	JobHandle Schedule(std::function<void()> callback, const std::vector<JobHandle>& dependencies, JobPriority priority = JobPriority::NORMAL);
+
+	// Helps with queued jobs no less urgent than the caller until `job` is
+	// done, sleeps when there are none
+	void Wait(const JobHandle& job);
+	bool IsDone(const JobHandle& job);
+
+	int GetWorkerCount();
+
+	static JobSystem* GetInstance();
+	static void Release();
+
+private:
+	JobSystem();
+	~JobSystem();
+
+	static JobSystem* s_instance;
+
+	struct Worker {
+		std::mutex Lock;
+		std::deque<JobHandle> Queues[kJobPriorityCount];
+		std::thread Thread;
+	};
+
+	void WorkerLoop(int index);
+	void Enqueue(const JobHandle& job);
+	void Execute(const JobHandle& job);
+
+	JobHandle Pop(int index, int priority);
+	JobHandle Steal(int thief, int priority);
+	JobHandle Next(int index, int limit);
+	bool HasQueued(int limit);
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::atomic<unsigned int> m_nextWorker;
+	std::atomic<int> m_queued[kJobPriorityCount];
+	std::atomic<int> m_waiters;
+	std::atomic<bool> m_running;
+
+	std::mutex m_sleepLock;
+	std::condition_variable m_wake;
+	std::condition_variable m_finished;
+};
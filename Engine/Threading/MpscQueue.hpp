@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Bounded lock-free queue for any number of producer threads and exactly one
+ * consumer thread. Every slot carries a sequence number so producers claim a
+ * slot with one CAS and the consumer only takes slots whose write finished.
+ * Capacity is rounded up to a power of two, TryPush fails when it's full.
+ */
+template <typename T>
+class MpscQueue {
+public:
+	MpscQueue(size_t capacity) {
+		size_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+
+		m_buffer = std::vector<Cell>(size);
+		for (size_t i = 0; i < size; i++) {
+			m_buffer[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+
+		m_mask = size - 1;
+		m_head.store(0, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+	}
+
+	/* producer side, any thread */
+	bool TryPush(const T& value) {
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+
+		for (;;) {
+			Cell& cell = m_buffer[tail & m_mask];
+			size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(tail);
+
+			if (diff == 0) {
+				if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+					cell.Value = value;
+					cell.Sequence.store(tail + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				tail = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/* consumer side */
+	bool TryPop(T& value) {
+		size_t head = m_head.load(std::memory_order_relaxed);
+		Cell& cell = m_buffer[head & m_mask];
+
+		if (cell.Sequence.load(std::memory_order_acquire) != head + 1) {
+			return false;
+		}
+
+		value = cell.Value;
+		cell.Sequence.store(head + m_mask + 1, std::memory_order_release);
+		m_head.store(head + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void Clear() {
+		T value;
+		while (TryPop(value)) {}
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> Sequence;
+		T Value;
+
+		Cell() : Sequence(0), Value() {}
+	};
+
+	std::vector<Cell> m_buffer;
+	size_t m_mask;
+
+	alignas(64) std::atomic<size_t> m_head;
+	alignas(64) std::atomic<size_t> m_tail;
+};
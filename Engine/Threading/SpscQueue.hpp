@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Bounded wait-free queue for exactly one producer thread and one consumer
+ * thread. Capacity is rounded up to a power of two, TryPush fails instead of
+ * blocking when the consumer falls that far behind.
+ */
+template <typename T>
+class SpscQueue {
+public:
+	SpscQueue(size_t capacity) {
+		size_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+
+		m_buffer.resize(size);
+		m_mask = size - 1;
+		m_head.store(0, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+	}
+
+	/* producer side */
+	bool TryPush(const T& value) {
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+			return false;
+		}
+
+		m_buffer[tail & m_mask] = value;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* consumer side */
+	bool TryPop(T& value) {
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		value = m_buffer[head & m_mask];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	void Clear() {
+		T value;
+		while (TryPop(value)) {}
+	}
+
+private:
+	std::vector<T> m_buffer;
+	size_t m_mask;
+
+	alignas(64) std::atomic<size_t> m_head;
+	alignas(64) std::atomic<size_t> m_tail;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Lock-free triple buffer for one writer thread and one reader thread.
+ * The writer fills the back buffer and publishes it by swapping it with the
+ * middle one, the reader takes the middle one only when it holds something
+ * newer. Neither side ever waits for the other, the reader just keeps the
+ * last buffer it took until a newer one is published.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() {
+		m_front = 0;
+		m_back = 2;
+		m_middle.store(1, std::memory_order_relaxed);
+	}
+
+	/* writer side, the returned buffer holds stale data and must be fully rewritten */
+	T& Write() {
+		return m_buffers[m_back];
+	}
+
+	void Publish() {
+		uint8_t previous = m_middle.exchange(m_back | kDirtyBit, std::memory_order_acq_rel);
+		m_back = previous & kIndexMask;
+	}
+
+	/* reader side, returns true when a newer buffer was taken */
+	bool Swap() {
+		if ((m_middle.load(std::memory_order_relaxed) & kDirtyBit) == 0) {
+			return false;
+		}
+
+		uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+		m_front = previous & kIndexMask;
+		return true;
+	}
+
+	const T& Read() const {
+		return m_buffers[m_front];
+	}
+
+private:
+	static constexpr uint8_t kIndexMask = 0x3;
+	static constexpr uint8_t kDirtyBit = 0x4;
+
+	T m_buffers[3];
+
+	uint8_t m_front;
+	uint8_t m_back;
+	std::atomic<uint8_t> m_middle;
+};
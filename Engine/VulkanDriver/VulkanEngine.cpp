@@ -10,6 +10,7 @@
 #include "vkinit.h"
 #include "../imgui/imgui_impl_vulkan.h"
 #include "../imgui/imgui_impl_sdl2.h"
+#include "../imgui/implot.h"
 #include "../SDLException.hpp"
 #include "Texture2DVulkan.h"
 
@@ -244,6 +245,7 @@ void VulkanEngine::imgui_init() {
 	VK_CHECK(vkCreateDescriptorPool(_device, &pool_info, nullptr, &imguiPool));
 
 	ImGui::CreateContext();
+	ImPlot::CreateContext();
 	ImGui::StyleColorsDark();
 
 	ImGui_ImplSDL2_InitForVulkan(_window);
@@ -30,6 +30,7 @@ Chart::Chart(Osu::Beatmap& beatmap) {
 	m_keyCount = beatmap.CircleSize;
 	m_artist = std::u8string(beatmap.Artist.begin(), beatmap.Artist.end());
 	m_beatmapDirectory = beatmap.CurrentDir;
+	m_directoryIndex.Build(m_beatmapDirectory);
 
 	for (auto& event : beatmap.Events) {
 		switch (event.Type) {
@@ -45,8 +46,7 @@ Chart::Chart(Osu::Beatmap& beatmap) {
 				std::string fileName = event.params[1];
 				fileName.erase(std::remove(fileName.begin(), fileName.end(), '\"'), fileName.end());
 
-				auto path = beatmap.CurrentDir / fileName;
-				if (std::filesystem::exists(path)) {
+				if (m_directoryIndex.Exists(fileName)) {
 					AutoSample sample = {};
 					sample.StartTime = event.StartTime;
 					sample.Index = beatmap.GetCustomSampleIndex(fileName);
@@ -166,6 +166,7 @@ Chart::Chart(BMS::BMSFile& file) {
 	}
 
 	m_beatmapDirectory = file.CurrentDir;
+	m_directoryIndex.Build(m_beatmapDirectory);
 	m_title = std::u8string(file.Title.begin(), file.Title.end());
 	m_audio = "";// file.FileDirectory + "/" + "test.mp3";
 	m_keyCount = 7;
@@ -358,6 +359,7 @@ Chart::Chart(O2::OJN& file, int diffIndex) {
 	for (auto& sample : diff.Samples) {
 		Sample sm = {};
 		sm.FileBuffer = sample.AudioData;
+		sm.ContentHash = sample.ContentHash;
 		sm.Index = sample.RefValue;
 		sm.Type = 2;
 		
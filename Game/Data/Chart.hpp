@@ -3,6 +3,7 @@
 #include "osu.hpp"
 #include "bms.hpp"
 #include "OJN.h"
+#include "DirectoryIndex.hpp"
 #include <unordered_map>
 
 class AudioSample;
@@ -42,7 +43,8 @@ struct TimingInfo {
 
 struct Sample {
 	std::filesystem::path FileName;
-	std::vector<uint8_t> FileBuffer;
+	SampleBuffer FileBuffer;
+	uint64_t ContentHash = 0;
 
 	uint32_t Type = 1;
 	uint32_t Index;
@@ -84,6 +86,7 @@ public:
 	std::u8string m_artist;
 	std::string m_audio;
 	std::filesystem::path m_beatmapDirectory;
+	DirectoryIndex m_directoryIndex;
 
 	std::vector<NoteInfo> m_notes;
 	std::vector<TimingInfo> m_bpms;
@@ -0,0 +1,169 @@
+#include "DirectoryIndex.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+	std::string FoldCase(const std::filesystem::path& path) {
+		auto u8 = path.generic_u8string();
+		std::string result(u8.begin(), u8.end());
+
+		for (auto& c : result) {
+			if (c >= 'A' && c <= 'Z') {
+				c = c - 'A' + 'a';
+			}
+		}
+
+		return result;
+	}
+}
+
+DirectoryIndex::DirectoryIndex(std::filesystem::path directory) {
+	Build(directory);
+}
+
+void DirectoryIndex::Build(std::filesystem::path directory) {
+	Clear();
+	m_directory = directory.lexically_normal();
+	if (!m_directory.has_filename() && m_directory.has_relative_path()) {
+		m_directory = m_directory.parent_path();
+	}
+
+	std::error_code ec;
+	auto it = std::filesystem::directory_iterator(directory, ec);
+	if (ec) {
+		std::cout << "[DirectoryIndex] Failed to list " << directory.string() << ": " << ec.message() << std::endl;
+		return;
+	}
+
+	for (auto& entry : it) {
+		auto name = entry.path().filename();
+		bool isDirectory = entry.is_directory(ec);
+
+		m_files[FoldCase(name)] = { entry.path(), isDirectory };
+		if (!isDirectory) {
+			m_stems[FoldCase(name.stem())].push_back(entry.path());
+		}
+	}
+}
+
+void DirectoryIndex::Clear() {
+	m_directory.clear();
+	m_files.clear();
+	m_stems.clear();
+	m_folders.clear();
+}
+
+std::filesystem::path DirectoryIndex::Resolve(std::filesystem::path name) const {
+	auto relative = MakeRelative(name);
+	if (relative.empty()) {
+		return {};
+	}
+
+	auto folder = FindFolder(relative.parent_path());
+	if (folder == nullptr) {
+		return {};
+	}
+
+	auto it = folder->m_files.find(FoldCase(relative.filename()));
+	if (it == folder->m_files.end() || it->second.IsDirectory) {
+		return {};
+	}
+
+	return it->second.Path;
+}
+
+std::filesystem::path DirectoryIndex::Resolve(std::filesystem::path name, const std::vector<std::string>& extensions) const {
+	auto relative = MakeRelative(name);
+	if (relative.empty()) {
+		return {};
+	}
+
+	auto folder = FindFolder(relative.parent_path());
+	if (folder == nullptr) {
+		return {};
+	}
+
+	auto stem = folder->m_stems.find(FoldCase(relative.stem()));
+	if (stem != folder->m_stems.end()) {
+		for (auto& ext : extensions) {
+			auto foldedExt = FoldCase(ext);
+
+			for (auto& file : stem->second) {
+				if (FoldCase(file.extension()) == foldedExt) {
+					return file;
+				}
+			}
+		}
+	}
+
+	auto it = folder->m_files.find(FoldCase(relative.filename()));
+	if (it == folder->m_files.end() || it->second.IsDirectory) {
+		return {};
+	}
+
+	return it->second.Path;
+}
+
+bool DirectoryIndex::Exists(std::filesystem::path name) const {
+	return !Resolve(name).empty();
+}
+
+bool DirectoryIndex::IsEmpty() const {
+	return m_files.empty();
+}
+
+const std::filesystem::path& DirectoryIndex::GetDirectory() const {
+	return m_directory;
+}
+
+const DirectoryIndex* DirectoryIndex::FindFolder(const std::filesystem::path& relative) const {
+	const DirectoryIndex* folder = this;
+
+	for (auto& part : relative) {
+		if (part.empty() || part == ".") {
+			continue;
+		}
+
+		auto key = FoldCase(part);
+		auto cached = folder->m_folders.find(key);
+		if (cached != folder->m_folders.end()) {
+			folder = cached->second.get();
+			continue;
+		}
+
+		auto it = folder->m_files.find(key);
+		if (it == folder->m_files.end() || !it->second.IsDirectory) {
+			return nullptr;
+		}
+
+		auto index = std::make_shared<DirectoryIndex>(it->second.Path);
+		folder->m_folders[key] = index;
+		folder = index.get();
+	}
+
+	return folder;
+}
+
+std::filesystem::path DirectoryIndex::MakeRelative(const std::filesystem::path& name) const {
+	std::filesystem::path relative = name;
+
+	/* sample paths usually come in already joined with the chart folder */
+	auto mismatch = std::mismatch(m_directory.begin(), m_directory.end(), name.begin(), name.end());
+	if (!m_directory.empty() && mismatch.first == m_directory.end()) {
+		relative = name.lexically_relative(m_directory);
+	}
+	else if (name.is_absolute()) {
+		return {};
+	}
+
+	/* charts made on Windows can use backslashes as separators */
+	auto generic = relative.generic_u8string();
+	std::replace(generic.begin(), generic.end(), u8'\\', u8'/');
+
+	relative = std::filesystem::path(generic).lexically_normal();
+	if (relative.empty() || *relative.begin() == "..") {
+		return {};
+	}
+
+	return relative;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Case-insensitive view of one chart folder. The folder is listed once with a
+ * single directory_iterator and every lookup after that is a map probe, so
+ * charts authored on Windows resolve on case-sensitive filesystems too and
+ * loading doesn't stat every keysound candidate. Subfolders are only listed
+ * the first time a lookup walks into them. Not thread safe, build and use it
+ * from the loading thread.
+ */
+class DirectoryIndex {
+public:
+	DirectoryIndex() = default;
+	DirectoryIndex(std::filesystem::path directory);
+
+	void Build(std::filesystem::path directory);
+	void Clear();
+
+	/* exact name match, returns an empty path if it isn't there */
+	std::filesystem::path Resolve(std::filesystem::path name) const;
+
+	/* stem match taking the first extension available in order, then the exact name */
+	std::filesystem::path Resolve(std::filesystem::path name, const std::vector<std::string>& extensions) const;
+
+	bool Exists(std::filesystem::path name) const;
+	bool IsEmpty() const;
+	const std::filesystem::path& GetDirectory() const;
+
+private:
+	struct Entry {
+		std::filesystem::path Path;
+		bool IsDirectory;
+	};
+
+	const DirectoryIndex* FindFolder(const std::filesystem::path& relative) const;
+	std::filesystem::path MakeRelative(const std::filesystem::path& name) const;
+
+	std::filesystem::path m_directory;
+	std::unordered_map<std::string, Entry> m_files;
+
+	/* folded stem to every file sharing it, e.g. "kick" -> kick.wav, KICK.ogg */
+	std::unordered_map<std::string, std::vector<std::filesystem::path>> m_stems;
+
+	mutable std::map<std::string, std::shared_ptr<DirectoryIndex>> m_folders;
+};
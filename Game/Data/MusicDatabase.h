@@ -1,8 +1,9 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
 
 const char signature[2] = { 'D', 'B' };
-const int version = 2;
+const int version = 4;
 
 struct DB_Header {
 	char8_t Signature[2];
@@ -23,6 +24,17 @@ struct DB_MusicItem {
 	int CoverOffset;
 	int ThumbnailSize;
 	int CoverSize;
+
+	/* OJM keysound dedup, refs vs distinct payloads */
+	int SampleCount;
+	int UniqueSampleCount;
+	uint64_t SampleBytes;
+	uint64_t UniqueSampleBytes;
+
+	/* integrated loudness of the full mix (LUFS) and the gain to the target (dB), see LoudnessScanner */
+	float Loudness;
+	float ReplayGain;
+	int LoudnessState;
 };
 
 class MusicDatabase {
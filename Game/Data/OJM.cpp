@@ -2,6 +2,7 @@
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <unordered_set>
 #include "Util/Util.hpp"
 
 constexpr int kM30Signature = 0x0030334D;
@@ -78,9 +79,9 @@ std::vector<char> WeirdRearrange(char* data, size_t sz) {
 	return res;
 }
 
-// weird tracking
-static int accKeyByte = 0xFF;
-static int accCounter = 0;
+// weird tracking, per thread so OJMs can load on several jobs at once
+static thread_local int accKeyByte = 0xFF;
+static thread_local int accCounter = 0;
 
 std::vector<char> XorDecrypt(std::vector<char>& data) {
 	int tmp; char this_char;
@@ -109,6 +110,30 @@ std::vector<char> XorDecrypt(std::vector<char>& data) {
 OJM::~OJM() {
 }
 
+void OJM::AddSample(O2Sample& sample, std::vector<uint8_t>&& data) {
+	m_stats.Samples++;
+	m_stats.Bytes += data.size();
+
+	if (m_scan) {
+		uint64_t hash = SampleStore::Hash(data.data(), data.size());
+
+		if (m_scanned.insert({ hash, data.size() }).second) {
+			m_stats.UniqueSamples++;
+			m_stats.UniqueBytes += data.size();
+		}
+
+		if (m_scan->Add(hash, data.size())) {
+			m_stats.NewSamples++;
+			m_stats.NewBytes += data.size();
+		}
+
+		return;
+	}
+
+	sample.AudioData = SampleStore::Intern(std::move(data), sample.ContentHash);
+	Samples.push_back(sample);
+}
+
 void OJM::Load(std::filesystem::path& fileName) {
 	if (!std::filesystem::exists(fileName)) {
 		return;
@@ -148,14 +173,32 @@ void OJM::Load(std::filesystem::path& fileName) {
 		return a.RefValue < b.RefValue;
 	});
 
+	std::unordered_set<const void*> unique;
+	for (auto& sample : Samples) {
+		if (unique.insert(sample.AudioData.get()).second) {
+			m_stats.UniqueSamples++;
+			m_stats.UniqueBytes += sample.AudioData->size();
+		}
+	}
+
 	fs.close();
 	m_valid = true;
 }
 
+void OJM::Scan(std::filesystem::path& fileName, SampleScan& scan) {
+	m_scan = &scan;
+	Load(fileName);
+	m_scan = nullptr;
+}
+
 bool OJM::IsValid() {
 	return m_valid;
 }
 
+OJMDedupStats OJM::GetDedupStats() {
+	return m_stats;
+}
+
 void OJM::LoadM30Data(std::fstream& fs) {
 	struct M30Header {
 		int fileFormatVersion;
@@ -207,9 +250,8 @@ void OJM::LoadM30Data(std::fstream& fs) {
 
 		O2Sample sample = {};
 		sample.RefValue = SampleHeader.ValueRef;
-		sample.AudioData.insert(sample.AudioData.end(), buffer, buffer + SampleHeader.sampleSize);
 
-		Samples.push_back(sample);
+		AddSample(sample, std::vector<uint8_t>(buffer, buffer + SampleHeader.sampleSize));
 		delete[] buffer;
 	}
 }
@@ -296,13 +338,12 @@ void OJM::LoadOJMData(std::fstream& fs, bool encrypted) {
 
 		O2Sample sample = {};
 		sample.RefValue = ValueRef++;
-		sample.AudioData.resize(ss.str().size());
-		memcpy(sample.AudioData.data(), ss.str().data(), ss.str().size());
 
 		auto utf8_name = CodepageToUtf8(SampleHeader.sampleName, sizeof(SampleHeader.sampleName), 949);
 		memcpy(sample.FileName, utf8_name.c_str(), sizeof(sample.FileName));
 
-		Samples.push_back(sample);
+		std::string wav = ss.str();
+		AddSample(sample, std::vector<uint8_t>(wav.begin(), wav.end()));
 	}
 
 	fs.seekg(Header.oggOffset, std::ios::beg);
@@ -326,13 +367,11 @@ void OJM::LoadOJMData(std::fstream& fs, bool encrypted) {
 
 		O2Sample sample = {};
 		sample.RefValue = ValueRef++;
-		sample.AudioData.resize(SampleHeader.sampleSize);
-		memcpy(sample.AudioData.data(), buffer, SampleHeader.sampleSize);
 
 		auto utf8_name = CodepageToUtf8(SampleHeader.sampleName, sizeof(SampleHeader.sampleName), 949);
 		memcpy(sample.FileName, utf8_name.c_str(), sizeof(sample.FileName));
 
-		Samples.push_back(sample);
+		AddSample(sample, std::vector<uint8_t>(buffer, buffer + SampleHeader.sampleSize));
 		delete[] buffer;
 	}
 }
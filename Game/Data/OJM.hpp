@@ -1,28 +1,52 @@
 #pragma once
 #include <filesystem>
 #include <vector>
+#include "SampleStore.hpp"
 
 struct O2Sample {
 	char8_t FileName[32];
 	uint32_t RefValue;
-	std::vector<uint8_t> AudioData;
+
+	/* shared with every other ref holding the same payload */
+	SampleBuffer AudioData;
+	uint64_t ContentHash;
 
 	~O2Sample() {
-		AudioData.clear();
+		AudioData.reset();
 	}
 };
 
+struct OJMDedupStats {
+	int Samples;
+	int UniqueSamples;
+
+	uint64_t Bytes;
+	uint64_t UniqueBytes;
+
+	/* payloads no other OJM of the same scan had yet, sums to the library's unique total */
+	int NewSamples;
+	uint64_t NewBytes;
+};
+
 class OJM {
 public:
 	~OJM();
 
 	void Load(std::filesystem::path& fileName);
+	/* stats only, hashes every payload against `scan` without keeping the samples */
+	void Scan(std::filesystem::path& fileName, SampleScan& scan);
 	bool IsValid();
+	OJMDedupStats GetDedupStats();
 
 	std::vector<O2Sample> Samples;
 private:
 	void LoadM30Data(std::fstream& fs);
 	void LoadOJMData(std::fstream& fs, bool encrypted);
+	void AddSample(O2Sample& sample, std::vector<uint8_t>&& data);
 	
-	bool m_valid;
+	bool m_valid = false;
+	OJMDedupStats m_stats = {};
+
+	SampleScan* m_scan = nullptr;
+	std::set<std::pair<uint64_t, size_t>> m_scanned;
 };
\ No newline at end of file
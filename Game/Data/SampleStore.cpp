@@ -0,0 +1,73 @@
+#include "SampleStore.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace SampleStore {
+	std::mutex m_lock;
+
+	/* weak so a payload goes away with the last chart using it */
+	std::unordered_map<uint64_t, std::vector<std::weak_ptr<const std::vector<uint8_t>>>> m_buffers;
+}
+
+uint64_t SampleStore::Hash(const uint8_t* data, size_t size) {
+	uint64_t hash = 14695981039346656037ull;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+SampleBuffer SampleStore::Intern(std::vector<uint8_t>&& data, uint64_t& hash) {
+	hash = Hash(data.data(), data.size());
+
+	/* released after the lock, the last reference runs the deleter below which locks again */
+	std::vector<SampleBuffer> held;
+	std::lock_guard<std::mutex> lock(m_lock);
+	auto& bucket = m_buffers[hash];
+
+	for (auto& it : bucket) {
+		auto buffer = it.lock();
+
+		/* FNV can collide, only equal bytes are the same sample */
+		if (buffer && buffer->size() == data.size() && memcmp(buffer->data(), data.data(), data.size()) == 0) {
+			return buffer;
+		}
+
+		held.push_back(std::move(buffer));
+	}
+
+	/* the last chart dropping the payload takes its bucket entry with it */
+	uint64_t key = hash;
+	auto buffer = SampleBuffer(new std::vector<uint8_t>(std::move(data)), [key](const std::vector<uint8_t>* payload) {
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			auto it = m_buffers.find(key);
+			if (it != m_buffers.end()) {
+				auto& bucket = it->second;
+				bucket.erase(std::remove_if(bucket.begin(), bucket.end(), [](auto& entry) {
+					return entry.expired();
+				}), bucket.end());
+
+				if (bucket.empty()) {
+					m_buffers.erase(it);
+				}
+			}
+		}
+
+		delete payload;
+	});
+
+	bucket.push_back(buffer);
+	return buffer;
+}
+
+bool SampleScan::Add(uint64_t hash, size_t size) {
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_seen.insert({ hash, size }).second;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+typedef std::shared_ptr<const std::vector<uint8_t>> SampleBuffer;
+
+/*
+ * Content-addressed store for decoded keysound payloads. OJMs often carry the
+ * same sound under several refs and song packs share whole drum kits, so a
+ * payload is kept once for as long as any chart still refers to it.
+ */
+namespace SampleStore {
+	uint64_t Hash(const uint8_t* data, size_t size);
+
+	/* returns the stored buffer with the same content, or stores this one */
+	SampleBuffer Intern(std::vector<uint8_t>&& data, uint64_t& hash);
+}
+
+/*
+ * Payload hashes seen over one library scan. Only hash and size are kept, so
+ * a kit shared by several OJMs counts once without holding any sample data.
+ */
+class SampleScan {
+public:
+	/* true the first time this content is seen in the scan, any thread */
+	bool Add(uint64_t hash, size_t size);
+
+private:
+	std::mutex m_lock;
+	std::set<std::pair<uint64_t, size_t>> m_seen;
+};
@@ -0,0 +1,210 @@
+#include "ScoreDatabase.h"
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+namespace {
+	uint32_t Checksum(const DB_ScoreRecord& record) {
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(&record);
+		uint32_t hash = 2166136261u;
+
+		for (size_t i = 0; i < offsetof(DB_ScoreRecord, Checksum); i++) {
+			hash ^= data[i];
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+
+	int RateKey(float rate) {
+		return static_cast<int>(std::lround(rate * 100.0f));
+	}
+}
+
+ScoreDatabase* ScoreDatabase::m_instance = nullptr;
+
+ScoreDatabase* ScoreDatabase::GetInstance() {
+	if (m_instance == nullptr) {
+		m_instance = new ScoreDatabase();
+	}
+
+	return m_instance;
+}
+
+void ScoreDatabase::Release() {
+	if (m_instance) {
+		delete m_instance;
+		m_instance = nullptr;
+	}
+}
+
+ScoreDatabase::ScoreDatabase() {
+	m_records = {};
+}
+
+bool ScoreDatabase::BestKey::operator<(const BestKey& other) const {
+	return std::tie(Hash, Mods, Rate) < std::tie(other.Hash, other.Mods, other.Rate);
+}
+
+void ScoreDatabase::Load(std::filesystem::path path) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	m_path = path;
+	m_records.clear();
+	m_bests.clear();
+	m_songBests.clear();
+	m_recent.clear();
+
+	DB_ScoreHeader header = {};
+	bool valid = false;
+
+	if (std::filesystem::exists(path)) {
+		std::fstream fs(path, std::ios::binary | std::ios::in);
+		fs.read((char*)&header, sizeof(DB_ScoreHeader));
+
+		valid = fs.gcount() == sizeof(DB_ScoreHeader)
+			&& memcmp(header.Signature, scoreSignature, 2) == 0
+			&& header.Version == scoreVersion
+			&& header.RecordSize == sizeof(DB_ScoreRecord);
+
+		if (valid) {
+			DB_ScoreRecord record = {};
+			int position = 0, damaged = 0;
+
+			// A bad record is skipped on its own, the plays after it are still good
+			while (fs.read((char*)&record, sizeof(DB_ScoreRecord))) {
+				position++;
+
+				if (record.Checksum != Checksum(record)) {
+					std::cout << "[ScoreDatabase] Skipping damaged record #" << position << std::endl;
+					damaged++;
+					continue;
+				}
+
+				m_records.push_back(record);
+				Index(static_cast<int>(m_records.size()) - 1);
+			}
+
+			fs.close();
+
+			// Drop the partial record a crash mid-write left at the end, the next
+			// append has to start on a record boundary
+			uintmax_t size = sizeof(DB_ScoreHeader) + static_cast<uintmax_t>(position) * sizeof(DB_ScoreRecord);
+			if (std::filesystem::file_size(path) != size) {
+				std::cout << "[ScoreDatabase] Discarding partial record after #" << position << std::endl;
+				std::filesystem::resize_file(path, size);
+			}
+
+			if (damaged > 0) {
+				std::cout << "[ScoreDatabase] Kept " << m_records.size() << " records, skipped " << damaged << " damaged" << std::endl;
+			}
+		}
+		else {
+			std::cout << "[ScoreDatabase] " << path.string() << " is not a score database, starting a new one" << std::endl;
+		}
+	}
+
+	if (!valid) {
+		std::fstream fs(path, std::ios::binary | std::ios::out | std::ios::trunc);
+
+		memcpy(header.Signature, scoreSignature, 2);
+		header.Version = scoreVersion;
+		header.RecordSize = sizeof(DB_ScoreRecord);
+
+		fs.write((char*)&header, sizeof(DB_ScoreHeader));
+		fs.close();
+	}
+}
+
+bool ScoreDatabase::Insert(DB_ScoreRecord record) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_path.empty()) {
+		return false;
+	}
+
+	record.Checksum = Checksum(record);
+
+	std::fstream fs(m_path, std::ios::binary | std::ios::out | std::ios::app);
+	fs.write((char*)&record, sizeof(DB_ScoreRecord));
+	fs.flush();
+
+	if (!fs.good()) {
+		std::cout << "[ScoreDatabase] Failed to write " << m_path.string() << std::endl;
+		return false;
+	}
+
+	fs.close();
+
+	m_records.push_back(record);
+	Index(static_cast<int>(m_records.size()) - 1);
+
+	return true;
+}
+
+void ScoreDatabase::Index(int index) {
+	auto& record = m_records[index];
+
+	BestKey key = { std::string(record.Hash, sizeof(record.Hash)), record.Mods, RateKey(record.Rate) };
+	auto best = m_bests.find(key);
+	if (best == m_bests.end() || m_records[best->second].Score < record.Score) {
+		m_bests[key] = index;
+	}
+
+	auto song = std::make_pair(record.SongId, record.Difficulty);
+	auto songBest = m_songBests.find(song);
+	if (songBest == m_songBests.end() || m_records[songBest->second].Score < record.Score) {
+		m_songBests[song] = index;
+	}
+
+	m_recent.push_front(index);
+	if (m_recent.size() > kScoreRecentCount) {
+		m_recent.pop_back();
+	}
+}
+
+bool ScoreDatabase::GetBest(const std::string& hash, int mods, float rate, DB_ScoreRecord& record) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	std::string key = hash.substr(0, sizeof(record.Hash));
+	key.resize(sizeof(record.Hash), '\0');
+
+	auto it = m_bests.find({ key, mods, RateKey(rate) });
+	if (it == m_bests.end()) {
+		return false;
+	}
+
+	record = m_records[it->second];
+	return true;
+}
+
+bool ScoreDatabase::GetSongBest(int songId, int difficulty, DB_ScoreRecord& record) {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	auto it = m_songBests.find(std::make_pair(songId, difficulty));
+	if (it == m_songBests.end()) {
+		return false;
+	}
+
+	record = m_records[it->second];
+	return true;
+}
+
+std::vector<DB_ScoreRecord> ScoreDatabase::GetRecent() {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	std::vector<DB_ScoreRecord> result;
+	for (int index : m_recent) {
+		result.push_back(m_records[index]);
+	}
+
+	return result;
+}
+
+int ScoreDatabase::GetRecordCount() {
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	return static_cast<int>(m_records.size());
+}
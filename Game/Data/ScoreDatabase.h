@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const char scoreSignature[2] = { 'S', 'C' };
+const int scoreVersion = 1;
+
+// Number of plays kept in the recent list
+constexpr int kScoreRecentCount = 20;
+
+enum ScoreMods {
+	SCORE_MOD_NONE = 0,
+	SCORE_MOD_MIRROR = 1 << 0,
+	SCORE_MOD_RANDOM = 1 << 1,
+	SCORE_MOD_REARRANGE = 1 << 2
+};
+
+struct DB_ScoreHeader {
+	char Signature[2];
+	short Version;
+	int RecordSize;
+};
+
+struct DB_ScoreRecord {
+	char Hash[32];
+	int SongId;
+	int Difficulty;
+	int Mods;
+	float Rate;
+	int64_t Timestamp;
+
+	int Score;
+	int Cool;
+	int Good;
+	int Bad;
+	int Miss;
+	int MaxCombo;
+	int MaxJamCombo;
+	int LNMaxCombo;
+	float MeanOffset;
+
+	/* FNV-1a of everything above, a torn or corrupted record fails this */
+	uint32_t Checksum;
+};
+
+/*
+ * Local play history. Score.db is only ever appended to and flushed per play,
+ * on load the records are replayed into in-memory indexes. Records failing
+ * their checksum are skipped and a partial record from a crash mid-write is
+ * cut off.
+ */
+class ScoreDatabase {
+public:
+	void Load(std::filesystem::path path);
+	bool Insert(DB_ScoreRecord record);
+
+	// Best play of a chart with exactly these mods and rate
+	bool GetBest(const std::string& hash, int mods, float rate, DB_ScoreRecord& record);
+	// Best play of a song difficulty with any mods and rate, for the song list
+	bool GetSongBest(int songId, int difficulty, DB_ScoreRecord& record);
+	std::vector<DB_ScoreRecord> GetRecent();
+
+	int GetRecordCount();
+
+	static ScoreDatabase* GetInstance();
+	static void Release();
+private:
+	static ScoreDatabase* m_instance;
+	ScoreDatabase();
+
+	struct BestKey {
+		std::string Hash;
+		int Mods;
+		int Rate;
+
+		bool operator<(const BestKey& other) const;
+	};
+
+	void Index(int index);
+
+	std::mutex m_lock;
+	std::filesystem::path m_path;
+
+	std::vector<DB_ScoreRecord> m_records;
+	std::map<BestKey, int> m_bests;
+	std::map<std::pair<int, int>, int> m_songBests;
+	std::deque<int> m_recent;
+};
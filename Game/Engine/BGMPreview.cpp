@@ -1,14 +1,27 @@
 #include "BGMPreview.hpp"
-#include "GameAudioSampleCache.hpp"
-#include "../Data/Chart.hpp"
-#include "../../Engine/Configuration.hpp"
+#include "PreviewBuilder.hpp"
+#include "LoudnessScanner.hpp"
+#include "../../Engine/Audio.hpp"
+#include "../../Engine/Threading/JobSystem.hpp"
 #include "../EnvironmentSetup.hpp"
 #include "../Data/MusicDatabase.h"
-#include <future>
+#include <algorithm>
+#include <iostream>
+
+// Volume previews play at before the song's replay gain
+constexpr int kPreviewVolume = 50;
 
 BGMPreview::~BGMPreview() {
+	/* queued loads see they're stale and return without rendering */
+	m_currentState++;
+	for (auto& job : m_jobs) {
+		JobSystem::GetInstance()->Wait(job);
+	}
+
 	if (m_mutex) {
 		std::lock_guard<std::mutex> lock(*m_mutex);
+
+		m_audio.reset();
 	}
 
 	m_callback = [&](bool) {};
@@ -18,135 +31,93 @@ BGMPreview::~BGMPreview() {
 void BGMPreview::Load(int index) {
 	OnStarted = false;
 	OnPause = false;
-	m_rate = 1;
 	m_bgmIndex = index;
 
 	if (m_mutex == nullptr) {
 		m_mutex = new std::mutex();
 	}
 
-	if (m_autoSamples.size() == 0) {
-		m_autoSamples = std::vector<AutoSample>(10);
-		m_autoSamples.reserve(50);
-	}
+	/* a later Load or Stop makes this one stale, a queued job for it then skips the render */
+	int state = ++m_currentState;
 
-	auto tr = std::thread([&] {
-		int state = ++m_currentState;
+	m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), [](const JobHandle& job) {
+		return JobSystem::GetInstance()->IsDone(job);
+	}), m_jobs.end());
 
-		std::lock_guard<std::mutex> lock(*m_mutex);
-		Ready = false;
-
-		DB_MusicItem* item = MusicDatabase::GetInstance()->Find(m_bgmIndex);
+	/* the job gets a copy, song select keeps writing the database while it runs */
+	DB_MusicItem* found = MusicDatabase::GetInstance()->Find(index);
+	if (found == nullptr) {
+		return;
+	}
 
-		auto path = Configuration::Load("Music", "Folder");
-		std::filesystem::path file = path;
-		file /= "o2ma" + std::to_string(item->Id) + ".ojn";
+	DB_MusicItem item = *found;
 
-		if (file.string() != m_currentFilePath || GameAudioSampleCache::SetRate() != 1.0 || GameAudioSampleCache::IsEmpty()) {
-			try {
-				O2::OJN o2jamFile;
-				o2jamFile.Load(file);
+	m_jobs.push_back(JobSystem::GetInstance()->Schedule([this, state, item] {
+		std::lock_guard<std::mutex> lock(*m_mutex);
+		if (m_currentState != state) {
+			return;
+		}
 
-				if (!o2jamFile.IsValid()) {
-					return;
-				}
+		Ready = false;
 
-				if (m_currentChart != nullptr && file.string() != m_currentFilePath) {
-					delete m_currentChart;
-				}
+		/* renders once per chart, later visits only open the cached file */
+		if (!PreviewBuilder::Build(item)) {
+			std::cout << "[BGMPreview] Failed to build the preview!" << std::endl;
+			return;
+		}
 
-				m_currentFilePath = file.string();
-				m_currentChart = new Chart(o2jamFile, 2);
-			}
-			catch (std::exception) {
-				std::cout << "[BGMPreview] Failed to load the audio chart!" << std::endl;
+		auto file = PreviewBuilder::GetPath(item);
+		if (file.string() != m_currentFilePath || !m_audio) {
+			auto audio = std::make_unique<Audio>("Preview");
+			if (!audio->Create(file)) {
 				return;
 			}
 
-			m_autoSamples.clear();
-
-			for (auto& sample : m_currentChart->m_autoSamples) {
-				m_autoSamples.push_back(sample);
-			}
-
-			for (auto& note : m_currentChart->m_notes) {
-				if (note.Keysound != -1) {
-					AutoSample sm = {};
-					sm.StartTime = note.StartTime;
-					sm.Index = note.Keysound;
-					sm.Volume = note.Volume;
-					sm.Pan = note.Pan;
-
-					m_autoSamples.push_back(sm);
-				}
-			}
-
-			std::sort(m_autoSamples.begin(), m_autoSamples.end(), [](const AutoSample& a, const AutoSample& b) {
-				return a.StartTime < b.StartTime;
-			});
-
-			m_length = m_currentChart->GetLength();
-			m_startOffset = m_autoSamples.size() ? m_autoSamples.front().StartTime : 0;
-
-			GameAudioSampleCache::SetRate(1.0);
-			GameAudioSampleCache::Load(m_currentChart, Configuration::Load("Game", "AudioPitch") == "1");
+			m_audio = std::move(audio);
+			m_currentFilePath = file.string();
 		}
 
+		m_audio->SetVolume(static_cast<int>(kPreviewVolume * LoudnessScanner::GetGain(item) + 0.5f));
+
 		if (m_callback && m_currentState == state) {
 			m_callback(true);
 		}
 
 		Ready = true;
-	});
-
-	tr.detach();
+	}, JobPriority::HIGH));
 }
 
 void BGMPreview::Update(double delta) {
 	if (OnPause || !OnStarted || !Ready) return;
 
-	m_currentAudioPosition += (delta * m_rate) * 1000;
-
-	for (int i = m_currentSampleIndex; i < m_autoSamples.size(); i++) {
-		auto& sample = m_autoSamples[i];
-		if (m_currentAudioPosition >= sample.StartTime) {
-			if (sample.StartTime - m_currentAudioPosition < 5) {
-				GameAudioSampleCache::Play(sample.Index, sample.Volume * 50, sample.Pan * 100);
-			}
-			
-			m_currentSampleIndex++;
-		}
-		else {
-			break;
-		}
-	}
-
-	if (m_currentAudioPosition > m_length + 200) {
+	if (!m_audio->IsPlaying()) {
 		Stop();
 	}
 }
 
 void BGMPreview::Play() {
-	m_currentAudioPosition = m_startOffset;
-	m_currentSampleIndex = 0;
-	
+	if (!m_audio) return;
+
+	m_audio->Play();
 	OnStarted = true;
 }
 
 void BGMPreview::Stop() {
-	m_currentState = -1;
+	m_currentState++;
 
 	if (!IsPlaying()) return;
 	OnStarted = false;
 
+	m_audio->Stop();
 	m_callback(false);
-	GameAudioSampleCache::StopAll();
 }
 
 void BGMPreview::Reload() {
 	OnPause = true;
 
-	GameAudioSampleCache::Load(m_currentChart, Configuration::Load("Game", "AudioPitch") == "1", true);
+	if (m_audio && OnStarted) {
+		m_audio->Play();
+	}
 
 	OnPause = false;
 }
@@ -161,4 +132,4 @@ bool BGMPreview::IsReady() {
 
 void BGMPreview::OnReady(std::function<void(bool)> callback) {
 	m_callback = callback;
-}
\ No newline at end of file
+}
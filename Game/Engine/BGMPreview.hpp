@@ -1,10 +1,13 @@
 #pragma once
+#include <atomic>
 #include <functional>
-#include <thread>
-#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../../Engine/Threading/JobSystem.hpp"
 
-class Chart;
-class AutoSample;
+class Audio;
 
 class BGMPreview {
 public:
@@ -21,26 +24,18 @@ public:
 	bool IsReady();
 	void OnReady(std::function<void(bool)> callback);
 private:
-	Chart* m_currentChart = 0;
+	std::unique_ptr<Audio> m_audio;
 	std::string m_currentFilePath = "";
 
-	double m_currentAudioPosition;
-	double m_currentTrackPosition;
-	double m_rate;
-	bool OnPause;
-	bool OnStarted;
-	bool Ready;
+	bool OnPause = false;
+	bool OnStarted = false;
+	bool Ready = false;
 
-	int m_startOffset = 0;
-	int m_currentSampleIndex = 0;
-	int m_bgmIndex;
-	int m_length;
-	int m_currentState = 0;
+	int m_bgmIndex = 0;
+	std::atomic<int> m_currentState = 0;
 
-	std::vector<AutoSample> m_autoSamples;
 	std::function<void(bool)> m_callback;
+	std::vector<JobHandle> m_jobs;
 
-	std::mutex* m_mutex;
-	bool m_threadFinish;
+	std::mutex* m_mutex = nullptr;
 };
-
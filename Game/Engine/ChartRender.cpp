@@ -0,0 +1,148 @@
+#include "ChartRender.hpp"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "../Data/Chart.hpp"
+#include "../Data/MusicDatabase.h"
+#include "../../Engine/AudioSample.hpp"
+#include "../../Engine/Configuration.hpp"
+#include "../../Engine/SoftwareMixer.hpp"
+
+namespace ChartRender {
+	struct RenderEvent {
+		double Time;
+		int Sample;
+		float Volume;
+		float Pan;
+	};
+}
+
+bool ChartRender::Render(const DB_MusicItem& item, int sampleRate, double length, const BlockCallback& output, const CancelCheck& cancelled) {
+	std::filesystem::path file = Configuration::Load("Music", "Folder");
+	file /= "o2ma" + std::to_string(item.Id) + ".ojn";
+
+	std::unique_ptr<Chart> chart;
+	try {
+		O2::OJN o2jamFile;
+		o2jamFile.Load(file);
+
+		if (!o2jamFile.IsValid()) {
+			return false;
+		}
+
+		chart = std::make_unique<Chart>(o2jamFile, 2);
+	}
+	catch (std::exception) {
+		std::cout << "[ChartRender] Failed to load the audio chart: " << file.string() << std::endl;
+		return false;
+	}
+
+	std::vector<RenderEvent> events;
+	for (auto& it : chart->m_autoSamples) {
+		events.push_back({ static_cast<double>(it.StartTime), static_cast<int>(it.Index), it.Volume, it.Pan });
+	}
+
+	for (auto& note : chart->m_notes) {
+		if (note.Keysound != -1) {
+			events.push_back({ static_cast<double>(note.StartTime), static_cast<int>(note.Keysound), note.Volume, note.Pan });
+		}
+	}
+
+	if (events.empty()) {
+		return false;
+	}
+
+	std::stable_sort(events.begin(), events.end(), [](const RenderEvent& a, const RenderEvent& b) {
+		return a.Time < b.Time;
+	});
+
+	/* O2Jam charts carry no preview point and leading silence says nothing about loudness */
+	double start = events.front().Time;
+	double end = length > 0 ? start + length : (std::numeric_limits<double>::max)();
+	uint64_t frames = length > 0 ? static_cast<uint64_t>(length / 1000.0 * sampleRate) : (std::numeric_limits<uint64_t>::max)();
+
+	std::set<int> used;
+	for (auto& it : events) {
+		if (it.Time < end) {
+			used.insert(it.Sample);
+		}
+	}
+
+	SoftwareMixer mixer(sampleRate);
+	std::unordered_map<int, int> buffers;
+
+	for (auto& sample : chart->m_samples) {
+		if (used.find(sample.Index) == used.end()) {
+			continue;
+		}
+
+		if (cancelled && cancelled()) {
+			return false;
+		}
+
+		AudioSample decoder("ChartRender" + std::to_string(sample.Index));
+		bool loaded = sample.Type == 2
+			? decoder.Create(const_cast<uint8_t*>(sample.FileBuffer->data()), sample.FileBuffer->size())
+			: decoder.Create(chart->m_directoryIndex.Resolve(sample.FileName, { ".wav", ".ogg", ".mp3" }));
+
+		std::vector<float> pcm;
+		int channels = 0, frequency = 0;
+		if (loaded && decoder.Decode(pcm, channels, frequency)) {
+			buffers[sample.Index] = mixer.AddBuffer(std::move(pcm), channels, frequency);
+		}
+	}
+
+	std::vector<float> block(kChartRenderBlockFrames * 2);
+	uint64_t frame = 0;
+
+	auto renderTo = [&](uint64_t target) {
+		target = (std::min)(target, frames);
+
+		while (frame < target) {
+			if (cancelled && cancelled()) {
+				return false;
+			}
+
+			int count = static_cast<int>((std::min)(target - frame, static_cast<uint64_t>(kChartRenderBlockFrames)));
+			mixer.Render(block.data(), count);
+			output(block.data(), count);
+			frame += count;
+		}
+
+		return true;
+	};
+
+	for (auto& it : events) {
+		if (it.Time >= end) {
+			break;
+		}
+
+		auto buffer = buffers.find(it.Sample);
+		if (buffer == buffers.end()) {
+			continue;
+		}
+
+		if (!renderTo(static_cast<uint64_t>((it.Time - start) / 1000.0 * sampleRate))) {
+			return false;
+		}
+
+		mixer.Play(buffer->second, it.Volume, it.Pan);
+	}
+
+	if (length > 0) {
+		return renderTo(frames);
+	}
+
+	/* let the last sounds ring out */
+	do {
+		if (!renderTo(frame + sampleRate / 10)) {
+			return false;
+		}
+	} while (mixer.GetActiveVoices() > 0);
+
+	return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <functional>
+
+struct DB_MusicItem;
+
+// Most frames handed to the block callback at once
+constexpr int kChartRenderBlockFrames = 4096;
+
+/*
+ * Offline mix of a library song's HX chart through a SoftwareMixer, shared by
+ * the preview builder and the loudness scanner. Playback starts at the first
+ * sound and the mix is handed out block by block, only the keysounds played
+ * within the rendered range are decoded.
+ */
+namespace ChartRender {
+	/* interleaved stereo, called in order */
+	typedef std::function<void(const float* block, int frames)> BlockCallback;
+
+	/* checked between keysound decodes and blocks, true stops the render */
+	typedef std::function<bool()> CancelCheck;
+
+	/* renders `length` ms, or the whole chart with the last sounds rung out when length <= 0,
+	   false when the chart failed to load, has no sounds or the render was cancelled */
+	bool Render(const DB_MusicItem& item, int sampleRate, double length, const BlockCallback& output, const CancelCheck& cancelled = nullptr);
+}
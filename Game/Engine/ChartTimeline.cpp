@@ -0,0 +1,163 @@
+#include "ChartTimeline.hpp"
+#include <algorithm>
+
+namespace {
+	bool CompareEvent(const TimelineEvent& a, const TimelineEvent& b) {
+		if (a.Due != b.Due) {
+			return a.Due < b.Due;
+		}
+
+		// Same due time: state changes (bpm, sv) first, then in chart order
+		if (a.Type != b.Type) {
+			return a.Type > b.Type;
+		}
+
+		return a.Time < b.Time;
+	}
+}
+
+ChartTimeline::ChartTimeline() {
+	m_cursor = 0;
+}
+
+void ChartTimeline::Add(TimelineEventType type, int index, double time, double position) {
+	TimelineEvent e = {};
+	e.Due = time;
+	e.Time = time;
+	e.Position = position;
+	e.Type = type;
+	e.Index = index;
+
+	m_events.push_back(e);
+}
+
+void ChartTimeline::AddSource(TimelineEventType type, timeline_source next, std::function<void()> rewind) {
+	Source source = {};
+	source.Type = type;
+	source.Next = next;
+	source.Rewind = rewind;
+
+	m_sources.push_back(source);
+}
+
+void ChartTimeline::Subscribe(TimelineEventType type, timeline_callback callback) {
+	m_callbacks[static_cast<int>(type)].push_back(callback);
+}
+
+void ChartTimeline::Schedule(timeline_due_callback due) {
+	m_due = due;
+
+	auto begin = m_events.begin() + m_cursor;
+
+	for (auto it = begin; it != m_events.end(); it++) {
+		it->Due = due(*it);
+	}
+
+	std::stable_sort(begin, m_events.end(), CompareEvent);
+
+	for (auto& source : m_sources) {
+		if (source.HasPending) {
+			source.Pending.Due = due(source.Pending);
+		}
+	}
+}
+
+void ChartTimeline::Advance(double time) {
+	while (true) {
+		const TimelineEvent* next = m_cursor < m_events.size() ? &m_events[m_cursor] : nullptr;
+		Source* from = nullptr;
+
+		for (auto& source : m_sources) {
+			Fill(source);
+
+			if (source.HasPending && (!next || CompareEvent(source.Pending, *next))) {
+				next = &source.Pending;
+				from = &source;
+			}
+		}
+
+		if (!next || next->Due > time) {
+			break;
+		}
+
+		TimelineEvent e = *next;
+		if (from) {
+			from->HasPending = false;
+		}
+		else {
+			m_cursor++;
+		}
+
+		Dispatch(e);
+	}
+}
+
+void ChartTimeline::Seek(double time) {
+	// Dispatched events may have been keyed with older due times, re-key the whole stream
+	m_cursor = 0;
+	if (m_due) {
+		Schedule(m_due);
+	}
+
+	auto it = std::lower_bound(m_events.begin(), m_events.end(), time, [](const TimelineEvent& e, double value) {
+		return e.Due < value;
+	});
+
+	m_cursor = static_cast<size_t>(it - m_events.begin());
+
+	// Sources only go forward, replay them from the start up to `time`
+	for (auto& source : m_sources) {
+		source.Rewind();
+		source.HasPending = false;
+		source.Count = 0;
+
+		for (Fill(source); source.HasPending && source.Pending.Due < time; Fill(source)) {
+			source.HasPending = false;
+		}
+	}
+}
+
+void ChartTimeline::Clear() {
+	m_events.clear();
+	m_sources.clear();
+	m_cursor = 0;
+	m_due = nullptr;
+
+	for (auto& callbacks : m_callbacks) {
+		callbacks.clear();
+	}
+}
+
+void ChartTimeline::Fill(Source& source) {
+	if (source.HasPending) {
+		return;
+	}
+
+	TimelineEvent e = {};
+	e.Type = source.Type;
+	e.Index = source.Count;
+
+	if (!source.Next(e)) {
+		return;
+	}
+
+	e.Due = m_due ? m_due(e) : e.Time;
+
+	source.Pending = e;
+	source.HasPending = true;
+	source.Count++;
+}
+
+void ChartTimeline::Dispatch(const TimelineEvent& e) {
+	for (auto& callback : m_callbacks[static_cast<int>(e.Type)]) {
+		callback(e);
+	}
+}
+
+size_t ChartTimeline::GetCursor() const {
+	return m_cursor;
+}
+
+size_t ChartTimeline::GetSize() const {
+	return m_events.size();
+}
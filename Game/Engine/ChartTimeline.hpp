@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+enum class TimelineEventType : uint8_t {
+	NOTE_SPAWN,
+	KEYSOUND,
+	BPM_CHANGE,
+	SV_CHANGE,
+	MEASURE_LINE
+};
+
+constexpr int kTimelineEventTypes = 5;
+
+struct TimelineEvent {
+	/* when the event is dispatched, chart time minus any lookahead */
+	double Due;
+	/* chart time the event belongs to */
+	double Time;
+	/* track position for visual events, 0 otherwise */
+	double Position;
+
+	TimelineEventType Type;
+	/* index into the consumer's own list (note descs, samples, bpms...) */
+	int Index;
+};
+
+typedef std::function<void(const TimelineEvent&)> timeline_callback;
+typedef std::function<double(const TimelineEvent&)> timeline_due_callback;
+
+/* fills Time and Position of the next event in chart order, false when there are no more */
+typedef std::function<bool(TimelineEvent&)> timeline_source;
+
+/*
+ * Every timed thing of a chart merged into one stream, sorted by when it has
+ * to be dispatched. A single cursor walks it each gameplay step and hands the
+ * events to whoever subscribed to their type. Events that are cheap to derive
+ * but numerous (measure lines) come from sources instead, which are asked for
+ * their next event only once the previous one has been dispatched.
+ */
+class ChartTimeline {
+public:
+	ChartTimeline();
+
+	void Add(TimelineEventType type, int index, double time, double position = 0);
+	void AddSource(TimelineEventType type, timeline_source next, std::function<void()> rewind);
+	void Subscribe(TimelineEventType type, timeline_callback callback);
+
+	// Recomputes due times of everything not dispatched yet and sorts the stream
+	void Schedule(timeline_due_callback due);
+
+	// Dispatches every event due at or before `time`
+	void Advance(double time);
+
+	// Moves the cursor to the first event due at or after `time` without
+	// dispatching, consumers keeping state (bpm, sv) rebuild it themselves
+	void Seek(double time);
+
+	void Clear();
+
+	size_t GetCursor() const;
+	size_t GetSize() const;
+
+private:
+	struct Source {
+		TimelineEventType Type;
+		timeline_source Next;
+		std::function<void()> Rewind;
+
+		bool HasPending;
+		TimelineEvent Pending;
+		int Count;
+	};
+
+	void Fill(Source& source);
+	void Dispatch(const TimelineEvent& e);
+
+	std::vector<TimelineEvent> m_events;
+	std::vector<Source> m_sources;
+	std::vector<timeline_callback> m_callbacks[kTimelineEventTypes];
+	timeline_due_callback m_due;
+	size_t m_cursor;
+};
@@ -3,25 +3,814 @@
 #include <filesystem>
 #include <vector>
 #include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <queue>
+#include <atomic>
+#include <cfloat>
+#include <cstring>
+#include <condition_variable>
+#include <unordered_map>
 #include <mutex>
 
 #include "../Data/Chart.hpp"
 #include "../../Engine/EstEngine.hpp"
+#include "../../Engine/Configuration.hpp"
 #include "../../Engine/BassFXSampleEncoding.hpp"
+#include "../../Engine/Threading/JobSystem.hpp"
+#include "../../Engine/SoftwareMixer.hpp"
+#include "../../Engine/MixerSink.hpp"
+#include "../../Engine/SampleCache.hpp"
+#include "../../Engine/PcmDiskCache.hpp"
 
 struct NoteAudioSample {
 	std::string FilePath;
-	AudioSample* Sample;
+
+	/* shared with the SampleCache, holding it keeps the sample from being evicted */
+	std::shared_ptr<AudioSample> Sample;
+
+	/* compressed storage, Sample is only set while it's in the working set */
+	SampleBuffer Compressed;
+	std::string DiskKey;
+};
+
+struct SampleUse {
+	double Time;
+	int Index;
+};
+
+struct PendingPlay {
+	double Time;
+	int Index;
+	int Volume;
+	int Pan;
+
+	bool operator>(const PendingPlay& other) const {
+		return Time > other.Time;
+	}
+};
+
+// Where a keysound comes from, copied out of the chart so background loads
+// don't depend on the chart staying alive.
+struct SampleSource {
+	uint32_t Type;
+	SampleBuffer Buffer;
+	std::filesystem::path Path;
+	std::filesystem::path FileName;
+	std::string FilePath;
+};
+
+// One distinct keysound to load, every id using the same payload shares it
+struct LoadGroup {
+	SampleSource Source;
+	std::string Key;
+	std::string DiskKey;
+	double FirstUse;
+
+	std::vector<int> Indices;
+};
+
+// Cache/Silence/<chart hash>.sil, bump the version whenever the analysis changes
+constexpr int kSilenceCacheVersion = 1;
+const char kSilenceCacheMagic[4] = { 'S', 'I', 'L', 'C' };
+
+struct SilenceCacheHeader {
+	char Magic[4];
+	int Version;
+	int Count;
+};
+
+struct SilenceCacheEntry {
+	uint64_t Key;
+	uint32_t Onset;
+	uint32_t Tail;
+	uint32_t Length;
+	uint32_t Reserved;
+};
+
+// Sample waiting for its tempo preprocess, either in-memory chart data or a
+// file to read.
+struct TempoSample {
+	const void* Data;
+	size_t Size;
+	std::filesystem::path Source;
+
+	std::tuple<int, int, int, int, void*> Result;
 };
 
 namespace GameAudioSampleCache {
-	std::unordered_map<int, NoteAudioSample> samples;
-	std::unordered_map<int, AudioSampleChannel*> sampleIndex;
+	/* indexed by keysound id, Sample is nullptr for ids the chart doesn't use */
+	std::vector<NoteAudioSample> samples;
 
 	std::string currentHash;
 	double m_rate = 1.0;
 
-	std::mutex m_lock;
+	std::unique_ptr<SoftwareMixer> m_mixer;
+	std::unique_ptr<BassMixerSink> m_mixerSink;
+	std::vector<int> m_mixerBuffers;
+
+	/* chart time m_clockTime plays at output frame m_clockFrame */
+	double m_clockTime = 0;
+	uint64_t m_clockFrame = 0;
+
+	bool m_compressed = false;
+	double m_currentTime = 0;
+	double m_streamThreshold = kDefaultStreamThreshold;
+	bool m_progressive = true;
+	double m_loadAhead = kDefaultLoadAhead;
+	bool m_trimSilence = false;
+
+	/* silence analysis totals of the samples loaded for this chart */
+	std::atomic<int> m_analyzedSamples = 0;
+	std::atomic<uint64_t> m_leadingSilence = 0;
+	std::atomic<uint64_t> m_trimmedBytes = 0;
+
+	/*
+	 * Silence analysis of this chart's samples by key hash, kept in
+	 * Cache/Silence per chart. Samples the PCM disk cache doesn't hold, tempo
+	 * encodes or everything with that cache off, skip the scan on the next load.
+	 */
+	std::mutex m_silenceLock;
+	std::unordered_map<uint64_t, SampleSilence> m_silences;
+	std::string m_silenceChart;
+	bool m_silencesChanged = false;
+
+	/* every keysound use of the chart by time, and per sample */
+	std::vector<SampleUse> m_uses;
+	std::vector<std::vector<double>> m_sampleUses;
+	size_t m_useCursor = 0;
+	double m_nextRelease = 0;
+
+	/* a decode job writes only its own slot, read back once the job is done */
+	std::vector<JobHandle> m_decodeJobs;
+	std::vector<std::shared_ptr<AudioSample>> m_decoded;
+	std::vector<int> m_pendingDecodes;
+	int m_lateKeysounds = 0;
+
+	/*
+	 * Decoded storage loads in order of first use. The loading thread waits for
+	 * the opening groups only, loaders on the job system fill in the rest and
+	 * Update installs whatever finished. A group is written by one loader and
+	 * only read back once its done flag is set. The loading thread sleeps on
+	 * m_openingLoaded until the loader finishing the last opening group wakes it.
+	 */
+	std::vector<LoadGroup> m_loadGroups;
+	std::vector<std::shared_ptr<AudioSample>> m_loadResults;
+	std::unique_ptr<std::atomic<bool>[]> m_loadDone;
+	std::vector<bool> m_loadInstalled;
+	std::vector<JobHandle> m_loaders;
+	std::atomic<size_t> m_loadCursor = 0;
+	std::atomic<int> m_loadersRunning = 0;
+	std::mutex m_openingLock;
+	std::condition_variable m_openingLoaded;
+	size_t m_opening = 0;
+	size_t m_openingLeft = 0;
+	std::atomic<bool> m_loadCancel = false;
+	std::atomic<bool> m_pcmStored = false;
+	std::atomic<bool> m_tempoStored = false;
+	uint64_t m_tempoCapacity = kDefaultTempoCacheCapacity;
+	bool m_loadTempo = false;
+	size_t m_installCursor = 0;
+	size_t m_missedGroup = SIZE_MAX;
+	int m_missedDeadlines = 0;
+
+	/* autoplay samples PrepareScheduled couldn't add yet, decoded for the mixer once loaded */
+	std::vector<bool> m_mixerWanted;
+	std::vector<std::pair<int, JobHandle>> m_mixerJobs;
+	std::vector<int> m_mixerDecoded;
+
+	/* autoplay keysounds waiting for their time when the mixer isn't used */
+	std::priority_queue<PendingPlay, std::vector<PendingPlay>, std::greater<PendingPlay>> m_pendingPlays;
+
+	std::filesystem::path GetTempoCachePath() {
+		return std::filesystem::current_path() / "Cache" / "Tempo";
+	}
+
+	void EncodeTempo(TempoSample& sample) {
+		std::vector<char> buffer;
+		const void* data = sample.Data;
+		size_t size = sample.Size;
+
+		if (data == nullptr) {
+			std::fstream fs(sample.Source, std::ios::binary | std::ios::in);
+			if (!fs.is_open()) {
+				std::cout << "Failed to open file: " << sample.Source.string() << std::endl;
+				return;
+			}
+
+			fs.seekg(0, std::ios::end);
+			buffer.resize(fs.tellg());
+			fs.seekg(0, std::ios::beg);
+			fs.read(buffer.data(), buffer.size());
+
+			data = buffer.data();
+			size = buffer.size();
+		}
+
+		/* a 0 cap disables the tempo cache */
+		if (m_tempoCapacity == 0) {
+			sample.Result = BASS_FX_SampleEncoding::Encode(const_cast<void*>(data), size, static_cast<float>(m_rate));
+			return;
+		}
+
+		sample.Result = BASS_FX_SampleEncoding::EncodeCached(const_cast<void*>(data), size, static_cast<float>(m_rate), GetTempoCachePath());
+		m_tempoStored = true;
+	}
+
+	/* a sample decoded for one rate, or trimmed, can't be reused as another */
+	std::string GetCacheKey(const std::string& identity, bool tempo) {
+		return identity + "@" + std::to_string(static_cast<int>(m_rate * 1000.0 + 0.5)) + (tempo ? "t" : "p") + (m_trimSilence ? "s" : "");
+	}
+
+	/* identifies the decoded PCM on disk, a changed file gets a new entry */
+	std::string GetDiskKey(const std::filesystem::path& path, bool internal) {
+		if (internal) {
+			return path.string();
+		}
+
+		std::error_code ec;
+		auto size = std::filesystem::file_size(path, ec);
+		auto time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+
+		return path.string() + "|" + std::to_string(size) + "|" + std::to_string(time);
+	}
+
+	std::filesystem::path GetSilenceCachePath(const std::string& chart) {
+		return std::filesystem::current_path() / "Cache" / "Silence" / (chart + ".sil");
+	}
+
+	void LoadSilences() {
+		std::lock_guard<std::mutex> lock(m_silenceLock);
+		m_silences.clear();
+		m_silenceChart = currentHash;
+		m_silencesChanged = false;
+
+		std::fstream fs(GetSilenceCachePath(m_silenceChart), std::ios::binary | std::ios::in);
+		if (!fs.is_open()) {
+			return;
+		}
+
+		SilenceCacheHeader header = {};
+		fs.read((char*)&header, sizeof(SilenceCacheHeader));
+		if (!fs || memcmp(header.Magic, kSilenceCacheMagic, 4) != 0 || header.Version != kSilenceCacheVersion || header.Count < 0) {
+			return;
+		}
+
+		for (int i = 0; i < header.Count; i++) {
+			SilenceCacheEntry entry = {};
+			if (!fs.read((char*)&entry, sizeof(SilenceCacheEntry))) {
+				break;
+			}
+
+			SampleSilence silence = {};
+			silence.Onset = entry.Onset;
+			silence.Tail = entry.Tail;
+			silence.Length = entry.Length;
+
+			m_silences[entry.Key] = silence;
+		}
+	}
+
+	void SaveSilences() {
+		std::lock_guard<std::mutex> lock(m_silenceLock);
+		if (!m_silencesChanged || m_silenceChart.empty()) {
+			return;
+		}
+
+		m_silencesChanged = false;
+
+		/* currentHash may already be cleared for a reload, the map belongs to this chart */
+		auto path = GetSilenceCachePath(m_silenceChart);
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+		SilenceCacheHeader header = {};
+		memcpy(header.Magic, kSilenceCacheMagic, 4);
+		header.Version = kSilenceCacheVersion;
+		header.Count = static_cast<int>(m_silences.size());
+
+		std::fstream fs(path, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!fs.is_open()) {
+			return;
+		}
+
+		fs.write((char*)&header, sizeof(SilenceCacheHeader));
+		for (auto& [key, silence] : m_silences) {
+			SilenceCacheEntry entry = { key, silence.Onset, silence.Tail, silence.Length, 0 };
+			fs.write((char*)&entry, sizeof(SilenceCacheEntry));
+		}
+	}
+
+	/* `key` names the exact PCM analyzed, a disk key plus rate for tempo encodes */
+	void AnalyzeSilence(AudioSample* sample, const std::string& key) {
+		uint64_t hash = SampleStore::Hash(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+
+		if (!sample->IsAnalyzed()) {
+			std::lock_guard<std::mutex> lock(m_silenceLock);
+
+			auto it = m_silences.find(hash);
+			if (it != m_silences.end()) {
+				sample->SetSilence(it->second);
+			}
+		}
+
+		if (!sample->IsAnalyzed()) {
+			if (!sample->Analyze()) {
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(m_silenceLock);
+			m_silences[hash] = sample->GetSilence();
+			m_silencesChanged = true;
+		}
+
+		auto& silence = sample->GetSilence();
+		if (!silence.IsSilent()) {
+			m_analyzedSamples++;
+			m_leadingSilence += silence.Onset * 1000ull / (std::max)(static_cast<int>(sample->GetFrequency()), 1);
+		}
+	}
+
+	void TrimSilence(AudioSample* sample) {
+		if (!m_trimSilence) {
+			return;
+		}
+
+		size_t size = sample->GetSize();
+		if (sample->TrimSilence()) {
+			m_trimmedBytes += size - sample->GetSize();
+		}
+	}
+
+	/* chart ms a trimmed sample is held back so it still sounds where it used to */
+	double GetLead(int index) {
+		if (index < 0 || index >= samples.size() || !samples[index].Sample) {
+			return 0;
+		}
+
+		auto& sample = samples[index].Sample;
+		return sample->GetTrimmedLead() / sample->GetRate() * m_rate;
+	}
+
+	SampleBuffer ReadCompressed(const std::filesystem::path& path) {
+		std::fstream fs(path, std::ios::binary | std::ios::in);
+		if (!fs.is_open()) {
+			return nullptr;
+		}
+
+		fs.seekg(0, std::ios::end);
+		std::vector<uint8_t> data(fs.tellg());
+		fs.seekg(0, std::ios::beg);
+		fs.read((char*)data.data(), data.size());
+
+		uint64_t hash = 0;
+		return SampleStore::Intern(std::move(data), hash);
+	}
+
+	std::shared_ptr<AudioSample> DecodeSample(const NoteAudioSample& source) {
+		auto sample = std::make_shared<AudioSample>(source.FilePath);
+
+		if (!PcmDiskCache::Load(source.DiskKey, sample.get())) {
+			if (!sample->Create(const_cast<uint8_t*>(source.Compressed->data()), source.Compressed->size())) {
+				return nullptr;
+			}
+		}
+
+		AnalyzeSilence(sample.get(), source.DiskKey);
+		TrimSilence(sample.get());
+		sample->SetRate(m_rate);
+		return sample;
+	}
+
+	void RequestDecode(int index) {
+		if (index < 0 || index >= samples.size() || !samples[index].Compressed || samples[index].Sample || m_decodeJobs[index]) {
+			return;
+		}
+
+		NoteAudioSample source = samples[index];
+		m_decodeJobs[index] = JobSystem::GetInstance()->Schedule([index, source] {
+			m_decoded[index] = DecodeSample(source);
+		}, JobPriority::HIGH);
+
+		m_pendingDecodes.push_back(index);
+	}
+
+	void InstallDecodes(bool wait) {
+		auto pool = AudioManager::GetInstance()->GetVoicePool();
+
+		for (auto it = m_pendingDecodes.begin(); it != m_pendingDecodes.end();) {
+			int index = *it;
+
+			if (wait) {
+				JobSystem::GetInstance()->Wait(m_decodeJobs[index]);
+			}
+			else if (!JobSystem::GetInstance()->IsDone(m_decodeJobs[index])) {
+				++it;
+				continue;
+			}
+
+			samples[index].Sample = std::move(m_decoded[index]);
+			m_decodeJobs[index].reset();
+			pool->SetSample(index, samples[index].Sample.get());
+
+			it = m_pendingDecodes.erase(it);
+		}
+	}
+
+	/* chart ms a sample sounds for from its use, trimmed lead included */
+	double GetPlayLength(int index) {
+		auto& sample = samples[index].Sample;
+		return GetLead(index) + sample->GetLength() / sample->GetRate() * m_rate;
+	}
+
+	// Drops decoded samples that finished playing a while ago and aren't needed
+	// again within the decode lead, they get decoded again before the next use.
+	void ReleaseUnused(double time) {
+		auto pool = AudioManager::GetInstance()->GetVoicePool();
+
+		for (int i = 0; i < samples.size(); i++) {
+			if (!samples[i].Compressed || !samples[i].Sample) {
+				continue;
+			}
+
+			if (IsSampleNeeded(m_sampleUses[i], time, GetPlayLength(i))) {
+				continue;
+			}
+
+			pool->SetSample(i, nullptr);
+			samples[i].Sample.reset();
+		}
+	}
+
+	void BuildUses(Chart* chart) {
+		m_uses.clear();
+		m_sampleUses.assign(samples.size(), {});
+
+		for (auto& it : chart->m_notes) {
+			if (it.Keysound < samples.size()) {
+				m_uses.push_back({ static_cast<double>(it.StartTime), static_cast<int>(it.Keysound) });
+			}
+		}
+
+		for (auto& it : chart->m_autoSamples) {
+			if (it.Index < samples.size()) {
+				m_uses.push_back({ static_cast<double>(it.StartTime), static_cast<int>(it.Index) });
+			}
+		}
+
+		std::sort(m_uses.begin(), m_uses.end(), [](const SampleUse& a, const SampleUse& b) {
+			return a.Time < b.Time;
+		});
+
+		for (auto& it : m_uses) {
+			m_sampleUses[it.Index].push_back(it.Time);
+		}
+
+		m_useCursor = 0;
+		m_nextRelease = 0;
+		m_decodeJobs.assign(samples.size(), nullptr);
+		m_decoded.assign(samples.size(), nullptr);
+	}
+
+	void LoadConfig() {
+		size_t budget = kDefaultSampleCacheBudget;
+		uint64_t pcmCapacity = kDefaultPcmCacheCapacity;
+
+		auto value = Configuration::Load("Game", "SampleCacheBudget");
+		if (value.size()) {
+			try {
+				budget = static_cast<size_t>((std::max)(std::stoi(value), 0)) * 1024 * 1024;
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::SampleCacheBudget" << std::endl;
+			}
+		}
+
+		value = Configuration::Load("Game", "PcmCacheSize");
+		if (value.size()) {
+			try {
+				pcmCapacity = static_cast<uint64_t>((std::max)(std::stoi(value), 0)) * 1024 * 1024;
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::PcmCacheSize" << std::endl;
+			}
+		}
+
+		m_tempoCapacity = kDefaultTempoCacheCapacity;
+
+		value = Configuration::Load("Game", "TempoCacheSize");
+		if (value.size()) {
+			try {
+				m_tempoCapacity = static_cast<uint64_t>((std::max)(std::stoi(value), 0)) * 1024 * 1024;
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::TempoCacheSize" << std::endl;
+			}
+		}
+
+		m_streamThreshold = kDefaultStreamThreshold;
+
+		value = Configuration::Load("Game", "StreamThreshold");
+		if (value.size()) {
+			try {
+				m_streamThreshold = (std::max)(std::stod(value), 0.0);
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::StreamThreshold" << std::endl;
+			}
+		}
+
+		m_progressive = Configuration::Load("Game", "ProgressiveLoad") != "0";
+		m_trimSilence = Configuration::Load("Game", "TrimKeysounds") == "1";
+		m_loadAhead = kDefaultLoadAhead;
+
+		value = Configuration::Load("Game", "LoadAheadTime");
+		if (value.size()) {
+			try {
+				m_loadAhead = (std::max)(std::stod(value), 0.0) * 1000.0;
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::LoadAheadTime" << std::endl;
+			}
+		}
+
+		SampleCache::GetInstance()->SetBudget(budget);
+		PcmDiskCache::SetCapacity(pcmCapacity);
+	}
+
+	// Long BGM keysounds are streamed instead of decoded. Only files big enough
+	// to possibly run that long get their length probed.
+	std::shared_ptr<AudioSample> CreateStreamSample(const SampleSource& source) {
+		if (m_streamThreshold <= 0) {
+			return nullptr;
+		}
+
+		size_t minimumSize = static_cast<size_t>(m_streamThreshold * kStreamProbeBytesPerSecond);
+		double duration = 0;
+
+		if (source.Type == 2) {
+			if (source.Buffer->size() >= minimumSize) {
+				duration = AudioSample::GetDuration(source.Buffer->data(), source.Buffer->size());
+			}
+		}
+		else {
+			std::error_code ec;
+			if (std::filesystem::file_size(source.Path, ec) >= minimumSize && !ec) {
+				duration = AudioSample::GetDuration(source.Path);
+			}
+		}
+
+		if (duration < m_streamThreshold) {
+			return nullptr;
+		}
+
+		SampleBuffer data = source.Type == 2 ? source.Buffer : ReadCompressed(source.Path);
+		auto sample = std::make_shared<AudioSample>(source.FilePath);
+
+		if (!sample->CreateStream(data)) {
+			return nullptr;
+		}
+
+		sample->SetRate(m_rate);
+		return sample;
+	}
+
+	std::shared_ptr<AudioSample> LoadSample(const LoadGroup& group, bool tempo) {
+		auto& source = group.Source;
+
+		if (!tempo) {
+			auto stream = CreateStreamSample(source);
+			if (stream) {
+				return stream;
+			}
+		}
+
+		auto cache = SampleCache::GetInstance();
+		auto sample = cache->Get(group.Key);
+		if (sample) {
+			return sample;
+		}
+
+		sample = std::make_shared<AudioSample>(group.Key);
+
+		if (tempo) {
+			// Tempo preprocessing is the slow part of a rate change, earlier
+			// results come from the disk cache.
+			TempoSample tempoSample = {};
+			if (source.Type == 2) {
+				tempoSample.Data = source.Buffer->data();
+				tempoSample.Size = source.Buffer->size();
+			}
+			else {
+				tempoSample.Source = source.Path;
+			}
+
+			EncodeTempo(tempoSample);
+
+			auto& data = tempoSample.Result;
+			if (std::get<4>(data) == nullptr) {
+				std::cout << "Failed to preprocess audio tempo for non-pitch sample: " << source.FileName << std::endl;
+				return nullptr;
+			}
+
+			if (!sample->CreateFromData(std::get<0>(data), std::get<1>(data), std::get<2>(data), std::get<3>(data), std::get<4>(data))) {
+				std::cout << "Failed to load sample: " << source.FileName << std::endl;
+				return nullptr;
+			}
+
+			AnalyzeSilence(sample.get(), GetCacheKey(group.DiskKey, true));
+			TrimSilence(sample.get());
+		}
+		else {
+			if (!PcmDiskCache::Load(group.DiskKey, sample.get())) {
+				bool created = source.Type == 2
+					? sample->Create(const_cast<uint8_t*>(source.Buffer->data()), source.Buffer->size())
+					: sample->Create(source.Path);
+
+				if (!created) {
+					std::cout << "Failed to load sample: " << source.FileName << std::endl;
+					return nullptr;
+				}
+
+				/* analyzed before storing so the cache entry keeps the result */
+				AnalyzeSilence(sample.get(), group.DiskKey);
+
+				if (PcmDiskCache::IsEnabled()) {
+					PcmDiskCache::Store(group.DiskKey, sample.get());
+					m_pcmStored = true;
+				}
+			}
+			else {
+				AnalyzeSilence(sample.get(), group.DiskKey);
+			}
+
+			TrimSilence(sample.get());
+			sample->SetRate(m_rate);
+		}
+
+		cache->Insert(group.Key, sample);
+		return sample;
+	}
+
+	/* takes groups in first use order until `limit` or the end */
+	void RunLoader(size_t limit) {
+		while (!m_loadCancel) {
+			size_t index = m_loadCursor.load();
+			if (index >= limit) {
+				break;
+			}
+
+			if (!m_loadCursor.compare_exchange_weak(index, index + 1)) {
+				continue;
+			}
+
+			m_loadResults[index] = LoadSample(m_loadGroups[index], m_loadTempo);
+			m_loadDone[index] = true;
+
+			if (index < m_opening) {
+				std::lock_guard<std::mutex> lock(m_openingLock);
+				if (--m_openingLeft == 0) {
+					m_openingLoaded.notify_all();
+				}
+			}
+		}
+	}
+
+	void InstallLoads() {
+		auto pool = AudioManager::GetInstance()->GetVoicePool();
+		size_t started = (std::min)(m_loadCursor.load(), m_loadGroups.size());
+
+		for (size_t i = m_installCursor; i < started; i++) {
+			if (m_loadInstalled[i] || !m_loadDone[i]) {
+				continue;
+			}
+
+			for (int index : m_loadGroups[i].Indices) {
+				samples[index].Sample = m_loadResults[i];
+				pool->SetSample(index, samples[index].Sample.get());
+
+				bool wanted = index < m_mixerWanted.size() && m_mixerWanted[index];
+				if (m_mixer && wanted && samples[index].Sample && !samples[index].Sample->IsStream()) {
+					auto sample = samples[index].Sample;
+					int* buffer = &m_mixerDecoded[index];
+
+					m_mixerJobs.push_back({ index, JobSystem::GetInstance()->Schedule([sample, buffer] {
+						std::vector<float> pcm;
+						int channels = 0, frequency = 0;
+						if (sample->Decode(pcm, channels, frequency)) {
+							*buffer = m_mixer->AddBuffer(std::move(pcm), channels, frequency);
+						}
+					}, JobPriority::HIGH) });
+				}
+			}
+
+			m_loadResults[i].reset();
+			m_loadInstalled[i] = true;
+		}
+
+		while (m_installCursor < m_loadGroups.size() && m_loadInstalled[m_installCursor]) {
+			m_installCursor++;
+		}
+
+		for (auto it = m_mixerJobs.begin(); it != m_mixerJobs.end();) {
+			if (!JobSystem::GetInstance()->IsDone(it->second)) {
+				++it;
+				continue;
+			}
+
+			m_mixerBuffers[it->first] = m_mixerDecoded[it->first];
+			it = m_mixerJobs.erase(it);
+		}
+	}
+
+	/* background loads go in first use order, only the earliest pending one can be late */
+	void WatchDeadline(double time) {
+		if (m_installCursor >= m_loadGroups.size() || m_installCursor == m_missedGroup) {
+			return;
+		}
+
+		auto& group = m_loadGroups[m_installCursor];
+		if (group.FirstUse > time + kLoadDeadlineMargin) {
+			return;
+		}
+
+		m_missedGroup = m_installCursor;
+		m_missedDeadlines++;
+
+		std::cout << "Keysound " << group.Source.FileName << " is still loading " << (group.FirstUse - time) << " ms before its first use" << std::endl;
+	}
+
+	void StopLoaders() {
+		m_loadCancel = true;
+
+		for (auto& job : m_loaders) {
+			JobSystem::GetInstance()->Wait(job);
+		}
+
+		for (auto& [index, job] : m_mixerJobs) {
+			JobSystem::GetInstance()->Wait(job);
+		}
+
+		m_loaders.clear();
+		m_mixerJobs.clear();
+		m_loadGroups.clear();
+		m_loadResults.clear();
+		m_loadDone.reset();
+		m_loadInstalled.clear();
+		m_mixerWanted.clear();
+		m_mixerDecoded.clear();
+		m_loadCursor = 0;
+		m_opening = 0;
+		m_openingLeft = 0;
+		m_installCursor = 0;
+		m_missedGroup = SIZE_MAX;
+		m_missedDeadlines = 0;
+		m_loadCancel = false;
+	}
+
+	/* plays right away, Play and Schedule add the trim compensation first */
+	void PlayVoice(int index, int volume, int pan) {
+		if (index < 0 || index >= samples.size()) {
+			return;
+		}
+
+		if (samples[index].Sample == nullptr) {
+			/* decode didn't make it in time */
+			if (samples[index].Compressed) {
+				m_lateKeysounds++;
+			}
+
+			return;
+		}
+
+		AudioManager::GetInstance()->GetVoicePool()->Play(index, volume, pan);
+	}
+
+	void AllocateVoices() {
+		int voiceCount = kDefaultVoiceCount;
+		VoiceStealing stealing = VoiceStealing::OLDEST;
+
+		auto value = Configuration::Load("Game", "KeysoundVoices");
+		if (value.size()) {
+			try {
+				voiceCount = std::clamp(std::stoi(value), 1, 1024);
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::KeysoundVoices" << std::endl;
+			}
+		}
+
+		if (Configuration::Load("Game", "KeysoundStealing") == "quietest") {
+			stealing = VoiceStealing::QUIETEST;
+		}
+
+		std::vector<AudioSample*> voiceSamples(samples.size(), nullptr);
+		for (int i = 0; i < samples.size(); i++) {
+			voiceSamples[i] = samples[i].Sample.get();
+		}
+
+		AudioManager::GetInstance()->GetVoicePool()->Allocate(voiceSamples, voiceCount, stealing);
+	}
 }
 
 int LastIndexOf(std::string& str, char c) {
@@ -45,186 +834,313 @@ bool GameAudioSampleCache::IsEmpty() {
 }
 
 void GameAudioSampleCache::Load(Chart* chart, bool pitch) {
-	auto audioManager = AudioManager::GetInstance();
 	if (currentHash == chart->MD5Hash) {
 		return;
 	}
 
 	Dispose();
 	currentHash = chart->MD5Hash;
+	LoadConfig();
+	LoadSilences();
+
+	bool tempo = !pitch && m_rate != 1.0f;
+
+	/* tempo preprocessing needs the whole sample decoded anyway */
+	m_compressed = Configuration::Load("Game", "KeysoundStorage") == "compressed";
+	if (m_compressed && tempo) {
+		std::cout << "Compressed keysound storage doesn't support rate changes without pitch, decoding up front" << std::endl;
+		m_compressed = false;
+	}
 
 	std::vector<std::string> ext = { ".wav", ".ogg", ".mp3" };
 
+	int sampleCount = 0;
+	for (auto& it : chart->m_samples) {
+		sampleCount = (std::max)(sampleCount, static_cast<int>(it.Index) + 1);
+	}
+
+	samples.assign(sampleCount, NoteAudioSample{ "", nullptr });
+	BuildUses(chart);
+
+	/* cache key to load group, ids with the same payload share one load */
+	std::unordered_map<std::string, size_t> groups;
+
 	for (auto& it : chart->m_samples) {
 		NoteAudioSample sample = {};
+		SampleSource source = {};
+		source.Type = it.Type;
+		source.FileName = it.FileName;
 
 		if (it.Type == 2) {
+			/* identical payloads share one decoded sample, across charts too */
+			std::stringstream ss;
+			ss << "Internal/" << std::hex << it.ContentHash << "-" << std::dec << it.FileBuffer->size();
+
 			sample.FilePath = "Internal" + std::to_string(it.Index);
-			
-			if (audioManager->GetSample(sample.FilePath) == nullptr) {
-				if (!pitch && m_rate != 1.0f) {
-					auto data = BASS_FX_SampleEncoding::Encode(it.FileBuffer.data(), it.FileBuffer.size(), m_rate);
-					if (std::get<0>(data) == 0) {
-						std::cout << "Failed to preprocess audio tempo for non-pitch sample: " << it.FileName << std::endl;
-						continue;
-					}
-
-					if (!audioManager->CreateSampleFromData(
-						sample.FilePath, 
-						std::get<0>(data), 
-						std::get<1>(data), 
-						std::get<2>(data),
-						std::get<3>(data), 
-						std::get<4>(data),
-						&sample.Sample)) {
-						
-						std::cout << "Failed to load sample: " << it.FileName << std::endl;
-						continue;
-					}
-				}
-				else {
-					if (!audioManager->CreateSample(sample.FilePath, it.FileBuffer.data(), it.FileBuffer.size(), &sample.Sample)) {
-						std::cout << "Failed to load sample: " << it.FileName << std::endl;
-						continue;
-					}
+			source.Buffer = it.FileBuffer;
+			source.Path = ss.str();
+		}
+		else {
+			source.Path = chart->m_directoryIndex.Resolve(it.FileName, ext);
 
-					sample.Sample->SetRate(m_rate);
-				}
+			if (source.Path.empty()) {
+				sample.FilePath = it.FileName.string();
+				::printf("Cannot find audio: %s, at index: %d, Creating a silent audio\n", sample.FilePath.c_str(), it.Index);
 
-				//::printf("Loading audio: %s, at index: %d\n", path.c_str(), it.Index);
+				sample.Sample = std::make_shared<AudioSample>(sample.FilePath);
+				sample.Sample->CreateSilent();
 				samples[it.Index] = sample;
+				continue;
 			}
+
+			sample.FilePath = source.Path.string();
 		}
-		else {
-			auto File = it.FileName;
-			std::filesystem::path path;
-
-			bool found = false;
-			for (auto& fileExt : ext) {
-				auto tmpPath = File.replace_extension(fileExt);
-				if (std::filesystem::exists(tmpPath)) {
-					path = tmpPath;
-					found = true;
-					break;
-				}
+
+		source.FilePath = sample.FilePath;
+		std::string diskKey = GetDiskKey(source.Path, it.Type == 2);
+
+		if (m_compressed) {
+			sample.Sample = CreateStreamSample(source);
+			if (sample.Sample) {
+				samples[it.Index] = sample;
+				continue;
 			}
 
-			if (!found) {
-				found = std::filesystem::exists(it.FileName);
+			sample.Compressed = it.Type == 2 ? it.FileBuffer : ReadCompressed(source.Path);
+			sample.DiskKey = diskKey;
 
-				if (found) {
-					path = it.FileName;
-				}
+			if (!sample.Compressed) {
+				std::cout << "Failed to load sample: " << it.FileName << std::endl;
+				continue;
 			}
 
-			if (found) {
-				sample.FilePath = path.string();
+			samples[it.Index] = sample;
+			continue;
+		}
+
+		samples[it.Index] = sample;
 
-				if (!pitch && m_rate != 1.0f) {
-					std::fstream fs(path, std::ios::binary | std::ios::in);
-					if (!fs.is_open()) {
-						std::cout << "Failed to open file: " << path.string() << std::endl;
-						continue;
-					}
+		auto& uses = m_sampleUses[it.Index];
+		double firstUse = uses.size() ? uses.front() : DBL_MAX;
 
-					fs.seekg(0, std::ios::end);
-					size_t size = fs.tellg();
-					fs.seekg(0, std::ios::beg);
+		std::string key = GetCacheKey(source.Path.string(), tempo);
+		auto group = groups.find(key);
+		if (group != groups.end()) {
+			auto& shared = m_loadGroups[group->second];
+			shared.Indices.push_back(it.Index);
+			shared.FirstUse = (std::min)(shared.FirstUse, firstUse);
+			continue;
+		}
+
+		groups[key] = m_loadGroups.size();
+		m_loadGroups.push_back({ source, key, diskKey, firstUse, { static_cast<int>(it.Index) } });
+	}
+
+	AllocateVoices();
+
+	if (m_compressed) {
+		/* the opening keysounds are decoded before play starts */
+		if (m_uses.size()) {
+			Update(m_uses.front().Time);
+			InstallDecodes(true);
+		}
 
-					char* buffer = new char[size];
-					fs.read(buffer, size);
-					fs.close();
+		return;
+	}
+
+	std::stable_sort(m_loadGroups.begin(), m_loadGroups.end(), [](const LoadGroup& a, const LoadGroup& b) {
+		return a.FirstUse < b.FirstUse;
+	});
 
-					auto data = BASS_FX_SampleEncoding::Encode(buffer, size, m_rate);
-					delete[] buffer;
+	size_t groupCount = m_loadGroups.size();
+	m_loadTempo = tempo;
+	m_loadResults.assign(groupCount, nullptr);
+	m_loadDone = std::make_unique<std::atomic<bool>[]>(groupCount);
+	m_loadInstalled.assign(groupCount, false);
+
+	// Only what plays in the first seconds has to be in before play starts,
+	// with progressive loading off everything is.
+	size_t opening = groupCount;
+	if (m_progressive && m_uses.size()) {
+		double deadline = m_uses.front().Time + m_loadAhead;
+
+		opening = 0;
+		while (opening < groupCount && m_loadGroups[opening].FirstUse <= deadline) {
+			opening++;
+		}
+	}
 
-					if (std::get<0>(data) == 0) {
-						std::cout << "Failed to preprocess audio tempo for non-pitch sample: " << it.FileName << std::endl;
-						continue;
-					}
+	m_opening = opening;
+	m_openingLeft = opening;
 
-					if (!audioManager->CreateSampleFromData(
-						sample.FilePath + std::to_string(it.Index),
-						std::get<0>(data),
-						std::get<1>(data),
-						std::get<2>(data),
-						std::get<3>(data),
-						std::get<4>(data),
-						&sample.Sample)) {
+	/* one worker stays free for everything else queued meanwhile */
+	int workers = (std::max)(JobSystem::GetInstance()->GetWorkerCount() - 1, 1);
+	m_loadersRunning = workers;
 
-						std::cout << "Failed to load sample: " << it.FileName << std::endl;
-						continue;
-					}
+	for (int i = 0; i < workers; i++) {
+		m_loaders.push_back(JobSystem::GetInstance()->Schedule([groupCount] {
+			RunLoader(groupCount);
 
-					samples[it.Index] = sample;
+			/* the last loader out enforces the disk cache caps */
+			if (--m_loadersRunning == 0) {
+				if (m_pcmStored.exchange(false)) {
+					PcmDiskCache::Trim();
 				}
-				else {
-					if (audioManager->GetSample(path.string() + std::to_string(it.Index)) == nullptr) {
-						if (!audioManager->CreateSample(path.string() + std::to_string(it.Index), path, &sample.Sample)) {
-							std::cout << "Failed to load sample: " << it.FileName << std::endl;
-							continue;
-						}
 
-						sample.Sample->SetRate(m_rate);
-						samples[it.Index] = sample;
-					}
+				if (m_tempoStored.exchange(false)) {
+					BASS_FX_SampleEncoding::TrimCache(GetTempoCachePath(), m_tempoCapacity);
 				}
 			}
-			else {
-				sample.FilePath = path.string();
-				::printf("Cannot find audio: %s, at index: %d, Creating a silent audio\n", path.string().c_str(), it.Index);
+		}));
+	}
 
-				if (audioManager->GetSample(path.string() + std::to_string(it.Index)) == nullptr) {
-					if (!audioManager->CreateSample(path.string() + std::to_string(it.Index), "", &sample.Sample)) {
-						std::cout << "Failed to load sample: " << it.FileName << std::endl;
-						continue;
-					}
+	RunLoader(opening);
 
-					samples[it.Index] = sample;
-				}
-			}
+	/* the rest of the opening is on other workers, sleep instead of holding this one */
+	{
+		std::unique_lock<std::mutex> lock(m_openingLock);
+		m_openingLoaded.wait(lock, [] {
+			return m_openingLeft == 0;
+		});
+	}
+
+	InstallLoads();
+
+	if (opening < groupCount) {
+		std::cout << "Loaded " << opening << "/" << groupCount << " keysounds, the rest load in the background" << std::endl;
+	}
+}
+
+void GameAudioSampleCache::Update(double time) {
+	m_currentTime = time;
+
+	while (m_pendingPlays.size() && m_pendingPlays.top().Time <= time) {
+		auto& play = m_pendingPlays.top();
+		PlayVoice(play.Index, play.Volume, play.Pan);
+
+		m_pendingPlays.pop();
+	}
+
+	if (!m_compressed) {
+		if (m_installCursor < m_loadGroups.size() || m_mixerJobs.size()) {
+			InstallLoads();
+			WatchDeadline(time);
 		}
+
+		return;
+	}
+
+	InstallDecodes(false);
+
+	while (m_useCursor < m_uses.size() && m_uses[m_useCursor].Time - kKeysoundDecodeLead <= time) {
+		RequestDecode(m_uses[m_useCursor].Index);
+		m_useCursor++;
+	}
+
+	if (time >= m_nextRelease) {
+		ReleaseUnused(time);
+		m_nextRelease = time + kKeysoundReleaseInterval;
 	}
 }
 
 void GameAudioSampleCache::Play(int index, int volume, int pan) {
-	if (index == -1) {
+	double lead = GetLead(index);
+	if (lead > 0) {
+		m_pendingPlays.push({ m_currentTime + lead, index, volume, pan });
 		return;
 	}
 
-	if (samples.find(index) == samples.end()) {
+	PlayVoice(index, volume, pan);
+}
+
+void GameAudioSampleCache::Stop(int index) {
+	AudioManager::GetInstance()->GetVoicePool()->Stop(index);
+}
+
+void GameAudioSampleCache::PrepareScheduled(const std::vector<int>& indices) {
+	for (auto& [index, job] : m_mixerJobs) {
+		JobSystem::GetInstance()->Wait(job);
+	}
+
+	m_mixerJobs.clear();
+	m_mixerSink.reset();
+
+	/* the mixer keeps float PCM of every scheduled sample, too much for this mode */
+	if (m_compressed) {
+		m_mixer.reset();
+		m_mixerBuffers.clear();
 		return;
 	}
 
-	Stop(index);
-	
-	auto channel = samples[index].Sample->CreateChannel().release();
-	
-	sampleIndex[index] = channel;
-	channel->SetVolume(volume);
-	channel->SetPan(pan);
+	m_mixer = std::make_unique<SoftwareMixer>();
+	m_mixerBuffers.assign(samples.size(), -1);
+	m_mixerWanted.assign(samples.size(), false);
+	m_mixerDecoded.assign(samples.size(), -1);
+
+	for (int index : indices) {
+		if (index < 0 || index >= samples.size() || m_mixerBuffers[index] != -1) {
+			continue;
+		}
+
+		/* still loading in the background, added when it's installed */
+		if (samples[index].Sample == nullptr) {
+			m_mixerWanted[index] = true;
+			continue;
+		}
+
+		/* streamed BGM stays out of the mixer, decoding it here would defeat the point */
+		if (samples[index].Sample->IsStream()) {
+			continue;
+		}
+
+		std::vector<float> pcm;
+		int channels = 0, frequency = 0;
+		if (samples[index].Sample->Decode(pcm, channels, frequency)) {
+			m_mixerBuffers[index] = m_mixer->AddBuffer(std::move(pcm), channels, frequency);
+		}
+	}
+
+	m_mixerSink = std::make_unique<BassMixerSink>();
+	if (!m_mixerSink->Start(m_mixer.get())) {
+		std::cout << "Failed to start the keysound mixer, autoplay keysounds fall back to the voice pool" << std::endl;
 
-	bool result = channel->Play();
-	if (!result) {
-		::printf("Failed to play index %d\n", index);
+		m_mixerSink.reset();
+		m_mixerBuffers.assign(samples.size(), -1);
+		m_mixerWanted.assign(samples.size(), false);
 	}
 }
 
-void GameAudioSampleCache::Stop(int index) {
-	std::lock_guard<std::mutex> lock(m_lock);
+void GameAudioSampleCache::StartClock(double time) {
+	m_currentTime = time;
 
-	if (sampleIndex.find(index) != sampleIndex.end()) {
-		auto& it = sampleIndex[index];
+	if (!m_mixer) {
+		return;
+	}
+
+	m_clockTime = time;
+	m_clockFrame = m_mixer->GetRenderedFrames();
+}
+
+void GameAudioSampleCache::Schedule(int index, double time, int volume, int pan) {
+	time += GetLead(index);
 
-		if (it->IsPlaying()) {
-			it->Stop();
+	if (!m_mixerSink || index < 0 || index >= m_mixerBuffers.size() || m_mixerBuffers[index] == -1) {
+		/* handed over ahead of time, hold it until it's due */
+		if (time > m_currentTime) {
+			m_pendingPlays.push({ time, index, volume, pan });
+		}
+		else {
+			PlayVoice(index, volume, pan);
 		}
 
-		delete it;
-		it = nullptr;
-		
-		sampleIndex.erase(index);
+		return;
 	}
+
+	/* chart time runs m_rate times faster than the output */
+	double frames = (time - m_clockTime) / m_rate / 1000.0 * m_mixer->GetSampleRate();
+	uint64_t frame = frames > 0 ? m_clockFrame + static_cast<uint64_t>(frames + 0.5) : 0;
+
+	m_mixer->PlayAt(frame, m_mixerBuffers[index], volume / 100.0f, pan / 100.0f, samples[index].Sample->GetRate());
 }
 
 void GameAudioSampleCache::SetRate(double rate) {
@@ -240,48 +1156,77 @@ double GameAudioSampleCache::SetRate() {
 }
 
 void GameAudioSampleCache::ResumeAll() {
-	std::lock_guard<std::mutex> lock(m_lock);
+	AudioManager::GetInstance()->GetVoicePool()->ResumeAll();
 
-	for (auto& kv : sampleIndex) {
-		kv.second->Play();
+	if (m_mixerSink) {
+		m_mixerSink->Resume();
 	}
 }
 
 void GameAudioSampleCache::PauseAll() {
-	std::lock_guard<std::mutex> lock(m_lock);
+	AudioManager::GetInstance()->GetVoicePool()->PauseAll();
 
-	for (auto& kv : sampleIndex) {
-		if (kv.second->IsPlaying()) {
-			kv.second->Pause();
-		}
-		else {
-			sampleIndex.erase(kv.first);
-		}
+	/* the mixer clock stops with the stream, scheduled sounds keep their place */
+	if (m_mixerSink) {
+		m_mixerSink->Pause();
 	}
 }
 
 void GameAudioSampleCache::StopAll() {
-	std::lock_guard<std::mutex> lock(m_lock);
-
-	for (auto& kv : sampleIndex) {
-		if (kv.second != nullptr) {
-			if (kv.second->IsPlaying()) {
-				kv.second->Stop();
-			}
+	AudioManager::GetInstance()->GetVoicePool()->StopAll();
+	m_pendingPlays = {};
 
-			delete kv.second;
-			kv.second = nullptr;
-		}
+	if (m_mixer) {
+		m_mixer->StopAll();
 	}
-
-	sampleIndex.clear();
 }
 
 void GameAudioSampleCache::Dispose() {
+	StopLoaders();
 	StopAll();
 
-	samples.clear();
-	AudioManager::GetInstance()->RemoveAll();
+	m_mixerSink.reset();
+	m_mixer.reset();
+	m_mixerBuffers.clear();
+
+	/* decode jobs write into m_decoded, let them finish first */
+	InstallDecodes(true);
+	SaveSilences();
+
+	if (m_compressed && m_lateKeysounds > 0) {
+		std::cout << "Compressed keysounds: " << m_lateKeysounds << " keysounds were not decoded in time" << std::endl;
+	}
+
+	m_uses.clear();
+	m_sampleUses.clear();
+	m_decodeJobs.clear();
+	m_decoded.clear();
+	m_lateKeysounds = 0;
+	m_compressed = false;
+
+	if (m_analyzedSamples > 0) {
+		std::cout << "Keysound silence: " << m_analyzedSamples << " samples analyzed, " << m_leadingSilence / m_analyzedSamples
+			<< " ms average lead, " << m_trimmedBytes / 1024 << " KB trimmed" << std::endl;
+	}
+
+	m_analyzedSamples = 0;
+	m_leadingSilence = 0;
+	m_trimmedBytes = 0;
+
+	/* the pool holds raw pointers into the samples released below */
+	AudioManager::GetInstance()->GetVoicePool()->Clear();
+
+	if (samples.size()) {
+		samples.clear();
+
+		/* what was kept over budget for the last chart can go now */
+		auto cache = SampleCache::GetInstance();
+		cache->Trim();
+
+		auto stats = cache->GetStats();
+		std::cout << "Keysound cache: " << stats.Count << " samples, " << stats.Bytes / (1024 * 1024) << "/" << stats.Budget / (1024 * 1024)
+			<< " MB, " << stats.Hits << " hits, " << stats.Misses << " misses, " << stats.Evictions << " evictions" << std::endl;
+	}
 
 	currentHash = "";
 }
@@ -1,13 +1,52 @@
 #pragma once
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+// How early autoplay keysounds are handed to the audio side, in ms
+constexpr double kAutoSampleLookahead = 100.0;
+
+// Compressed keysound storage: how far ahead of a use a sample is decoded, how
+// long it stays after its last use and how often unused ones are released, in ms
+constexpr double kKeysoundDecodeLead = 3000.0;
+constexpr double kKeysoundReleaseDelay = 5000.0;
+constexpr double kKeysoundReleaseInterval = 1000.0;
+
+// Keysounds at least this long (s) are streamed, and the lowest bitrate
+// (bytes/s) assumed when deciding whether a file is worth probing
+constexpr double kDefaultStreamThreshold = 20.0;
+constexpr double kStreamProbeBytesPerSecond = 4000.0;
+
+// Progressive loading: keysounds first used within this many ms of the chart's
+// first sound are loaded before play starts, and a background load still
+// running this close (ms) to its first use is reported
+constexpr double kDefaultLoadAhead = 10000.0;
+constexpr double kLoadDeadlineMargin = 500.0;
+
 class Chart;
 class AudioSampleChannel;
 
 namespace GameAudioSampleCache {
+	/*
+	 * Whether a decoded compressed keysound has to stay at chart ms `time`. It's
+	 * kept while a use (sorted chart ms) may still be sounding, `length` ms of
+	 * playback plus kKeysoundReleaseDelay, and when one is due within twice the
+	 * decode lead. Releasing it stops every voice playing it.
+	 */
+	inline bool IsSampleNeeded(const std::vector<double>& uses, double time, double length) {
+		auto next = std::upper_bound(uses.begin(), uses.end(), time);
+
+		bool usedRecently = next != uses.begin() && *std::prev(next) + length > time - kKeysoundReleaseDelay;
+		bool usedSoon = next != uses.end() && *next <= time + kKeysoundDecodeLead * 2;
+		return usedRecently || usedSoon;
+	}
+
 	void Load(Chart* chart, bool pitch);
 	void Load(Chart* chart, bool pitch, bool force);
 
 	bool IsEmpty();
 
+	/* a sample with trimmed silence is held back by the trimmed lead */
 	void Play(int index, int volume = 100, int pan = 0);
 	void Stop(int index);
 	void SetRate(double rate);
@@ -15,6 +54,23 @@ namespace GameAudioSampleCache {
 	void ResumeAll();
 	void PauseAll();
 	void StopAll();
+
+	/*
+	 * Autoplay keysounds are mixed in software and started on the audio clock
+	 * instead of whenever the game loop gets to them. PrepareScheduled decodes
+	 * the keysounds that will be scheduled, StartClock pins a chart time to the
+	 * current output frame and Schedule queues a keysound at its chart time.
+	 */
+	void PrepareScheduled(const std::vector<int>& indices);
+	void StartClock(double time);
+	void Schedule(int index, double time, int volume = 100, int pan = 0);
+
+	/*
+	 * Called every gameplay step with the chart time. Plays held back keysounds
+	 * and, with Game.ini KeysoundStorage = compressed, keeps only the samples
+	 * used around `time` decoded while the rest stay as OGG/WAV data.
+	 */
+	void Update(double time);
 	
 	void Dispose();
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include "../Resources/GameResources.hpp"
+#include "ScoreManager.hpp"
+
+enum class NoteType : uint8_t;
+
+enum class GameState {
+	PreParing,
+	NotGame,
+	PreGame,
+	Playing,
+	PosGame
+};
+
+struct NoteSnapshot {
+	int Id;
+	int LaneOffset;
+	NoteType Type;
+	NoteImageType ImageType;
+	NoteImageType ImageBodyType;
+
+	double InitialTrackPosition;
+	double EndTrackPosition;
+
+	/* long note head is being held with GOOD or better */
+	bool Highlight;
+};
+
+struct LaneSnapshot {
+	bool Pressed = false;
+	bool DrawHold = false;
+
+	/* bumped every time the hit/hold effect should restart */
+	uint32_t HitEffect = 0;
+	uint32_t HoldEffect = 0;
+};
+
+/*
+ * Everything the renderer needs from one gameplay step. Written only by the
+ * gameplay thread and handed over through a TripleBuffer, so the renderer
+ * never touches notes or tracks directly.
+ */
+struct GameSnapshot {
+	uint64_t Tick = 0;
+	double Timestamp = 0;
+	double StepTime = 0;
+
+	GameState State = GameState::NotGame;
+	double AudioPosition = 0;
+	double TrackPosition = 0;
+	double PreviousTrackPosition = 0;
+	double NoteSpeed = 0;
+	int PlayTime = 0;
+
+	std::tuple<int, int, int, int, int, int, int, int, int, int, int> Score;
+	int Pills = 0;
+	int Life = 0;
+	int JamGauge = 0;
+	ScoreEvents Events;
+
+	LaneSnapshot Lanes[7];
+	std::vector<NoteSnapshot> Notes;
+	std::vector<double> TimingLines;
+};
@@ -10,36 +10,46 @@ GameTrack::GameTrack(RhythmEngine* engine, int laneIndex, int offset) {
 	m_laneOffset = offset;
 	m_deleteDelay = 0;
 	m_keySound = -1;
-}
+	m_currentHold = -1;
 
-GameTrack::~GameTrack() {
-	for (auto& note : m_notes) {
-		note.reset();
+	m_notePool.reserve(kLaneNotePoolSize);
+	m_freeSlots.reserve(kLaneNotePoolSize);
+	for (int i = 0; i < kLaneNotePoolSize; i++) {
+		m_notePool.push_back(std::make_unique<Note>(m_engine, this));
+		m_freeSlots.push_back(kLaneNotePoolSize - 1 - i);
 	}
 
-	for (auto& note : m_noteCaches) {
-		note.reset();
-	}
-
-	for (auto& note : m_inactive_notes) {
-		note.reset();
-	}
+	m_slotSerial.resize(kLaneNotePoolSize, 0);
+	m_noteRing.resize(kLaneNotePoolSize, -1);
+	m_ringHead = 0;
+	m_ringCount = 0;
+	m_judgeCursor = 0;
+}
 
-	m_inactive_notes.clear();
-	m_currentHold.reset();
-	m_noteCaches.clear();
-	m_notes.clear();
+GameTrack::~GameTrack() {
+	m_currentHold = -1;
+	m_ringCount = 0;
+	m_judgeCursor = 0;
+
+	m_deadlines = {};
+	m_slotSerial.clear();
+	m_noteRing.clear();
+	m_freeSlots.clear();
+	m_notePool.clear();
 }
 
 void GameTrack::Update(double delta) {
-	for (auto _note = m_notes.begin(); _note != m_notes.end();) {
-		auto& note = *_note;
+	size_t mask = m_noteRing.size() - 1;
+	double audioPos = m_engine->GetGameAudioPosition();
 
-		if (note->IsPassed()) {
-			m_inactive_notes.push_back(note);
-			_note = m_notes.erase(_note);
+	for (int i = 0; i < m_ringCount; i++) {
+		Note* note = GetNote(m_noteRing[(m_ringHead + i) & mask]);
+
+		if (note->IsRemoveable()) {
+			continue;
 		}
-		else {
+
+		if (!note->IsPassed()) {
 			if (!note->IsDrawable()) {
 				double startTime = note->GetInitialTrackPosition();
 				double trackPos = m_engine->GetTrackPosition();
@@ -49,40 +59,73 @@ void GameTrack::Update(double delta) {
 				}
 			}
 
-			if (note->GetStartTime() <= m_engine->GetGameAudioPosition()) {
+			if (note->GetStartTime() <= audioPos) {
 				m_keySound = note->GetKeysoundId();
 				m_keyVolume = note->GetKeyVolume();
 				m_keyPan = note->GetKeyPan();
 			}
-
-			note->Update(delta);
-			_note++;
 		}
+
+		note->Update(delta);
 	}
 
-	for (auto _note = m_inactive_notes.begin(); _note != m_inactive_notes.end();) {
-		auto& note = *_note;
+	// Misses, only the notes whose window has closed are touched.
+	while (!m_deadlines.empty() && m_deadlines.top().Time < audioPos) {
+		NoteDeadline deadline = m_deadlines.top();
+		m_deadlines.pop();
+
+		if (m_slotSerial[deadline.Handle] != deadline.Serial) {
+			continue;
+		}
+
+		Note* note = GetNote(deadline.Handle);
+		if (note->IsRemoveable() || note->GetDeadline() != deadline.Time) {
+			continue;
+		}
+
+		note->OnDeadline();
 
+		// The slot itself is recycled once it reaches the front of the ring.
 		if (note->IsRemoveable()) {
 			note->Release();
-
-			m_noteCaches.push_back(note);
-			_note = m_inactive_notes.erase(_note);
 		}
 		else {
-			note->Update(delta);
-			_note++;
+			ScheduleDeadline(deadline.Handle);
 		}
 	}
-}
 
-void GameTrack::Render(double delta) {
-	for (auto& note : m_notes) {
-		note->Render(delta);
+	while (m_ringCount > 0) {
+		int handle = m_noteRing[m_ringHead];
+		if (!GetNote(handle)->IsRemoveable()) {
+			break;
+		}
+
+		if (m_currentHold == handle) {
+			m_currentHold = -1;
+		}
+
+		m_freeSlots.push_back(handle);
+		m_noteRing[m_ringHead] = -1;
+		m_ringHead = (m_ringHead + 1) & mask;
+		m_ringCount--;
+
+		if (m_judgeCursor > 0) {
+			m_judgeCursor--;
+		}
 	}
 
-	for (auto& note : m_inactive_notes) {
-		note->Render(delta);
+	AdvanceJudgeCursor();
+}
+
+void GameTrack::CollectSnapshot(std::vector<NoteSnapshot>& notes) {
+	size_t mask = m_noteRing.size() - 1;
+
+	for (int i = 0; i < m_ringCount; i++) {
+		Note* note = GetNote(m_noteRing[(m_ringHead + i) & mask]);
+
+		if (!note->IsRemoveable() && note->IsDrawable()) {
+			notes.push_back(note->GetSnapshot());
+		}
 	}
 }
 
@@ -96,20 +139,29 @@ void GameTrack::OnKeyUp() {
 		m_callback(e);
 	}
 
-	// create a copy of it, so it wont be NULL if the note is moved to cache
-	for (std::shared_ptr<Note> note : m_notes) {
-		if (note) {
-			auto result = note->CheckRelease();
-			if (std::get<bool>(result)) {
-				note->OnRelease(std::get<NoteResult>(result));
+	AdvanceJudgeCursor();
 
-				if (std::get<NoteResult>(result) == NoteResult::MISS) {
-					GameAudioSampleCache::Stop(note->GetKeysoundId());
-				}
+	// Only the cursor note and the one behind it can take the event, the
+	// second one matters when the cursor is a note that was not hit yet.
+	size_t mask = m_noteRing.size() - 1;
+	for (int i = m_judgeCursor; i < m_ringCount && i <= m_judgeCursor + 1; i++) {
+		int handle = m_noteRing[(m_ringHead + i) & mask];
+		Note* note = GetNote(handle);
+		if (note->IsPassed() || note->IsRemoveable()) {
+			continue;
+		}
+
+		auto result = note->CheckRelease();
+		if (std::get<bool>(result)) {
+			note->OnRelease(std::get<NoteResult>(result));
+			ScheduleDeadline(handle);
 
-				m_currentHold = nullptr;
-				break;
+			if (std::get<NoteResult>(result) == NoteResult::MISS) {
+				GameAudioSampleCache::Stop(note->GetKeysoundId());
 			}
+
+			m_currentHold = -1;
+			break;
 		}
 	}
 }
@@ -124,22 +176,31 @@ void GameTrack::OnKeyDown() {
 		m_callback(e);
 	}
 
+	AdvanceJudgeCursor();
+
+	// Same as release, the note behind the cursor is only reachable when
+	// the cursor is a long note that is already being held.
 	bool found = false;
-	// create a copy of it, so it wont be NULL if the note is moved to cache
-	for (std::shared_ptr<Note> note : m_notes) {
-		if (note) {
-			auto result = note->CheckHit();
-			if (std::get<bool>(result)) {
-				note->OnHit(std::get<NoteResult>(result));
-
-				if (note->GetType() == NoteType::HOLD) {
-					m_currentHold = note;
-				}
+	size_t mask = m_noteRing.size() - 1;
+	for (int i = m_judgeCursor; i < m_ringCount && i <= m_judgeCursor + 1; i++) {
+		int handle = m_noteRing[(m_ringHead + i) & mask];
+		Note* note = GetNote(handle);
+		if (note->IsPassed() || note->IsRemoveable()) {
+			continue;
+		}
+
+		auto result = note->CheckHit();
+		if (std::get<bool>(result)) {
+			note->OnHit(std::get<NoteResult>(result));
+			ScheduleDeadline(handle);
 
-				GameAudioSampleCache::Play(note->GetKeysoundId(), note->GetKeyVolume(), note->GetKeyPan());
-				found = true;
-				break;
+			if (note->GetType() == NoteType::HOLD) {
+				m_currentHold = handle;
 			}
+
+			GameAudioSampleCache::Play(note->GetKeysoundId(), note->GetKeyVolume(), note->GetKeyPan());
+			found = true;
+			break;
 		}
 	}
 
@@ -149,6 +210,8 @@ void GameTrack::OnKeyDown() {
 }
 
 void GameTrack::HandleScore(NoteHitInfo info) {
+	info.Lane = m_laneIndex;
+
 	if (!info.Ignore) {
 		if (info.IsRelease) {
 			if (m_callback) {
@@ -182,25 +245,80 @@ void GameTrack::HandleHoldScore(HoldResult res) {
 }
 
 void GameTrack::AddNote(NoteInfoDesc* desc) {
-	std::shared_ptr<Note> note = nullptr;
-	if (m_noteCaches.size() > 0) {
-		note = m_noteCaches.back();
-		m_noteCaches.pop_back();
-	}
-	else {
-		note = std::make_shared<Note>(m_engine, this);
-	}
+	int handle = AcquireSlot();
+	Note* note = GetNote(handle);
 
 	note->Load(desc);
 	note->SetXPosition(m_laneOffset);
+	m_slotSerial[handle]++;
 
 	if (m_keySound == -1) {
 		m_keySound = note->GetKeysoundId();
 	}
 
-	m_notes.push_back(std::move(note));
+	if (m_ringCount == static_cast<int>(m_noteRing.size())) {
+		GrowRing();
+	}
+
+	m_noteRing[(m_ringHead + m_ringCount) & (m_noteRing.size() - 1)] = handle;
+	m_ringCount++;
+
+	ScheduleDeadline(handle);
 }
 
 void GameTrack::ListenEvent(std::function<void(GameTrackEvent)> callback) {
 	m_callback = callback;
 }
+
+Note* GameTrack::GetNote(int handle) {
+	return m_notePool[handle].get();
+}
+
+int GameTrack::AcquireSlot() {
+	if (m_freeSlots.size() > 0) {
+		int handle = m_freeSlots.back();
+		m_freeSlots.pop_back();
+
+		return handle;
+	}
+
+	m_notePool.push_back(std::make_unique<Note>(m_engine, this));
+	m_slotSerial.push_back(0);
+	return static_cast<int>(m_notePool.size() - 1);
+}
+
+void GameTrack::GrowRing() {
+	size_t mask = m_noteRing.size() - 1;
+	std::vector<int> ring(m_noteRing.size() * 2, -1);
+
+	for (int i = 0; i < m_ringCount; i++) {
+		ring[i] = m_noteRing[(m_ringHead + i) & mask];
+	}
+
+	m_noteRing = std::move(ring);
+	m_ringHead = 0;
+}
+
+void GameTrack::AdvanceJudgeCursor() {
+	size_t mask = m_noteRing.size() - 1;
+
+	// Notes never become judgeable again once passed, so the cursor only
+	// moves forward and each note is stepped over once.
+	while (m_judgeCursor < m_ringCount) {
+		Note* note = GetNote(m_noteRing[(m_ringHead + m_judgeCursor) & mask]);
+		if (!note->IsPassed() && !note->IsRemoveable()) {
+			break;
+		}
+
+		m_judgeCursor++;
+	}
+}
+
+void GameTrack::ScheduleDeadline(int handle) {
+	Note* note = GetNote(handle);
+	if (note->IsRemoveable()) {
+		return;
+	}
+
+	m_deadlines.push({ note->GetDeadline(), handle, m_slotSerial[handle] });
+}
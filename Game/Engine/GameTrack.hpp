@@ -2,10 +2,29 @@
 #include "../../Engine/Keys.h"
 #include <iostream>
 #include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
 #include "Note.hpp"
 
 struct NoteHitInfo;
 
+// Initial number of pooled note slots per lane, must be power of two.
+// The pool only grows when a lane has more live notes than this.
+constexpr int kLaneNotePoolSize = 128;
+
+// Pending miss deadline of a pooled note, entries are invalidated lazily
+// when the slot serial or the note's deadline no longer match.
+struct NoteDeadline {
+	double Time;
+	int Handle;
+	uint32_t Serial;
+
+	bool operator>(const NoteDeadline& other) const {
+		return Time > other.Time;
+	}
+};
+
 struct GameTrackEvent {
 	int Lane = -1;
 	
@@ -21,7 +40,7 @@ public:
 	~GameTrack();
 
 	void Update(double delta);
-	void Render(double delta);
+	void CollectSnapshot(std::vector<NoteSnapshot>& notes);
 	void OnKeyUp();
 	void OnKeyDown();
 
@@ -32,9 +51,26 @@ public:
 	void ListenEvent(std::function<void(GameTrackEvent)> callback);
 
 private:
-	std::vector<std::shared_ptr<Note>> m_notes;
-	std::vector<std::shared_ptr<Note>> m_noteCaches;
-	std::vector<std::shared_ptr<Note>> m_inactive_notes;
+	Note* GetNote(int handle);
+	int AcquireSlot();
+	void GrowRing();
+
+	void AdvanceJudgeCursor();
+	void ScheduleDeadline(int handle);
+
+	/* note pool, notes are addressed by slot index (handle) */
+	std::vector<std::unique_ptr<Note>> m_notePool;
+	std::vector<int> m_freeSlots;
+	std::vector<uint32_t> m_slotSerial;
+
+	/* live notes in spawn order, ring of slot handles */
+	std::vector<int> m_noteRing;
+	int m_ringHead;
+	int m_ringCount;
+
+	/* ring offset of the first note that can still be hit or released */
+	int m_judgeCursor;
+	std::priority_queue<NoteDeadline, std::vector<NoteDeadline>, std::greater<NoteDeadline>> m_deadlines;
 
 	RhythmEngine* m_engine;
 	int m_laneOffset;
@@ -46,7 +82,7 @@ private:
 
 	double m_deleteDelay;
 
-	std::shared_ptr<Note> m_currentHold;
+	int m_currentHold;
 	bool m_onHold;
 
 	std::function<void(GameTrackEvent)> m_callback;
@@ -0,0 +1,146 @@
+#include "HitStatistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	double AbsolutePercentile(const std::vector<int>& buckets, int count, double p) {
+		if (count == 0) {
+			return 0;
+		}
+
+		// fold the signed histogram into |offset|
+		int target = static_cast<int>(std::ceil(p * count));
+		int seen = buckets[kHitErrorRange];
+		if (seen >= target) {
+			return 0;
+		}
+
+		for (int i = 1; i <= kHitErrorRange; i++) {
+			seen += buckets[kHitErrorRange - i] + buckets[kHitErrorRange + i];
+
+			if (seen >= target) {
+				return i;
+			}
+		}
+
+		return kHitErrorRange;
+	}
+}
+
+HitStatistics::HitStatistics() {
+	m_samples.reserve(kHitGraphSamples);
+	Reset();
+}
+
+void HitStatistics::Record(int lane, double time, double offset) {
+	if (lane < 0 || lane >= kHitStatisticsLanes) {
+		return;
+	}
+
+	auto& stats = m_lanes[lane];
+	stats.Count++;
+
+	double diff = offset - stats.Mean;
+	stats.Mean += diff / stats.Count;
+	stats.M2 += diff * (offset - stats.Mean);
+
+	if (offset < 0) {
+		stats.Early++;
+	}
+	else if (offset > 0) {
+		stats.Late++;
+	}
+
+	int bucket = static_cast<int>(std::lround(offset)) + kHitErrorRange;
+	if (bucket < 0 || bucket >= kHitErrorBuckets) {
+		stats.Outside++;
+	}
+
+	stats.Buckets[std::clamp(bucket, 0, kHitErrorBuckets - 1)]++;
+
+	if (m_sampleSkip++ % m_sampleStride != 0) {
+		return;
+	}
+
+	if (m_samples.size() == kHitGraphSamples) {
+		// Keep the even ones, they are exactly the hits a doubled stride would have kept
+		for (size_t i = 0; i < kHitGraphSamples / 2; i++) {
+			m_samples[i] = m_samples[i * 2];
+		}
+
+		m_samples.resize(kHitGraphSamples / 2);
+		m_sampleStride *= 2;
+
+		if ((m_sampleSkip - 1) % m_sampleStride != 0) {
+			return;
+		}
+	}
+
+	m_samples.push_back({ time, static_cast<float>(offset), lane });
+}
+
+void HitStatistics::Reset() {
+	std::memset(m_lanes, 0, sizeof(m_lanes));
+	m_samples.clear();
+	m_sampleStride = 1;
+	m_sampleSkip = 0;
+}
+
+HitErrorStats HitStatistics::GetStats(int lane) const {
+	HitErrorStats result = {};
+	double mean = 0, m2 = 0;
+
+	// Merge per-lane running moments (Chan et al.)
+	for (int i = 0; i < kHitStatisticsLanes; i++) {
+		if ((lane != -1 && i != lane) || m_lanes[i].Count == 0) {
+			continue;
+		}
+
+		auto& stats = m_lanes[i];
+		int count = result.Count + stats.Count;
+		double delta = stats.Mean - mean;
+
+		mean += delta * stats.Count / count;
+		m2 += stats.M2 + delta * delta * result.Count * stats.Count / count;
+
+		result.Count = count;
+		result.Early += stats.Early;
+		result.Late += stats.Late;
+		result.Outside += stats.Outside;
+	}
+
+	if (result.Count == 0) {
+		return result;
+	}
+
+	result.Mean = mean;
+	result.StdDev = result.Count > 1 ? std::sqrt(m2 / (result.Count - 1)) : 0;
+
+	auto buckets = GetHistogram(lane);
+	result.P50 = AbsolutePercentile(buckets, result.Count, 0.50);
+	result.P95 = AbsolutePercentile(buckets, result.Count, 0.95);
+	result.P99 = AbsolutePercentile(buckets, result.Count, 0.99);
+
+	return result;
+}
+
+std::vector<int> HitStatistics::GetHistogram(int lane) const {
+	std::vector<int> buckets(kHitErrorBuckets, 0);
+
+	for (int i = 0; i < kHitStatisticsLanes; i++) {
+		if (lane != -1 && i != lane) {
+			continue;
+		}
+
+		for (int j = 0; j < kHitErrorBuckets; j++) {
+			buckets[j] += m_lanes[i].Buckets[j];
+		}
+	}
+
+	return buckets;
+}
+
+const std::vector<HitSample>& HitStatistics::GetSamples() const {
+	return m_samples;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "NoteResult.hpp"
+
+// Offsets are bucketed per millisecond inside +-kHitErrorRange. Hit windows
+// scale with the beat (see CalculateHitWindow), the range holds the Bad window
+// down to kHitErrorMinimumBpm. Hits judged past it on slower sections land in
+// the outermost bucket and are counted in HitErrorStats::Outside.
+constexpr double kHitErrorMinimumBpm = 60.0;
+constexpr int kHitErrorRange = static_cast<int>(kNoteBadHitRatio * 60000.0 / kHitErrorMinimumBpm);
+constexpr int kHitErrorBuckets = kHitErrorRange * 2 + 1;
+constexpr int kHitStatisticsLanes = 7;
+
+// Hits kept for the result screen graph. Once full, every other one is
+// dropped and only every second hit after that is kept, and so on, so the
+// graph always spans the whole chart at a fixed memory cost.
+constexpr int kHitGraphSamples = 4096;
+
+struct HitSample {
+	double Time;
+	float Offset;
+	int Lane;
+};
+
+struct HitErrorStats {
+	int Count = 0;
+	int Early = 0;
+	int Late = 0;
+
+	/* hits further off than kHitErrorRange ms */
+	int Outside = 0;
+
+	/* signed offset in ms, negative is early */
+	double Mean = 0;
+	double StdDev = 0;
+
+	/* absolute offset percentiles in ms, at most kHitErrorRange */
+	double P50 = 0;
+	double P95 = 0;
+	double P99 = 0;
+};
+
+/*
+ * Signed timing error of every judged hit. Mean/deviation are kept with
+ * Welford's method and percentiles come from a fixed per-lane histogram, so
+ * the summary costs the same memory whatever the chart length. The graph
+ * samples are an evenly thinned subset of the hits, capped the same way.
+ */
+class HitStatistics {
+public:
+	HitStatistics();
+
+	void Record(int lane, double time, double offset);
+	void Reset();
+
+	// lane -1 merges every lane
+	HitErrorStats GetStats(int lane = -1) const;
+	std::vector<int> GetHistogram(int lane = -1) const;
+	const std::vector<HitSample>& GetSamples() const;
+
+private:
+	struct LaneStats {
+		int Count;
+		int Early;
+		int Late;
+		int Outside;
+		double Mean;
+		double M2;
+		int Buckets[kHitErrorBuckets];
+	};
+
+	LaneStats m_lanes[kHitStatisticsLanes];
+
+	std::vector<HitSample> m_samples;
+	int m_sampleStride;
+	int m_sampleSkip;
+};
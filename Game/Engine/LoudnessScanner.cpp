@@ -0,0 +1,167 @@
+#include "LoudnessScanner.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "ChartRender.hpp"
+#include "../Data/MusicDatabase.h"
+#include "../../Engine/Configuration.hpp"
+#include "../../Engine/LoudnessMeter.hpp"
+#include "../../Engine/Threading/JobSystem.hpp"
+
+namespace LoudnessScanner {
+	constexpr int kLoudnessSampleRate = 44100;
+
+	/* a finished job's result, applied to MusicDatabase by Update */
+	struct LoudnessResult {
+		int Id;
+		float Loudness;
+		float ReplayGain;
+		int LoudnessState;
+	};
+
+	std::mutex m_lock;
+	std::set<int> m_scanning;
+	std::vector<LoudnessResult> m_results;
+	std::atomic<int> m_pending = 0;
+
+	std::atomic<int> m_scanGeneration = 0;
+
+	/* only touched by the thread that owns MusicDatabase */
+	int m_measured = 0;
+	int m_unsaved = 0;
+
+	void SaveDatabase() {
+		MusicDatabase::GetInstance()->Save(std::filesystem::current_path() / "Game.db");
+		m_unsaved = 0;
+	}
+}
+
+bool LoudnessScanner::Measure(DB_MusicItem& item, const std::function<bool()>& cancelled) {
+	/* the mix is measured block by block, the whole song is never held in memory */
+	LoudnessMeter meter(kLoudnessSampleRate);
+	bool rendered = ChartRender::Render(item, kLoudnessSampleRate, 0, [&](const float* block, int frames) {
+		meter.Process(block, frames);
+	}, cancelled);
+
+	/* cut short, the song stays pending for the next scan */
+	if (cancelled && cancelled()) {
+		return false;
+	}
+
+	double loudness = rendered ? meter.GetIntegratedLoudness() : kLoudnessSilence;
+	bool success = rendered && loudness > kLoudnessSilence;
+
+	item.Loudness = static_cast<float>(loudness);
+	item.ReplayGain = success ? static_cast<float>(std::clamp(kLoudnessTarget - loudness, kMaxReplayCut, kMaxReplayBoost)) : 0.0f;
+	item.LoudnessState = static_cast<int>(success ? LoudnessState::MEASURED : LoudnessState::FAILED);
+
+	return success;
+}
+
+void LoudnessScanner::ScanLibrary() {
+	if (Configuration::Load("Game", "ReplayGain") == "0") {
+		return;
+	}
+
+	int generation = ++m_scanGeneration;
+	auto database = MusicDatabase::GetInstance();
+
+	for (int i = 0; i < database->GetMusicCount(); i++) {
+		DB_MusicItem item = database->GetMusicItem(i);
+		if (item.LoudnessState != static_cast<int>(LoudnessState::PENDING)) {
+			continue;
+		}
+
+		{
+			/* still running from an earlier scan */
+			std::lock_guard<std::mutex> lock(m_lock);
+			if (!m_scanning.insert(item.Id).second) {
+				continue;
+			}
+		}
+
+		m_pending++;
+		JobSystem::GetInstance()->Schedule([item, generation]() mutable {
+			/* jobs work on their own copy, MusicDatabase is only written by Update */
+			if (m_scanGeneration == generation) {
+				Measure(item, [generation] {
+					return m_scanGeneration != generation;
+				});
+			}
+
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_scanning.erase(item.Id);
+			m_pending--;
+
+			if (item.LoudnessState != static_cast<int>(LoudnessState::PENDING)) {
+				m_results.push_back({ item.Id, item.Loudness, item.ReplayGain, item.LoudnessState });
+			}
+		}, JobPriority::LOW);
+	}
+}
+
+void LoudnessScanner::Update() {
+	std::vector<LoudnessResult> results;
+	bool finished = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		results.swap(m_results);
+		finished = m_pending == 0;
+	}
+
+	auto database = MusicDatabase::GetInstance();
+	for (auto& it : results) {
+		DB_MusicItem* target = database->Find(it.Id);
+		if (target) {
+			target->Loudness = it.Loudness;
+			target->ReplayGain = it.ReplayGain;
+			target->LoudnessState = it.LoudnessState;
+		}
+
+		m_measured++;
+		m_unsaved++;
+	}
+
+	/* saved as it goes so a scan cut short isn't lost */
+	if (m_unsaved >= kLoudnessSaveInterval || (finished && m_unsaved > 0)) {
+		SaveDatabase();
+	}
+
+	if (finished && m_measured > 0) {
+		std::cout << "[LoudnessScanner] Measured " << m_measured << " songs" << std::endl;
+		m_measured = 0;
+	}
+}
+
+void LoudnessScanner::CancelScan() {
+	/* running jobs stop at their next block, whatever finished is kept */
+	++m_scanGeneration;
+
+	Update();
+	if (m_unsaved > 0) {
+		SaveDatabase();
+	}
+}
+
+float LoudnessScanner::GetGain(const DB_MusicItem& item) {
+	if (item.LoudnessState != static_cast<int>(LoudnessState::MEASURED) || Configuration::Load("Game", "ReplayGain") == "0") {
+		return 1.0f;
+	}
+
+	return static_cast<float>(std::pow(10.0, item.ReplayGain / 20.0));
+}
+
+float LoudnessScanner::GetGain(int id) {
+	DB_MusicItem* item = MusicDatabase::GetInstance()->Find(id);
+	if (item == nullptr) {
+		return 1.0f;
+	}
+
+	return GetGain(*item);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <functional>
+
+struct DB_MusicItem;
+
+// Loudness every song is brought to, and how far the gain may go either way, in LUFS/dB
+constexpr double kLoudnessTarget = -14.0;
+constexpr double kMaxReplayCut = -15.0;
+constexpr double kMaxReplayBoost = 6.0;
+
+// Measured songs between MusicDatabase saves while scanning
+constexpr int kLoudnessSaveInterval = 25;
+
+/* DB_MusicItem::LoudnessState */
+enum class LoudnessState : int {
+	PENDING,
+	MEASURED,
+	FAILED
+};
+
+/*
+ * Measures each song's integrated loudness by rendering its chart offline and
+ * keeps a replay gain for it in MusicDatabase. Only songs without a result are
+ * scanned and progress is saved as it goes, so a big library gets done over a
+ * few sessions. Playback applies the gain as a volume at load time.
+ *
+ * Scan jobs never touch MusicDatabase, their results are queued and applied by
+ * Update on the thread that owns it.
+ */
+namespace LoudnessScanner {
+	/* renders the full chart and fills Loudness/ReplayGain/LoudnessState, safe from any thread,
+	   leaves the item untouched when `cancelled` stops the render */
+	bool Measure(DB_MusicItem& item, const std::function<bool()>& cancelled = nullptr);
+
+	/* queues every unmeasured song on the job system at low priority */
+	void ScanLibrary();
+
+	/* applies finished measurements to MusicDatabase and saves every kLoudnessSaveInterval, call from song select */
+	void Update();
+
+	/* stops queued and running measurements, applies and saves what already finished */
+	void CancelScan();
+
+	/* linear gain to apply to the song, 1 when unmeasured or Game.ini ReplayGain = 0 */
+	float GetGain(const DB_MusicItem& item);
+	float GetGain(int id);
+}
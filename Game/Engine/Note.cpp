@@ -2,69 +2,26 @@
 #include "../../Engine/EstEngine.hpp"
 
 #include "RhythmEngine.hpp"
-#include "DrawableNote.hpp"
-#include "NoteImageCacheManager.hpp"
 #include "GameAudioSampleCache.hpp"
+#include <algorithm>
 
 #define REMOVE_TIME 800
 #define HOLD_COMBO_TICK 100
 
-namespace {
-	double CalculateNotePosition(double offset, double initialTrackPos, double hitPosition, double noteSpeed, bool upscroll) {
-		return hitPosition + ((initialTrackPos - offset) * (upscroll ? noteSpeed : -noteSpeed) / 100);
-	}
-
-	double lerp(double min, double max, float alpha) {
-		return min * (1.0 - alpha) + (max * alpha);
-	}
-
-	bool isWithinRange(int point, int minRange, int maxRange) {
-		return (point >= minRange && point <= maxRange);
-	}
-
-	bool isCollision(int top, int bottom, int min, int max) {
-		// Check if the top value of the rectangle is within the range
-		if (top >= min && top <= max) {
-			return true;  // Collision detected
-		}
-
-		// Check if the bottom value of the rectangle is within the range
-		if (bottom >= min && bottom <= max) {
-			return true;  // Collision detected
-		}
-
-		// Check if the range is completely inside the rectangle
-		if (top <= min && bottom >= max) {
-			return true;  // Collision detected
-		}
-
-		// No collision detected
-		return false;
-	}
-
-	const int length_multiplier[4] = {
-		0,
-		2,
-		4,
-		6
-	};
-}
-
 Note::Note(RhythmEngine* engine, GameTrack* track) {
 	m_engine = engine;
 	m_track = track;
 
 	m_imageType = NoteImageType::LANE_1;
 	m_imageBodyType = NoteImageType::HOLD_LANE_1;
-	
-	m_head = nullptr;
-	m_tail = nullptr;
-	m_body = nullptr;
+	m_id = -1;
 
 	m_startTime = 0;
 	m_endTime = 0;
 	m_startBPM = 0;
 	m_endBPM = 0;
+	m_startWindow = {};
+	m_endWindow = {};
 
 	m_type = NoteType::NORMAL;
 	m_lane = 0;
@@ -96,31 +53,25 @@ Note::~Note() {
 }
 
 void Note::Load(NoteInfoDesc* desc) {
+	m_id = desc->Id;
 	m_imageType = desc->ImageType;
 	m_imageBodyType = desc->ImageBodyType;
 
-	m_head = NoteImageCacheManager::GetInstance()->Depool(m_imageType);
 	if (desc->Type == NoteType::HOLD) {
-		m_tail = NoteImageCacheManager::GetInstance()->Depool(m_imageType);
-		m_body = NoteImageCacheManager::GetInstance()->DepoolHold(m_imageBodyType);
-		m_body->AnchorPoint = { 0, 0.5 };
-
 		m_startBPM = desc->StartBPM;
 		m_endBPM = desc->EndBPM;
+		m_startWindow = desc->StartWindow;
+		m_endWindow = desc->EndWindow;
 		m_state = NoteState::HOLD_PRE;
 	}
 	else {
-		m_tail = nullptr;
-		m_body = nullptr;
-
 		m_startBPM = desc->StartBPM;
 		m_endBPM = 0;
+		m_startWindow = desc->StartWindow;
+		m_endWindow = {};
 		m_state = NoteState::NORMAL_NOTE;
 	}
 
-	m_trail_up = NoteImageCacheManager::GetInstance()->DepoolTrail(NoteImageType::TRAIL_UP);
-	m_trail_down = NoteImageCacheManager::GetInstance()->DepoolTrail(NoteImageType::TRAIL_DOWN);
-
 	m_startTime = desc->StartTime;
 	m_endTime = desc->EndTime;
 	m_type = desc->Type;
@@ -153,164 +104,32 @@ void Note::Update(double delta) {
 	double audioPos = m_engine->GetGameAudioPosition();
 	m_hitTime = m_startTime - audioPos;
 
-	if (m_type == NoteType::NORMAL) {
-		if (IsMissed(m_engine, this)) {
-			if (!IsPassed()) {
-				m_hitPos = m_startTime + kNoteBadHitWindowMax;
-				OnHit(NoteResult::MISS);
-			}
+	// Ticks are counted against audio time, so a long step (or a slow frame)
+	// catches up on every tick it covered instead of dropping them.
+	if (m_state == NoteState::HOLD_ON_HOLDING) {
+		if (m_lastScoreTime != -1 && audioPos > m_startTime) {
+			double tickEnd = (std::min)(audioPos, m_endTime);
 
-			m_state = NoteState::DO_REMOVE;
-		}
-	}
-	else {
-		if (m_state == NoteState::HOLD_PRE) {
-			if (IsMissed(m_engine, this)) {
-				m_state = NoteState::HOLD_MISSED_ACTIVE;
-
-				m_hitPos = m_startTime + kNoteBadHitWindowMax;
-				OnHit(NoteResult::MISS);
-			}
-		}
-		else if (
-			m_state == NoteState::HOLD_ON_HOLDING || 
-			m_state == NoteState::HOLD_MISSED_ACTIVE || 
-			m_state == NoteState::HOLD_PASSED) {
-			
-			if (m_state == NoteState::HOLD_ON_HOLDING) {
-				if (m_lastScoreTime != -1 && audioPos <= m_endTime && audioPos > m_startTime) {
-					if (audioPos - m_lastScoreTime > HOLD_COMBO_TICK) {
-						m_lastScoreTime += HOLD_COMBO_TICK;
-						m_track->HandleHoldScore(HoldResult::HoldAdd);
-					}
-				}
-			}
-
-			if (IsMissed(m_engine, this)) {
-				if (m_state == NoteState::HOLD_ON_HOLDING || m_state == NoteState::HOLD_MISSED_ACTIVE) {
-					m_hitPos = m_endTime + kNoteBadHitWindowMax;
-					if (m_state == NoteState::HOLD_ON_HOLDING) {
-						OnRelease(NoteResult::MISS);
-					}
-				}
-
-				m_state = NoteState::DO_REMOVE;
+			while (tickEnd - m_lastScoreTime > HOLD_COMBO_TICK) {
+				m_lastScoreTime += HOLD_COMBO_TICK;
+				m_track->HandleHoldScore(HoldResult::HoldAdd);
 			}
 		}
 	}
 }
 
-void Note::Render(double delta) {
-	if (IsRemoveable()) return;
-	if (!m_drawAble) return;
-
-	auto resolution = m_engine->GetResolution();
-	auto hitPos = m_engine->GetHitPosition();
-	double trackPosition = m_engine->GetTrackPosition();
-
-	int min = -100, max = hitPos + 25;
-	auto playRect = m_engine->GetPlayRectangle();
-
-	int guideLineIndex = m_engine->GetGuideLineIndex();
-
-	int guideLineLength = 24 * length_multiplier[guideLineIndex];
-
-	if (m_type == NoteType::HOLD) {
-		double y1 = CalculateNotePosition(trackPosition, m_initialTrackPosition, 1000.0, m_engine->GetNotespeed(), false) / 1000.0;
-		double y2 = CalculateNotePosition(trackPosition, m_endTrackPosition, 1000.0, m_engine->GetNotespeed(), false) / 1000.0;
-
-		m_head->Position = UDim2::fromOffset(m_laneOffset, lerp(0, hitPos, y1));
-		m_tail->Position = UDim2::fromOffset(m_laneOffset, lerp(0, hitPos, y2)) ;
-
-		float Transparency = 0.9f;
-
-		if (m_hitResult >= NoteResult::GOOD && m_state == NoteState::HOLD_ON_HOLDING) {
-			//m_head->Position.Y.Offset = hitPos;
-			Transparency = 1.0f;
-		}
-
-		m_head->CalculateSize();
-		m_tail->CalculateSize();
-
-		double headPos = m_head->AbsolutePosition.Y + (m_head->AbsoluteSize.Y / 2.0);
-		double tailPos = m_tail->AbsolutePosition.Y + (m_tail->AbsoluteSize.Y / 2.0);
-
-		double height = headPos - tailPos;
-		double position = (height / 2.0) + tailPos;
-
-		m_body->Position = UDim2::fromOffset(m_laneOffset, position);
-		m_body->Size = { 1, 0, 0, height };
-		
-		m_body->TintColor = { Transparency, Transparency, Transparency };
-
-		bool b1 = isWithinRange(m_head->Position.Y.Offset, min, max);
-		bool b2 = isWithinRange(m_tail->Position.Y.Offset, min, max);
-
-		if (isCollision(m_tail->Position.Y.Offset, m_head->Position.Y.Offset, min, max)) {
-			m_body->Draw(delta, &playRect);
-		}
-
-		if (b1) {
-			if (guideLineLength > 0) {
-				m_trail_down->Position = m_head->Position;
-				m_trail_down->Size = UDim2::fromOffset(1, guideLineLength);
-				m_trail_down->AnchorPoint = { 0, 0 };
-				m_trail_down->Draw(delta, &playRect);
-
-				m_trail_down->Position = m_head->Position + UDim2::fromOffset(m_head->AbsoluteSize.X, 0);
-				m_trail_down->AnchorPoint = { 1, 0 };
-				m_trail_down->Draw(delta, &playRect);
-			}
-
-			m_head->Draw(delta, &playRect);
-		}
-
-		if (b2) {
-			if (guideLineLength > 0) {
-				m_trail_up->Position = m_tail->Position + UDim2::fromOffset(0, -m_tail->AbsoluteSize.Y);
-				m_trail_up->Size = UDim2::fromOffset(1, guideLineLength);
-				m_trail_up->AnchorPoint = { 0, 1 };
-				m_trail_up->Draw(delta, &playRect);
-
-				m_trail_up->Position = m_tail->Position + UDim2::fromOffset(m_tail->AbsoluteSize.X, -m_tail->AbsoluteSize.Y);
-				m_trail_up->AnchorPoint = { 1, 1 };
-				m_trail_up->Draw(delta, &playRect);
-			}
-
-			m_tail->Draw(delta, &playRect);
-		}
-	}
-	else {
-		double y1 = CalculateNotePosition(trackPosition, m_initialTrackPosition, 1000.0, m_engine->GetNotespeed(), false) / 1000.0;
-		m_head->Position = UDim2::fromOffset(m_laneOffset, lerp(0, hitPos, y1));
-		m_head->CalculateSize();
-		
-		bool b1 = isWithinRange(m_head->Position.Y.Offset, min, max);
-
-		if (b1) {
-			if (guideLineLength > 0) {
-				m_trail_down->Position = m_head->Position;
-				m_trail_down->Size = UDim2::fromOffset(1, guideLineLength);
-				m_trail_down->AnchorPoint = { 0, 0 };
-				m_trail_down->Draw(delta, &playRect);
-
-				m_trail_down->Position = m_head->Position + UDim2::fromOffset(m_head->AbsoluteSize.X, 0);
-				m_trail_down->AnchorPoint = { 1, 0 };
-				m_trail_down->Draw(delta, &playRect);
-
-				m_trail_up->Position = m_head->Position + UDim2::fromOffset(0, -m_head->AbsoluteSize.Y);
-				m_trail_up->Size = UDim2::fromOffset(1, guideLineLength);
-				m_trail_up->AnchorPoint = { 0, 1 };
-				m_trail_up->Draw(delta, &playRect);
-
-				m_trail_up->Position = m_head->Position + UDim2::fromOffset(m_head->AbsoluteSize.X, -m_head->AbsoluteSize.Y);
-				m_trail_up->AnchorPoint = { 1, 1 };
-				m_trail_up->Draw(delta, &playRect);
-			}
-
-			m_head->Draw(delta, &playRect);
-		}
-	}
+NoteSnapshot Note::GetSnapshot() const {
+	NoteSnapshot snapshot = {};
+	snapshot.Id = m_id;
+	snapshot.LaneOffset = m_laneOffset;
+	snapshot.Type = m_type;
+	snapshot.ImageType = m_imageType;
+	snapshot.ImageBodyType = m_imageBodyType;
+	snapshot.InitialTrackPosition = m_initialTrackPosition;
+	snapshot.EndTrackPosition = m_endTrackPosition;
+	snapshot.Highlight = m_hitResult >= NoteResult::GOOD && m_state == NoteState::HOLD_ON_HOLDING;
+
+	return snapshot;
 }
 
 double Note::GetInitialTrackPosition() const {
@@ -335,6 +154,20 @@ double Note::GetBPMTime() const {
 	}
 }
 
+const NoteHitWindow& Note::GetHitWindow() const {
+	if (GetType() == NoteType::HOLD && m_state != NoteState::HOLD_PRE) {
+		return m_endWindow;
+	}
+
+	return m_startWindow;
+}
+
+// Time after which the note can no longer be judged in its current state,
+// the owning track keeps these sorted and calls OnDeadline once it passes.
+double Note::GetDeadline() const {
+	return GetHitTime() + GetHitWindow().Bad;
+}
+
 double Note::GetHitTime() const {
 	if (GetType() == NoteType::HOLD) {
 		if (m_state == NoteState::HOLD_PRE) {
@@ -366,45 +199,24 @@ NoteType Note::GetType() const {
 }
 
 std::tuple<bool, NoteResult> Note::CheckHit() {
-	if (m_type == NoteType::NORMAL) {
-		double time_to_end = m_engine->GetGameAudioPosition() - m_startTime;
-		auto result = TimeToResult(m_engine, this);
-		if (std::get<bool>(result)) {
-			m_ignore = false;
-		}
-
-		return result;
+	if (m_type == NoteType::HOLD && m_state != NoteState::HOLD_PRE && m_state != NoteState::HOLD_MISSED_ACTIVE) {
+		return { false, NoteResult::MISS };
 	}
-	else {
-		if (m_state == NoteState::HOLD_PRE) {
-			double time_to_end = m_engine->GetGameAudioPosition() - m_startTime;
-			auto result = TimeToResult(m_engine, this);
-			if (std::get<bool>(result)) {
-				m_ignore = false;
-			}
 
-			return result;
-		}
-		else if (m_state == NoteState::HOLD_MISSED_ACTIVE) {
-			double time_to_end = m_engine->GetGameAudioPosition() - m_endTime;
-			auto result = TimeToResult(m_engine, this);
-			if (std::get<bool>(result)) {
-				m_ignore = false;
-			}
-
-			return result;
-		}
-
-		return { false, NoteResult::MISS };
+	double offset = m_engine->GetGameAudioPosition() - GetHitTime();
+	auto result = TimeToResult(GetHitWindow(), offset);
+	if (std::get<bool>(result)) {
+		m_ignore = false;
 	}
+
+	return result;
 }
 
 std::tuple<bool, NoteResult> Note::CheckRelease() {
 	if (m_type == NoteType::HOLD) {
-		double time_to_end = m_engine->GetGameAudioPosition() - m_endTime;
-
 		if (m_state == NoteState::HOLD_ON_HOLDING || m_state == NoteState::HOLD_MISSED_ACTIVE) {
-			auto result = TimeToResult(m_engine, this);
+			double offset = m_engine->GetGameAudioPosition() - m_endTime;
+			auto result = TimeToResult(m_endWindow, offset);
 
 			if (std::get<bool>(result)) {
 				if (m_state == NoteState::HOLD_MISSED_ACTIVE) {
@@ -427,6 +239,10 @@ std::tuple<bool, NoteResult> Note::CheckRelease() {
 }
 
 void Note::OnHit(NoteResult result) {
+	double hitTime = GetHitTime();
+	double offset = m_engine->GetGameAudioPosition() - hitTime;
+	bool timed = result != NoteResult::MISS;
+
 	if (m_type == NoteType::HOLD) {
 		if (m_state == NoteState::HOLD_PRE) {
 			m_didHitHead = true;
@@ -440,7 +256,10 @@ void Note::OnHit(NoteResult result) {
 				m_hitPos,
 				false,
 				m_ignore,
-				2
+				2,
+				hitTime,
+				offset,
+				timed
 			});
 		}
 		else if (m_state == NoteState::HOLD_MISSED_ACTIVE) {
@@ -453,7 +272,10 @@ void Note::OnHit(NoteResult result) {
 				m_hitPos,
 				true,
 				m_ignore,
-				2
+				2,
+				hitTime,
+				offset,
+				timed
 			});
 		}
 	}
@@ -464,12 +286,18 @@ void Note::OnHit(NoteResult result) {
 			m_hitPos,
 			false,
 			m_ignore,
-			1
+			1,
+			hitTime,
+			offset,
+			timed
 		});
 	}
 }
 
 void Note::OnRelease(NoteResult result) {
+	double offset = m_engine->GetGameAudioPosition() - m_endTime;
+	bool timed = result != NoteResult::MISS;
+
 	if (m_type == NoteType::HOLD) {
 		if (m_state == NoteState::HOLD_ON_HOLDING || m_state == NoteState::HOLD_MISSED_ACTIVE) {
 			m_lastScoreTime = -1;
@@ -484,7 +312,10 @@ void Note::OnRelease(NoteResult result) {
 					m_hitPos,
 					true,
 					m_ignore,
-					2
+					2,
+					m_endTime,
+					offset,
+					timed
 				});
 			}
 			else {
@@ -495,13 +326,45 @@ void Note::OnRelease(NoteResult result) {
 					m_hitPos,
 					true,
 					m_ignore,
-					2
+					2,
+					m_endTime,
+					offset,
+					timed
 				});
 			}
 		}
 	}
 }
 
+void Note::OnDeadline() {
+	if (IsRemoveable()) return;
+
+	if (m_type == NoteType::NORMAL) {
+		if (!IsPassed()) {
+			m_hitPos = m_startTime + kNoteBadHitWindowMax;
+			OnHit(NoteResult::MISS);
+		}
+
+		m_state = NoteState::DO_REMOVE;
+	}
+	else if (m_state == NoteState::HOLD_PRE) {
+		m_state = NoteState::HOLD_MISSED_ACTIVE;
+
+		m_hitPos = m_startTime + kNoteBadHitWindowMax;
+		OnHit(NoteResult::MISS);
+	}
+	else {
+		if (m_state == NoteState::HOLD_ON_HOLDING || m_state == NoteState::HOLD_MISSED_ACTIVE) {
+			m_hitPos = m_endTime + kNoteBadHitWindowMax;
+			if (m_state == NoteState::HOLD_ON_HOLDING) {
+				OnRelease(NoteResult::MISS);
+			}
+		}
+
+		m_state = NoteState::DO_REMOVE;
+	}
+}
+
 void Note::SetXPosition(int x) {
 	m_laneOffset = x;
 }
@@ -539,27 +402,4 @@ bool Note::IsTailHit() {
 void Note::Release() {
 	m_state = NoteState::DO_REMOVE;
 	m_removeAble = true;
-
-	auto cacheManager = NoteImageCacheManager::GetInstance();
-
-	cacheManager->RepoolTrail(m_trail_down, NoteImageType::TRAIL_DOWN);
-	cacheManager->RepoolTrail(m_trail_up, NoteImageType::TRAIL_UP);
-
-	m_trail_up = nullptr;
-	m_trail_down = nullptr;
-
-	if (m_type == NoteType::HOLD) {
-		cacheManager->Repool(m_head, m_imageType);
-		m_head = nullptr;
-
-		cacheManager->Repool(m_tail, m_imageType);
-		m_tail = nullptr;
-
-		cacheManager->RepoolHold(m_body, m_imageBodyType);
-		m_body = nullptr;
-	}
-	else {
-		cacheManager->Repool(m_head, m_imageType);
-		m_head = nullptr;
-	}
 }
\ No newline at end of file
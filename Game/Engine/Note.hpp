@@ -2,14 +2,12 @@
 #include "../../Engine/Keys.h"
 #include "../Resources/GameResources.hpp"
 #include "NoteResult.hpp"
+#include "GameSnapshot.hpp"
 
 enum class NoteType : uint8_t;
 class GameTrack;
 class RhythmEngine;
-class DrawableNote;
-class DrawableTile;
 class AudioSampleChannel;
-class ResizableImage;
 
 enum class NoteState {
 	NORMAL_NOTE,
@@ -24,7 +22,7 @@ enum class NoteState {
 };
 
 struct NoteInfoDesc {
-	DrawableNote* Image;
+	int Id;
 	NoteImageType ImageType;
 	NoteImageType ImageBodyType;
 
@@ -37,6 +35,9 @@ struct NoteInfoDesc {
 	double StartBPM;
 	double EndBPM;
 
+	NoteHitWindow StartWindow;
+	NoteHitWindow EndWindow;
+
 	int Lane;
 	NoteType Type;
 
@@ -52,12 +53,14 @@ public:
 	void Load(NoteInfoDesc* desc);
 
 	void Update(double delta);
-	void Render(double delta);
+	NoteSnapshot GetSnapshot() const;
 
 	double GetInitialTrackPosition() const;
 	double GetStartTime() const;
 	double GetBPMTime() const;
 	double GetHitTime() const;
+	const NoteHitWindow& GetHitWindow() const;
+	double GetDeadline() const;
 
 	int GetKeysoundId() const;
 	int GetKeyVolume() const;
@@ -68,6 +71,7 @@ public:
 	std::tuple<bool, NoteResult> CheckRelease();
 	void OnHit(NoteResult result);
 	void OnRelease(NoteResult result);
+	void OnDeadline();
 
 	void SetXPosition(int x);
 	void SetDrawable(bool drawable);
@@ -89,13 +93,7 @@ private:
 	RhythmEngine* m_engine;
 	GameTrack* m_track;
 
-	DrawableNote* m_head;
-	DrawableNote* m_body;
-	DrawableNote* m_tail;
-
-	DrawableNote* m_trail_up;
-	DrawableNote* m_trail_down;
-
+	int m_id;
 	NoteImageType m_imageType;
 	NoteImageType m_imageBodyType;
 
@@ -105,6 +103,9 @@ private:
 	double m_startBPM;
 	double m_endBPM;
 
+	NoteHitWindow m_startWindow;
+	NoteHitWindow m_endWindow;
+
 	int m_keysoundIndex;
 	int m_lane;
 
@@ -0,0 +1,232 @@
+#include "NoteRenderer.hpp"
+#include "../../Engine/EstEngine.hpp"
+
+#include "RhythmEngine.hpp"
+#include "DrawableNote.hpp"
+#include "NoteImageCacheManager.hpp"
+
+namespace {
+	double CalculateNotePosition(double offset, double initialTrackPos, double hitPosition, double noteSpeed, bool upscroll) {
+		return hitPosition + ((initialTrackPos - offset) * (upscroll ? noteSpeed : -noteSpeed) / 100);
+	}
+
+	double lerp(double min, double max, float alpha) {
+		return min * (1.0 - alpha) + (max * alpha);
+	}
+
+	bool isWithinRange(int point, int minRange, int maxRange) {
+		return (point >= minRange && point <= maxRange);
+	}
+
+	bool isCollision(int top, int bottom, int min, int max) {
+		// Check if the top value of the rectangle is within the range
+		if (top >= min && top <= max) {
+			return true;  // Collision detected
+		}
+
+		// Check if the bottom value of the rectangle is within the range
+		if (bottom >= min && bottom <= max) {
+			return true;  // Collision detected
+		}
+
+		// Check if the range is completely inside the rectangle
+		if (top <= min && bottom >= max) {
+			return true;  // Collision detected
+		}
+
+		// No collision detected
+		return false;
+	}
+
+	const int length_multiplier[4] = {
+		0,
+		2,
+		4,
+		6
+	};
+}
+
+NoteRenderer::NoteRenderer(RhythmEngine* engine) {
+	m_engine = engine;
+	m_frame = 0;
+}
+
+NoteRenderer::~NoteRenderer() {
+	for (auto& [id, visual] : m_visuals) {
+		Repool(visual);
+	}
+
+	m_visuals.clear();
+}
+
+void NoteRenderer::Render(double delta, const std::vector<NoteSnapshot>& notes, double trackPosition, double noteSpeed) {
+	m_frame++;
+
+	for (auto& note : notes) {
+		NoteVisual& visual = Acquire(note);
+		visual.Frame = m_frame;
+
+		DrawNote(delta, visual, note, trackPosition, noteSpeed);
+	}
+
+	// Notes that left the snapshot are done, give their images back.
+	for (auto it = m_visuals.begin(); it != m_visuals.end();) {
+		if (it->second.Frame != m_frame) {
+			Repool(it->second);
+			it = m_visuals.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+}
+
+NoteRenderer::NoteVisual& NoteRenderer::Acquire(const NoteSnapshot& note) {
+	auto it = m_visuals.find(note.Id);
+	if (it != m_visuals.end()) {
+		return it->second;
+	}
+
+	auto cacheManager = NoteImageCacheManager::GetInstance();
+
+	NoteVisual visual = {};
+	visual.Type = note.Type;
+	visual.ImageType = note.ImageType;
+	visual.ImageBodyType = note.ImageBodyType;
+
+	visual.Head = cacheManager->Depool(note.ImageType);
+	if (note.Type == NoteType::HOLD) {
+		visual.Tail = cacheManager->Depool(note.ImageType);
+		visual.Body = cacheManager->DepoolHold(note.ImageBodyType);
+		visual.Body->AnchorPoint = { 0, 0.5 };
+	}
+
+	visual.TrailUp = cacheManager->DepoolTrail(NoteImageType::TRAIL_UP);
+	visual.TrailDown = cacheManager->DepoolTrail(NoteImageType::TRAIL_DOWN);
+
+	return m_visuals.emplace(note.Id, visual).first->second;
+}
+
+void NoteRenderer::Repool(NoteVisual& visual) {
+	auto cacheManager = NoteImageCacheManager::GetInstance();
+
+	cacheManager->RepoolTrail(visual.TrailDown, NoteImageType::TRAIL_DOWN);
+	cacheManager->RepoolTrail(visual.TrailUp, NoteImageType::TRAIL_UP);
+	cacheManager->Repool(visual.Head, visual.ImageType);
+
+	if (visual.Type == NoteType::HOLD) {
+		cacheManager->Repool(visual.Tail, visual.ImageType);
+		cacheManager->RepoolHold(visual.Body, visual.ImageBodyType);
+	}
+
+	visual = {};
+}
+
+void NoteRenderer::DrawNote(double delta, NoteVisual& visual, const NoteSnapshot& note, double trackPosition, double noteSpeed) {
+	auto resolution = m_engine->GetResolution();
+	auto hitPos = m_engine->GetHitPosition();
+
+	int min = -100, max = hitPos + 25;
+	auto playRect = m_engine->GetPlayRectangle();
+
+	int guideLineIndex = m_engine->GetGuideLineIndex();
+
+	int guideLineLength = 24 * length_multiplier[guideLineIndex];
+
+	if (note.Type == NoteType::HOLD) {
+		double y1 = CalculateNotePosition(trackPosition, note.InitialTrackPosition, 1000.0, noteSpeed, false) / 1000.0;
+		double y2 = CalculateNotePosition(trackPosition, note.EndTrackPosition, 1000.0, noteSpeed, false) / 1000.0;
+
+		visual.Head->Position = UDim2::fromOffset(note.LaneOffset, lerp(0, hitPos, y1));
+		visual.Tail->Position = UDim2::fromOffset(note.LaneOffset, lerp(0, hitPos, y2)) ;
+
+		float Transparency = 0.9f;
+
+		if (note.Highlight) {
+			//visual.Head->Position.Y.Offset = hitPos;
+			Transparency = 1.0f;
+		}
+
+		visual.Head->CalculateSize();
+		visual.Tail->CalculateSize();
+
+		double headPos = visual.Head->AbsolutePosition.Y + (visual.Head->AbsoluteSize.Y / 2.0);
+		double tailPos = visual.Tail->AbsolutePosition.Y + (visual.Tail->AbsoluteSize.Y / 2.0);
+
+		double height = headPos - tailPos;
+		double position = (height / 2.0) + tailPos;
+
+		visual.Body->Position = UDim2::fromOffset(note.LaneOffset, position);
+		visual.Body->Size = { 1, 0, 0, height };
+		
+		visual.Body->TintColor = { Transparency, Transparency, Transparency };
+
+		bool b1 = isWithinRange(visual.Head->Position.Y.Offset, min, max);
+		bool b2 = isWithinRange(visual.Tail->Position.Y.Offset, min, max);
+
+		if (isCollision(visual.Tail->Position.Y.Offset, visual.Head->Position.Y.Offset, min, max)) {
+			visual.Body->Draw(delta, &playRect);
+		}
+
+		if (b1) {
+			if (guideLineLength > 0) {
+				visual.TrailDown->Position = visual.Head->Position;
+				visual.TrailDown->Size = UDim2::fromOffset(1, guideLineLength);
+				visual.TrailDown->AnchorPoint = { 0, 0 };
+				visual.TrailDown->Draw(delta, &playRect);
+
+				visual.TrailDown->Position = visual.Head->Position + UDim2::fromOffset(visual.Head->AbsoluteSize.X, 0);
+				visual.TrailDown->AnchorPoint = { 1, 0 };
+				visual.TrailDown->Draw(delta, &playRect);
+			}
+
+			visual.Head->Draw(delta, &playRect);
+		}
+
+		if (b2) {
+			if (guideLineLength > 0) {
+				visual.TrailUp->Position = visual.Tail->Position + UDim2::fromOffset(0, -visual.Tail->AbsoluteSize.Y);
+				visual.TrailUp->Size = UDim2::fromOffset(1, guideLineLength);
+				visual.TrailUp->AnchorPoint = { 0, 1 };
+				visual.TrailUp->Draw(delta, &playRect);
+
+				visual.TrailUp->Position = visual.Tail->Position + UDim2::fromOffset(visual.Tail->AbsoluteSize.X, -visual.Tail->AbsoluteSize.Y);
+				visual.TrailUp->AnchorPoint = { 1, 1 };
+				visual.TrailUp->Draw(delta, &playRect);
+			}
+
+			visual.Tail->Draw(delta, &playRect);
+		}
+	}
+	else {
+		double y1 = CalculateNotePosition(trackPosition, note.InitialTrackPosition, 1000.0, noteSpeed, false) / 1000.0;
+		visual.Head->Position = UDim2::fromOffset(note.LaneOffset, lerp(0, hitPos, y1));
+		visual.Head->CalculateSize();
+		
+		bool b1 = isWithinRange(visual.Head->Position.Y.Offset, min, max);
+
+		if (b1) {
+			if (guideLineLength > 0) {
+				visual.TrailDown->Position = visual.Head->Position;
+				visual.TrailDown->Size = UDim2::fromOffset(1, guideLineLength);
+				visual.TrailDown->AnchorPoint = { 0, 0 };
+				visual.TrailDown->Draw(delta, &playRect);
+
+				visual.TrailDown->Position = visual.Head->Position + UDim2::fromOffset(visual.Head->AbsoluteSize.X, 0);
+				visual.TrailDown->AnchorPoint = { 1, 0 };
+				visual.TrailDown->Draw(delta, &playRect);
+
+				visual.TrailUp->Position = visual.Head->Position + UDim2::fromOffset(0, -visual.Head->AbsoluteSize.Y);
+				visual.TrailUp->Size = UDim2::fromOffset(1, guideLineLength);
+				visual.TrailUp->AnchorPoint = { 0, 1 };
+				visual.TrailUp->Draw(delta, &playRect);
+
+				visual.TrailUp->Position = visual.Head->Position + UDim2::fromOffset(visual.Head->AbsoluteSize.X, -visual.Head->AbsoluteSize.Y);
+				visual.TrailUp->AnchorPoint = { 1, 1 };
+				visual.TrailUp->Draw(delta, &playRect);
+			}
+
+			visual.Head->Draw(delta, &playRect);
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "GameSnapshot.hpp"
+
+class RhythmEngine;
+class DrawableNote;
+
+/*
+ * Render thread side of the notes. Draws the notes of a GameSnapshot and
+ * keeps the pooled images of every note that is on screen, keyed by note id,
+ * so animations carry on between snapshots.
+ */
+class NoteRenderer {
+public:
+	NoteRenderer(RhythmEngine* engine);
+	~NoteRenderer();
+
+	void Render(double delta, const std::vector<NoteSnapshot>& notes, double trackPosition, double noteSpeed);
+
+private:
+	struct NoteVisual {
+		DrawableNote* Head;
+		DrawableNote* Body;
+		DrawableNote* Tail;
+		DrawableNote* TrailUp;
+		DrawableNote* TrailDown;
+
+		NoteType Type;
+		NoteImageType ImageType;
+		NoteImageType ImageBodyType;
+
+		uint32_t Frame;
+	};
+
+	NoteVisual& Acquire(const NoteSnapshot& note);
+	void Repool(NoteVisual& visual);
+
+	void DrawNote(double delta, NoteVisual& visual, const NoteSnapshot& note, double trackPosition, double noteSpeed);
+
+	RhythmEngine* m_engine;
+	uint32_t m_frame;
+
+	std::unordered_map<int, NoteVisual> m_visuals;
+};
@@ -1,37 +1,30 @@
 #include "NoteResult.hpp"
-#include <iostream>
-#include <iomanip>
-#include "RhythmEngine.hpp"
+#include <cmath>
 
-float CalculateBeatDiff(RhythmEngine* engine, Note* note) {
-	double audioPos = engine->GetGameAudioPosition();
-	double hitTime = note->GetHitTime();
-	double bpm = note->GetBPMTime();
+NoteHitWindow CalculateHitWindow(double bpm) {
+	double beatLength = 60000.0 / bpm;
 
-	return (audioPos - hitTime) * bpm / 60000.0;
+	return {
+		kNoteCoolHitRatio * beatLength,
+		kNoteGoodHitRatio * beatLength,
+		kNoteBadHitRatio * beatLength,
+		kNoteEarlyMissRatio * beatLength
+	};
 }
 
-bool IsMissed(RhythmEngine* engine, Note* note) {
-	return CalculateBeatDiff(engine, note) > kNoteBadHitRatio;
-}
-
-bool IsAccept(RhythmEngine* engine, Note* note) {
-	return CalculateBeatDiff(engine, note) >= kNoteBadHitRatio;
-}
-
-std::tuple<bool, NoteResult> TimeToResult(RhythmEngine* engine, Note* note) {
-	double beatDiff = std::abs(CalculateBeatDiff(engine, note));
+std::tuple<bool, NoteResult> TimeToResult(const NoteHitWindow& window, double offset) {
+	double diff = std::abs(offset);
 
-	if (beatDiff <= kNoteCoolHitRatio) {
+	if (diff <= window.Cool) {
 		return { true, NoteResult::COOL };
 	}
-	else if (beatDiff <= kNoteGoodHitRatio) {
+	else if (diff <= window.Good) {
 		return { true, NoteResult::GOOD };
 	}
-	else if (beatDiff <= kNoteBadHitRatio) {
+	else if (diff <= window.Bad) {
 		return { true, NoteResult::BAD };
 	}
-	else if (beatDiff <= kNoteEarlyMissRatio) {
+	else if (diff <= window.EarlyMiss) {
 		return { true, NoteResult::MISS };
 	}
 
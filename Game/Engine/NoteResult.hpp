@@ -29,12 +29,20 @@ namespace {
 	const double kNoteBadHitWindowMax = 150;
 	const double kNoteEarlyMissWindowMin = 200;
 
-	const double kNoteCoolHitRatio = 0.2;
-	const double kNoteGoodHitRatio = 0.5;
-	const double kNoteBadHitRatio = 0.8;
-	const double kNoteEarlyMissRatio = 0.85;
+	constexpr double kNoteCoolHitRatio = 0.2;
+	constexpr double kNoteGoodHitRatio = 0.5;
+	constexpr double kNoteBadHitRatio = 0.8;
+	constexpr double kNoteEarlyMissRatio = 0.85;
 }
 
-bool IsMissed(RhythmEngine* engine, Note* note);
-bool IsAccept(RhythmEngine* engine, Note* note);
-std::tuple<bool, NoteResult> TimeToResult(RhythmEngine* engine, Note* note);
\ No newline at end of file
+// Judgement bounds of a single note edge in milliseconds, the beat ratios
+// above are converted once per note when the chart is loaded.
+struct NoteHitWindow {
+	double Cool;
+	double Good;
+	double Bad;
+	double EarlyMiss;
+};
+
+NoteHitWindow CalculateHitWindow(double bpm);
+std::tuple<bool, NoteResult> TimeToResult(const NoteHitWindow& window, double offset);
\ No newline at end of file
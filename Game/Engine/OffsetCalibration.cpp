@@ -0,0 +1,101 @@
+#include "OffsetCalibration.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	double Median(std::vector<double> values) {
+		if (values.empty()) {
+			return 0;
+		}
+
+		size_t middle = values.size() / 2;
+		std::nth_element(values.begin(), values.begin() + middle, values.end());
+		double median = values[middle];
+
+		if (values.size() % 2 == 0) {
+			median = (median + *std::max_element(values.begin(), values.begin() + middle)) / 2.0;
+		}
+
+		return median;
+	}
+}
+
+void OffsetCalibration::SetBeats(double start, double interval, int count) {
+	m_start = start;
+	m_interval = interval;
+	m_count = (std::max)(count, 0);
+
+	m_taps = 0;
+	m_tapped.assign(m_count, false);
+	m_errors.clear();
+}
+
+void OffsetCalibration::AddTap(double time) {
+	if (m_count == 0 || m_interval <= 0) {
+		return;
+	}
+
+	m_taps++;
+
+	double beat = std::round((time - m_start) / m_interval);
+	if (beat < 0 || beat >= m_count) {
+		return;
+	}
+
+	int index = static_cast<int>(beat);
+	if (m_tapped[index]) {
+		return;
+	}
+
+	m_tapped[index] = true;
+	m_errors.push_back(time - (m_start + index * m_interval));
+}
+
+void OffsetCalibration::Reset() {
+	SetBeats(0, 0, 0);
+}
+
+CalibrationResult OffsetCalibration::GetResult() const {
+	CalibrationResult result = {};
+	result.Taps = m_taps;
+
+	if (m_errors.empty()) {
+		return result;
+	}
+
+	double median = Median(m_errors);
+
+	std::vector<double> deviations;
+	for (double error : m_errors) {
+		deviations.push_back(std::fabs(error - median));
+	}
+
+	/* 1.4826 scales the MAD to a standard deviation for normally distributed taps */
+	double spread = (std::max)(Median(deviations) * 1.4826, kCalibrationMinimumSpread);
+	double limit = spread * kCalibrationOutlierLimit;
+
+	double mean = 0, m2 = 0;
+	int count = 0;
+	for (double error : m_errors) {
+		if (std::fabs(error - median) > limit) {
+			continue;
+		}
+
+		count++;
+		double diff = error - mean;
+		mean += diff / count;
+		m2 += diff * (error - mean);
+	}
+
+	result.Used = count;
+	result.Median = median;
+	result.Mean = mean;
+	result.StdDev = count > 1 ? std::sqrt(m2 / (count - 1)) : 0;
+	result.Valid = count >= kCalibrationMinimumTaps;
+
+	return result;
+}
+
+const std::vector<double>& OffsetCalibration::GetErrors() const {
+	return m_errors;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+
+// Taps further from the median than this many (scaled) median absolute
+// deviations are outliers, the spread never counts as tighter than
+// kCalibrationMinimumSpread ms so a very steady player isn't over-filtered
+constexpr double kCalibrationOutlierLimit = 3.0;
+constexpr double kCalibrationMinimumSpread = 5.0;
+
+// Taps that have to survive the outlier pass before an offset is recommended
+constexpr int kCalibrationMinimumTaps = 8;
+
+struct CalibrationResult {
+	int Taps = 0;
+	int Used = 0;
+
+	/* signed tap error in ms over the taps kept, positive is late */
+	double Mean = 0;
+	double Median = 0;
+	double StdDev = 0;
+
+	bool Valid = false;
+};
+
+/*
+ * Turns tap timestamps against a known beat grid into an offset. Each tap is
+ * matched to its nearest beat, taps more than half a beat away or on a beat
+ * that was already tapped are ignored. The remaining errors go through a
+ * median/MAD outlier pass and the rest are averaged. Only plain numbers go in,
+ * so it can be fed synthetic tap streams without any audio or input.
+ */
+class OffsetCalibration {
+public:
+	/* beats at start, start + interval, ... in ms on the same clock as the taps */
+	void SetBeats(double start, double interval, int count);
+	void AddTap(double time);
+	void Reset();
+
+	CalibrationResult GetResult() const;
+	const std::vector<double>& GetErrors() const;
+
+private:
+	double m_start = 0;
+	double m_interval = 0;
+	int m_count = 0;
+
+	int m_taps = 0;
+	std::vector<bool> m_tapped;
+	std::vector<double> m_errors;
+};
@@ -0,0 +1,153 @@
+#include "PreviewBuilder.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "ChartRender.hpp"
+#include "../Data/MusicDatabase.h"
+#include "../../Engine/Configuration.hpp"
+#include "../../Engine/ImaAdpcm.hpp"
+#include "../../Engine/Threading/JobSystem.hpp"
+
+namespace PreviewBuilder {
+	// Excerpt length when Game.ini has none, in seconds
+	constexpr int kDefaultPreviewLength = 20;
+	constexpr double kPreviewFadeIn = 0.05;
+	constexpr double kPreviewFadeOut = 1.5;
+
+	std::mutex m_lock;
+	std::condition_variable m_built;
+	std::set<int> m_building;
+
+	std::atomic<int> m_prebuildGeneration = 0;
+
+	int GetPreviewLength() {
+		auto value = Configuration::Load("Game", "PreviewLength");
+		if (value.size()) {
+			try {
+				return std::clamp(std::stoi(value), 5, 60);
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::PreviewLength" << std::endl;
+			}
+		}
+
+		return kDefaultPreviewLength;
+	}
+
+	bool Render(const DB_MusicItem& item, std::filesystem::path path) {
+		int length = GetPreviewLength();
+
+		std::vector<float> output;
+		output.reserve(static_cast<size_t>(length) * kPreviewSampleRate * 2);
+
+		bool rendered = ChartRender::Render(item, kPreviewSampleRate, length * 1000.0, [&](const float* block, int frames) {
+			output.insert(output.end(), block, block + frames * 2);
+		});
+
+		if (!rendered || output.empty()) {
+			return false;
+		}
+
+		size_t frames = output.size() / 2;
+		size_t fadeIn = (std::min)(static_cast<size_t>(kPreviewFadeIn * kPreviewSampleRate), frames);
+		size_t fadeOut = (std::min)(static_cast<size_t>(kPreviewFadeOut * kPreviewSampleRate), frames);
+		for (size_t i = 0; i < fadeIn; i++) {
+			float gain = static_cast<float>(i) / fadeIn;
+			output[i * 2] *= gain;
+			output[i * 2 + 1] *= gain;
+		}
+
+		for (size_t i = 0; i < fadeOut; i++) {
+			float gain = static_cast<float>(i) / fadeOut;
+			size_t index = frames - 1 - i;
+			output[index * 2] *= gain;
+			output[index * 2 + 1] *= gain;
+		}
+
+		/* write aside and rename so song select never opens a half written file */
+		std::filesystem::create_directories(path.parent_path());
+
+		auto temp = path;
+		temp += ".tmp";
+		if (!ImaAdpcm::WriteWav(temp, output, 2, kPreviewSampleRate)) {
+			std::filesystem::remove(temp);
+			return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(temp, path, ec);
+		return !ec;
+	}
+}
+
+std::filesystem::path PreviewBuilder::GetPath(const DB_MusicItem& item) {
+	std::string name(item.Hash, strnlen(item.Hash, sizeof(item.Hash)));
+	if (name.empty()) {
+		name = "o2ma" + std::to_string(item.Id);
+	}
+
+	return std::filesystem::current_path() / "Cache" / "Preview" / (name + ".wav");
+}
+
+bool PreviewBuilder::Build(const DB_MusicItem& item) {
+	auto path = GetPath(item);
+
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+
+		/* song select and the prebuild can ask for the same song at once */
+		m_built.wait(lock, [&] {
+			return m_building.find(item.Id) == m_building.end();
+		});
+
+		if (std::filesystem::exists(path)) {
+			return true;
+		}
+
+		m_building.insert(item.Id);
+	}
+
+	bool result = Render(item, path);
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_building.erase(item.Id);
+	}
+
+	m_built.notify_all();
+	return result;
+}
+
+void PreviewBuilder::PrebuildLibrary() {
+	if (Configuration::Load("Game", "PreviewPrebuild") == "0") {
+		return;
+	}
+
+	int generation = ++m_prebuildGeneration;
+	auto database = MusicDatabase::GetInstance();
+
+	for (int i = 0; i < database->GetMusicCount(); i++) {
+		DB_MusicItem item = database->GetMusicItem(i);
+		if (std::filesystem::exists(GetPath(item))) {
+			continue;
+		}
+
+		JobSystem::GetInstance()->Schedule([item, generation] {
+			if (m_prebuildGeneration != generation) {
+				return;
+			}
+
+			Build(item);
+		}, JobPriority::LOW);
+	}
+}
+
+void PreviewBuilder::CancelPrebuild() {
+	++m_prebuildGeneration;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <filesystem>
+
+struct DB_MusicItem;
+
+// Sample rate previews are rendered at
+constexpr int kPreviewSampleRate = 44100;
+
+/*
+ * Renders song select previews once into small IMA ADPCM WAV files under
+ * Cache/Preview, keyed by the chart hash, so song select only has to open a
+ * single stream instead of parsing the chart and loading every keysound.
+ */
+namespace PreviewBuilder {
+	std::filesystem::path GetPath(const DB_MusicItem& item);
+
+	/* renders the preview unless it's already cached, safe from any thread */
+	bool Build(const DB_MusicItem& item);
+
+	/* queues every missing preview on the job system at low priority */
+	void PrebuildLibrary();
+	void CancelPrebuild();
+}
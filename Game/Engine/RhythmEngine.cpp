@@ -8,9 +8,11 @@
 
 #include "NoteImageCacheManager.hpp"
 #include "GameAudioSampleCache.hpp"
+#include "LoudnessScanner.hpp"
 #include "NoteResult.hpp"
 
 #include <chrono>
+#include <cmath>
 #include <codecvt>
 
 struct ManiaKeyState {
@@ -59,6 +61,7 @@ RhythmEngine::RhythmEngine() {
 	m_rate = 1;
 	m_offset = 0;
 	m_scrollSpeed = 180;
+	m_noteRenderer = nullptr;
 
 	m_timingPositionMarkers = std::vector<double>();
 }
@@ -79,11 +82,9 @@ bool RhythmEngine::Load(Chart* chart) {
 		m_tracks.push_back(new GameTrack( this, i, currentX ));
 		m_autoHitIndex[i] = 0;
 
-		if (m_eventCallback) {
-			m_tracks[i]->ListenEvent([&](GameTrackEvent e) {
-				m_eventCallback(e);
-			});
-		}
+		m_tracks[i]->ListenEvent([&](GameTrackEvent e) {
+			OnTrackEvent(e);
+		});
 
 		int size = GameNoteResource::GetNoteTexture(Key2Type[i])->TextureRect.right;
 		
@@ -140,6 +141,12 @@ bool RhythmEngine::Load(Chart* chart) {
 		}
 	}
 
+	/* one gain per song, folded into the keysound volumes below */
+	std::string songId = EnvironmentSetup::Get("Key");
+	if (songId.size() > 0) {
+		m_replayGain = LoudnessScanner::GetGain(std::atoi(songId.c_str()));
+	}
+
 	auto audioOffset = Configuration::Load("Game", "AudioOffset");
 	if (audioOffset.size() > 0) {
 		try {
@@ -152,6 +159,17 @@ bool RhythmEngine::Load(Chart* chart) {
 		}
 	}
 
+	auto visualOffset = Configuration::Load("Game", "VisualOffset");
+	if (visualOffset.size() > 0) {
+		try {
+			m_visualOffset = std::atoi(visualOffset.c_str());
+		}
+		catch (std::invalid_argument e) {
+			std::cout << "Game.ini::VisualOffset invalid offset: " << visualOffset << " reverting to 0 value" << std::endl;
+			m_visualOffset = 0;
+		}
+	}
+
 	auto autoSound = Configuration::Load("Game", "AutoSound");
 	bool IsAutoSound = false;
 	if (autoSound.size() > 0) {
@@ -221,13 +239,15 @@ bool RhythmEngine::Load(Chart* chart) {
 		desc.EndTrackPosition = -1;
 		desc.KeysoundIndex = note.Keysound;
 		desc.StartBPM = GetBPMAt(note.StartTime);
-		desc.Volume = note.Volume * m_audioVolume;
+		desc.StartWindow = CalculateHitWindow(desc.StartBPM);
+		desc.Volume = note.Volume * m_audioVolume * m_replayGain;
 		desc.Pan = note.Pan * m_audioVolume;
 
 		if (note.Type == NoteType::HOLD) {
 			desc.EndTime = note.EndTime;
 			desc.EndTrackPosition = GetPositionFromOffset(note.EndTime);
 			desc.EndBPM = GetBPMAt(note.EndTime);
+			desc.EndWindow = CalculateHitWindow(desc.EndBPM);
 		}
 
 		if ((m_audioOffset != 0 && desc.KeysoundIndex != -1) || IsAutoSound) {
@@ -257,13 +277,22 @@ bool RhythmEngine::Load(Chart* chart) {
 		return a.StartTime < b.StartTime;
 	});
 
-	UpdateGamePosition();
-	UpdateNotes();
+	std::vector<int> scheduledSamples;
+	for (auto& sample : m_autoSamples) {
+		scheduledSamples.push_back(sample.Index);
+	}
+
+	GameAudioSampleCache::PrepareScheduled(scheduledSamples);
 
-	m_timingLineManager = chart->m_customMeasures.size() > 0 ? new TimingLineManager(this, chart->m_customMeasures) : new TimingLineManager(this);
+	for (int i = 0; i < m_noteDescs.size(); i++) {
+		m_noteDescs[i].Id = i;
+	}
+
+	m_timingLineManager = new TimingLineManager(this, chart);
 	m_scoreManager = new ScoreManager();
+	m_noteRenderer = new NoteRenderer(this);
 
-	m_timingLineManager->Init();
+	BuildTimeline(chart);
 	m_state = GameState::NotGame;
 	return true;
 }
@@ -278,6 +307,9 @@ bool RhythmEngine::Start() { // no, use update event instead
 	m_currentAudioPosition -= 3000;
 	m_state = GameState::Playing;
 
+	// Autoplay keysounds are timed by the audio clock from here on
+	GameAudioSampleCache::StartClock(m_currentAudioPosition + m_offset);
+
 	m_startClock = std::chrono::system_clock::now();
 	return true;
 }
@@ -304,7 +336,6 @@ void RhythmEngine::Update(double delta) {
 
 	UpdateVirtualResolution();
 	UpdateGamePosition();
-	UpdateNotes();
 
 	m_timingLineManager->Update(delta);
 
@@ -312,37 +343,105 @@ void RhythmEngine::Update(double delta) {
 		it->Update(delta);
 	}
 
-	// Sample event updates
-	for (int i = m_currentSampleIndex; i < m_autoSamples.size(); i++) {
-		auto& sample = m_autoSamples[i];
-		if (m_currentAudioPosition >= sample.StartTime) {
-			if (sample.StartTime - m_currentAudioPosition < 5) {
-				GameAudioSampleCache::Play(sample.Index, sample.Volume * m_audioVolume, sample.Pan * 100);
-			}
-
-			m_currentSampleIndex++;
-		}
-		else {
-			break;
-		}
-	}
-
 	auto currentTime = std::chrono::system_clock::now();
 	auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - m_startClock);
 	m_PlayTime = static_cast<int>(elapsedTime.count() / 1000);
+
+	PublishSnapshot(delta);
 }
 
 void RhythmEngine::Render(double delta) {
-	if (m_state == GameState::NotGame || m_state == GameState::PosGame) return;
+	auto& snapshot = m_snapshots.Read();
+	if (snapshot.State == GameState::NotGame || snapshot.State == GameState::PosGame) return;
+
+	// The snapshot is up to one step old, blend from the previous step's
+	// position by how much of the next step has already elapsed.
+	double alpha = 1.0;
+	if (snapshot.StepTime > 0) {
+		double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		alpha = std::clamp((now - snapshot.Timestamp) / snapshot.StepTime, 0.0, 1.0);
+	}
+
+	double trackPosition = std::lerp(snapshot.PreviousTrackPosition, snapshot.TrackPosition, alpha);
 	
-	m_timingLineManager->Render(delta);
+	m_timingLineManager->Render(delta, snapshot.TimingLines, trackPosition, snapshot.NoteSpeed);
+	m_noteRenderer->Render(delta, snapshot.Notes, trackPosition, snapshot.NoteSpeed);
+}
+
+bool RhythmEngine::AcquireSnapshot() {
+	return m_snapshots.Swap();
+}
 
+const GameSnapshot& RhythmEngine::GetSnapshot() const {
+	return m_snapshots.Read();
+}
+
+void RhythmEngine::PublishSnapshot(double delta) {
+	GameSnapshot& snapshot = m_snapshots.Write();
+
+	snapshot.Tick = ++m_tick;
+	snapshot.Timestamp = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	snapshot.StepTime = delta;
+
+	snapshot.State = m_state;
+	snapshot.AudioPosition = m_currentAudioPosition;
+	snapshot.PreviousTrackPosition = m_tick > 1 ? m_lastTrackPosition : m_currentTrackPosition;
+	snapshot.TrackPosition = m_currentTrackPosition;
+	snapshot.NoteSpeed = GetNotespeed();
+	snapshot.PlayTime = m_PlayTime;
+
+	snapshot.Score = m_scoreManager->GetScore();
+	snapshot.Pills = m_scoreManager->GetPills();
+	snapshot.Life = m_scoreManager->GetLife();
+	snapshot.JamGauge = m_scoreManager->GetJamGauge();
+	snapshot.Events = m_scoreManager->GetEvents();
+
+	for (int i = 0; i < 7; i++) {
+		snapshot.Lanes[i] = m_lanes[i];
+	}
+
+	// Buffers are reused, clear() keeps the capacity from earlier steps.
+	snapshot.Notes.clear();
 	for (auto& it : m_tracks) {
-		it->Render(delta);
+		it->CollectSnapshot(snapshot.Notes);
+	}
+
+	snapshot.TimingLines.clear();
+	m_timingLineManager->CollectSnapshot(snapshot.TimingLines);
+
+	m_snapshots.Publish();
+	m_lastTrackPosition = m_currentTrackPosition;
+}
+
+void RhythmEngine::OnTrackEvent(GameTrackEvent e) {
+	auto& lane = m_lanes[e.Lane];
+
+	if (e.IsKeyEvent) {
+		lane.Pressed = e.State;
+	}
+	else if (e.IsHitEvent) {
+		if (e.IsHitLongEvent) {
+			lane.HoldEffect++;
+			lane.DrawHold = e.State;
+
+			if (!e.State) {
+				lane.HitEffect++;
+			}
+		}
+		else {
+			lane.HitEffect++;
+			lane.DrawHold = false;
+		}
+	}
+
+	if (m_eventCallback) {
+		m_eventCallback(e);
 	}
 }
 
 void RhythmEngine::Input(double delta) {
+	ProcessKeyEvents();
+
 	if (m_state == GameState::NotGame || m_state == GameState::PosGame) return;
 
 	// Autoplay updates
@@ -371,10 +470,12 @@ void RhythmEngine::OnKeyDown(const KeyState& state) {
 
 	if (state.key == Keys::F3) {
 		m_scrollSpeed -= 10;
+		ScheduleTimeline();
 		std::cout << "Decrease Note Speed" << std::endl;
 	}
 	else if (state.key == Keys::F4) {
 		m_scrollSpeed += 10;
+		ScheduleTimeline();
 		std::cout << "Increase Note Speed" << std::endl;
 	}
 
@@ -403,6 +504,35 @@ void RhythmEngine::OnKeyUp(const KeyState& state) {
 	}
 }
 
+// Called from the input thread, the event is judged by the next gameplay step.
+void RhythmEngine::QueueKeyEvent(const KeyState& state) {
+	if (!m_keyQueue.TryPush(state)) {
+		std::cout << "[RhythmEngine] Key queue is full, dropping key event" << std::endl;
+	}
+}
+
+void RhythmEngine::ProcessKeyEvents() {
+	KeyState state = {};
+
+	while (m_keyQueue.TryPop(state)) {
+		if (state.type == KeyEventType::KEY_DOWN) {
+			OnKeyDown(state);
+		}
+		else {
+			OnKeyUp(state);
+		}
+
+		if (state.time > 0) {
+			double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			double latency = (now - state.time) * 1000.0;
+
+			m_inputLatency.Count++;
+			m_inputLatency.Total += latency;
+			m_inputLatency.Max = (std::max)(m_inputLatency.Max, latency);
+		}
+	}
+}
+
 void RhythmEngine::ListenKeyEvent(std::function<void(GameTrackEvent)> callback) {
 	m_eventCallback = callback;
 }
@@ -488,6 +618,10 @@ ScoreManager* RhythmEngine::GetScoreManager() const {
 	return m_scoreManager;
 }
 
+InputLatency RhythmEngine::GetInputLatency() const {
+	return m_inputLatency;
+}
+
 std::vector<double> RhythmEngine::GetTimingWindow() {
 	float ratio = std::clamp(2.0f - m_currentSVMultiplier, 0.3f, 2.0f);
 	
@@ -518,46 +652,25 @@ void RhythmEngine::SetGuideLineIndex(int idx) {
 	m_guideLineIndex = idx;
 }
 
-void RhythmEngine::UpdateNotes() {
-	for (int i = m_currentNoteIndex; i < m_noteDescs.size(); i++) {
-		auto& desc = m_noteDescs[i];
-		
-		if (m_currentAudioGamePosition + (3000.0 / GetNotespeed()) > desc.StartTime
-			|| (m_currentTrackPosition - desc.InitialTrackPosition > GetPrebufferTiming())) {
-
-			m_tracks[desc.Lane]->AddNote(&desc);
-
-			m_currentNoteIndex += 1;
-		}
-		else {
-			break;
-		}
-	}
-}
-
 void RhythmEngine::UpdateGamePosition() {
-	m_currentAudioGamePosition = m_currentAudioPosition + m_offset;
-	m_currentVisualPosition = m_currentAudioGamePosition;// * m_rate;
+	// Keysounds run on the clock, the player hears them AudioOffset ms later, so
+	// hits are judged that much behind it. Notes are drawn at the judged time,
+	// moved ahead by VisualOffset for the display's own delay.
+	double clock = m_currentAudioPosition + m_offset;
+	m_currentAudioGamePosition = clock - m_audioOffset;
+	m_currentVisualPosition = clock;// * m_rate;
 
-	while (m_currentBPMIndex + 1 < m_currentChart->m_bpms.size() && m_currentVisualPosition >= m_currentChart->m_bpms[m_currentBPMIndex + 1].StartTime) {
-		m_currentBPMIndex += 1;
-	}
+	// Spawns notes and lines, plays keysounds and applies bpm/sv changes due by now
+	m_timeline.Advance(m_currentVisualPosition);
+	GameAudioSampleCache::Update(m_currentVisualPosition);
 
-	while (m_currentSVIndex < m_currentChart->m_svs.size() && m_currentVisualPosition >= m_currentChart->m_svs[m_currentSVIndex].StartTime) {
-		m_currentSVIndex += 1;
+	double shift = m_visualOffset - m_audioOffset;
+	if (shift == 0) {
+		m_currentTrackPosition = GetPositionFromOffset(m_currentVisualPosition, m_currentSVIndex);
 	}
-
-	m_currentTrackPosition = GetPositionFromOffset(m_currentVisualPosition, m_currentSVIndex);
-
-	if (m_currentSVIndex > 0) {
-		float svMultiplier = m_currentChart->m_svs[m_currentSVIndex - 1].Value;
-		if (svMultiplier != m_currentSVMultiplier) {
-			m_currentSVMultiplier = svMultiplier;
-		}
-	}
-
-	if (m_currentBPMIndex > 0) {
-		m_currentBPM = m_currentChart->m_bpms[m_currentBPMIndex - 1].Value;
+	else {
+		/* the shifted time can sit in a different sv segment than the clock */
+		m_currentTrackPosition = GetPositionFromOffset(m_currentVisualPosition + shift);
 	}
 }
 
@@ -590,6 +703,85 @@ void RhythmEngine::CreateTimingMarkers() {
 	}
 }
 
+void RhythmEngine::BuildTimeline(Chart* chart) {
+	m_timeline.Clear();
+
+	for (int i = 0; i < m_noteDescs.size(); i++) {
+		m_timeline.Add(TimelineEventType::NOTE_SPAWN, i, m_noteDescs[i].StartTime, m_noteDescs[i].InitialTrackPosition);
+	}
+
+	for (int i = 0; i < m_autoSamples.size(); i++) {
+		m_timeline.Add(TimelineEventType::KEYSOUND, i, m_autoSamples[i].StartTime);
+	}
+
+	for (int i = 0; i < chart->m_bpms.size(); i++) {
+		m_timeline.Add(TimelineEventType::BPM_CHANGE, i, chart->m_bpms[i].StartTime);
+	}
+
+	for (int i = 0; i < chart->m_svs.size(); i++) {
+		m_timeline.Add(TimelineEventType::SV_CHANGE, i, chart->m_svs[i].StartTime);
+	}
+
+	// Lines are generated when the window reaches them rather than all at load
+	m_timeline.AddSource(TimelineEventType::MEASURE_LINE, [this](TimelineEvent& e) {
+		return m_timingLineManager->NextLine(e.Time, e.Position);
+	}, [this] {
+		m_timingLineManager->ResetLines();
+	});
+
+	m_timeline.Subscribe(TimelineEventType::NOTE_SPAWN, [this](const TimelineEvent& e) {
+		auto& desc = m_noteDescs[e.Index];
+		m_tracks[desc.Lane]->AddNote(&desc);
+	});
+
+	m_timeline.Subscribe(TimelineEventType::KEYSOUND, [this](const TimelineEvent& e) {
+		auto& sample = m_autoSamples[e.Index];
+		GameAudioSampleCache::Schedule(sample.Index, sample.StartTime, sample.Volume * m_audioVolume * m_replayGain, sample.Pan * 100);
+	});
+
+	m_timeline.Subscribe(TimelineEventType::BPM_CHANGE, [this](const TimelineEvent& e) {
+		m_currentBPMIndex = e.Index;
+		m_currentBPM = m_currentChart->m_bpms[e.Index].Value;
+	});
+
+	m_timeline.Subscribe(TimelineEventType::SV_CHANGE, [this](const TimelineEvent& e) {
+		m_currentSVIndex = e.Index + 1;
+		m_currentSVMultiplier = m_currentChart->m_svs[e.Index].Value;
+	});
+
+	m_timeline.Subscribe(TimelineEventType::MEASURE_LINE, [this](const TimelineEvent& e) {
+		m_timingLineManager->Spawn(e.Time, e.Position);
+	});
+
+	ScheduleTimeline();
+}
+
+// Notes and lines are dispatched once they enter the prebuffer window, which
+// depends on the note speed, so this runs again whenever the speed changes.
+void RhythmEngine::ScheduleTimeline() {
+	double lead = 3000.0 / GetNotespeed();
+	double range = -GetPrebufferTiming();
+
+	/* notes drawn ahead of the clock by the offsets have to spawn that much earlier */
+	double shift = (std::max)(m_visualOffset - m_audioOffset, 0);
+
+	m_timeline.Schedule([this, lead, range, shift](const TimelineEvent& e) {
+		switch (e.Type) {
+			case TimelineEventType::NOTE_SPAWN:
+				return (std::min)(e.Time - lead, GetOffsetFromPosition(e.Position - range)) - shift;
+
+			case TimelineEventType::MEASURE_LINE:
+				return GetOffsetFromPosition(e.Position - range) - shift;
+
+			case TimelineEventType::KEYSOUND:
+				return e.Time - kAutoSampleLookahead;
+
+			default:
+				return e.Time;
+		}
+	});
+}
+
 double RhythmEngine::GetPositionFromOffset(double offset) {
 	int index;
 
@@ -615,6 +807,27 @@ double RhythmEngine::GetPositionFromOffset(double offset, int index) {
 	return pos;
 }
 
+// Inverse of GetPositionFromOffset, expects the track position to only move forward
+double RhythmEngine::GetOffsetFromPosition(double position) {
+	auto it = std::upper_bound(m_timingPositionMarkers.begin(), m_timingPositionMarkers.end(), position);
+	int index = static_cast<int>(it - m_timingPositionMarkers.begin());
+
+	if (index == 0) {
+		double multiplier = m_currentChart->InitialSvMultiplier * 100;
+		return multiplier > 0 ? position / multiplier : 0;
+	}
+
+	index -= 1;
+
+	auto& sv = m_currentChart->m_svs[index];
+	double multiplier = sv.Value * 100;
+	if (multiplier <= 0) {
+		return sv.StartTime;
+	}
+
+	return sv.StartTime + (position - m_timingPositionMarkers[index]) / multiplier;
+}
+
 int* RhythmEngine::GetLaneSizes() const {
 	return (int*)&m_laneSize;
 }
@@ -653,6 +866,7 @@ void RhythmEngine::Release() {
 	}
 
 	delete m_timingLineManager;
+	delete m_noteRenderer;
 	NoteImageCacheManager::Release();
 	GameAudioSampleCache::StopAll();
 }
@@ -6,14 +6,20 @@
 #include "../Data/AutoReplay.hpp"
 #include "GameTrack.hpp"
 #include "TimingLineManager.hpp"
+#include "ChartTimeline.hpp"
 #include "ScoreManager.hpp"
-
-enum class GameState {
-	PreParing,
-	NotGame,
-	PreGame,
-	Playing,
-	PosGame
+#include "GameSnapshot.hpp"
+#include "NoteRenderer.hpp"
+#include "../../Engine/Threading/TripleBuffer.hpp"
+#include "../../Engine/Threading/SpscQueue.hpp"
+
+constexpr int kKeyQueueSize = 256;
+
+// Time from a key event leaving the OS queue to the gameplay step judging it
+struct InputLatency {
+	int Count = 0;
+	double Total = 0;
+	double Max = 0;
 };
 
 class RhythmEngine {
@@ -32,8 +38,12 @@ public:
 	void Render(double delta);
 	void Input(double delta);
 
+	bool AcquireSnapshot();
+	const GameSnapshot& GetSnapshot() const;
+
 	void OnKeyDown(const KeyState& key);
 	void OnKeyUp(const KeyState& key);
+	void QueueKeyEvent(const KeyState& key);
 
 	void ListenKeyEvent(std::function<void(GameTrackEvent)> callback);
 
@@ -51,6 +61,7 @@ public:
 
 	double GetPositionFromOffset(double offset);
 	double GetPositionFromOffset(double offset, int index);
+	double GetOffsetFromPosition(double position);
 
 	int* GetLaneSizes() const;
 	int* GetLanePos() const;
@@ -64,6 +75,7 @@ public:
 	
 	GameState GetState() const;
 	ScoreManager* GetScoreManager() const;
+	InputLatency GetInputLatency() const;
 	std::vector<double> GetTimingWindow();
 	std::vector<TimingInfo> GetBPMs() const;
 	std::vector<TimingInfo> GetSVs() const;
@@ -75,10 +87,14 @@ public:
 	void SetGuideLineIndex(int idx);
 
 private:
-	void UpdateNotes();
 	void UpdateGamePosition();
 	void UpdateVirtualResolution();
 	void CreateTimingMarkers();
+	void BuildTimeline(Chart* chart);
+	void ScheduleTimeline();
+	void PublishSnapshot(double delta);
+	void OnTrackEvent(GameTrackEvent e);
+	void ProcessKeyEvents();
 
 	void Release();
 
@@ -90,8 +106,6 @@ private:
 	float m_baseBPM, m_currentBPM;
 	float m_currentSVMultiplier;
 
-	int m_currentSampleIndex = 0;
-	int m_currentNoteIndex = 0;
 	int m_currentBPMIndex = 0;
 	int m_currentSVIndex = 0;
 	int m_scrollSpeed = 0;
@@ -99,7 +113,9 @@ private:
 	int m_hitPosition = 0;
 	int m_laneOffset = 0;
 	int m_audioVolume = 100;
+	float m_replayGain = 1.0f;
 	int m_audioOffset = 0;
+	int m_visualOffset = 0;
 
 	int m_guideLineIndex = 0;
 
@@ -123,11 +139,25 @@ private:
 	std::unordered_map<int, int> m_autoHitIndex;
 	std::unordered_map<int, std::vector<ReplayHitInfo>> m_autoHitInfos;
 
+	/* note spawns, keysounds, bpm/sv changes and measure lines in dispatch order */
+	ChartTimeline m_timeline;
+
 	/* clock system */
 	int m_PlayTime;
 	std::chrono::system_clock::time_point m_startClock;
 
+	/* input thread -> gameplay thread handoff */
+	SpscQueue<KeyState> m_keyQueue{ kKeyQueueSize };
+	InputLatency m_inputLatency;
+
+	/* gameplay thread -> render thread handoff */
+	TripleBuffer<GameSnapshot> m_snapshots;
+	uint64_t m_tick = 0;
+	double m_lastTrackPosition = 0;
+	LaneSnapshot m_lanes[7];
+
 	ScoreManager* m_scoreManager;
 	TimingLineManager* m_timingLineManager;
+	NoteRenderer* m_noteRenderer;
 	std::function<void(GameTrackEvent)> m_eventCallback;
 };
\ No newline at end of file
@@ -30,6 +30,10 @@ ScoreManager::~ScoreManager() {
 }
 
 void ScoreManager::OnHit(NoteHitInfo info) {
+    if (info.Timed) {
+        m_statistics.Record(info.Lane, info.HitTime, info.Offset);
+    }
+
     switch (info.Result) {
 
     case NoteResult::COOL: {
@@ -108,17 +112,21 @@ void ScoreManager::OnHit(NoteHitInfo info) {
         m_jamGauge = 0;
         m_jamCombo += 1;
         m_maxJamCombo = std::max(m_maxJamCombo, m_jamCombo);
+        m_events.Jam++;
 
         if (m_jamCallback) {
             m_jamCallback(m_jamCombo);
         }
     }
 
-    if (m_callback) {
-        if (info.Result == NoteResult::MISS && m_life == 0) {
-            return;
-        }
+    if (info.Result == NoteResult::MISS && m_life == 0) {
+        return;
+    }
+
+    m_events.Hit++;
+    m_events.HitResult = info.Result;
 
+    if (m_callback) {
         m_callback(info);
     }
 }
@@ -137,6 +145,7 @@ void ScoreManager::OnLongNoteHold(HoldResult result) {
 	}
 
 	m_lnMaxCombo = (std::max)(m_lnCombo, m_lnMaxCombo);
+	m_events.LongNote++;
 
 	if (m_lncallback) {
 		m_lncallback();
@@ -167,6 +176,14 @@ int ScoreManager::GetJamGauge() const {
 	return m_jamGauge;
 }
 
+ScoreEvents ScoreManager::GetEvents() const {
+	return m_events;
+}
+
+const HitStatistics& ScoreManager::GetStatistics() const {
+	return m_statistics;
+}
+
 std::tuple<int, int, int, int, int, int, int, int, int, int, int> ScoreManager::GetScore() const {
 	return { m_score, m_cool, m_good, m_bad, m_miss, m_jamCombo, m_maxJamCombo, m_combo, m_maxCombo, m_lnCombo, m_lnMaxCombo };
 }
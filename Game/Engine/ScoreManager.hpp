@@ -1,5 +1,7 @@
 #pragma once
 #include "NoteResult.hpp"
+#include "HitStatistics.hpp"
+#include <cstdint>
 #include <functional>
 
 constexpr int kMaxJamGauge = 100;
@@ -11,6 +13,22 @@ struct NoteHitInfo {
 	bool IsRelease;
 	bool Ignore;
 	int Type;
+
+	/* judged key hits only, deadline misses carry no timing */
+	double HitTime = 0;
+	double Offset = 0;
+	bool Timed = false;
+
+	int Lane = -1;
+};
+
+// Running counters of the events the listeners get, a renderer on another
+// thread compares these against the last values it saw to start effects.
+struct ScoreEvents {
+	uint32_t Hit = 0;
+	NoteResult HitResult = NoteResult::MISS;
+	uint32_t Jam = 0;
+	uint32_t LongNote = 0;
 };
 
 class ScoreManager {
@@ -27,6 +45,8 @@ public:
 	int GetPills() const;
 	int GetLife() const;
 	int GetJamGauge() const;
+	ScoreEvents GetEvents() const;
+	const HitStatistics& GetStatistics() const;
 	std::tuple<int, int, int, int, int, int, int, int, int, int, int> GetScore() const;
 private:
 	void AddLife(int sz);
@@ -50,6 +70,9 @@ private:
 	int m_lnCombo;
 	int m_lnMaxCombo;
 
+	ScoreEvents m_events;
+	HitStatistics m_statistics;
+
 	std::function<void(NoteHitInfo)> m_callback;
 	std::function<void()> m_lncallback;
 	std::function<void(int)> m_jamCallback;
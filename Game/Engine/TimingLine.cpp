@@ -1,14 +1,7 @@
 #include "TimingLine.hpp"
 #include "RhythmEngine.hpp"
 
-namespace {
-	double CalculateLinePosition(double trackOffset, double offset, double noteSpeed, bool upscroll = false) {
-		return trackOffset + (offset * (upscroll ? -noteSpeed : noteSpeed) / 100.0);
-	}
-}
-
 TimingLine::TimingLine() {
-	m_line = new ResizableImage(198, 1, 0xFF);
 	m_engine = nullptr;
 }
 
@@ -42,24 +35,6 @@ double TimingLine::GetTrackPosition() const {
 	return m_currentTrackPosition;
 }
 
-void TimingLine::Render(double delta) {
-	auto resolution = m_engine->GetResolution();
-	auto hitPos = m_engine->GetHitPosition();
-	auto playRect = m_engine->GetPlayRectangle();
-	
-	double alpha = CalculateLinePosition(1000.0, m_currentTrackPosition, m_engine->GetNotespeed()) / 1000.0;
-
-	double min = 0, max = hitPos;
-	double pos_y = min + (max - min) * alpha;
-
-	m_line->Size = UDim2::fromOffset(m_imageSize, 1);
-	m_line->Position = UDim2::fromOffset(m_imagePos, pos_y); //+ start.Lerp(end, alpha);
-
-	if (m_line->Position.Y.Offset >= 0 && m_line->Position.Y.Offset < hitPos + 10) {
-		m_line->Draw(&playRect);
-	}
-}
-
 void TimingLine::Release() {
-	delete m_line;
+	m_engine = nullptr;
 }
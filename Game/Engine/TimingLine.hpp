@@ -1,5 +1,4 @@
 #pragma once
-class ResizableImage;
 class RhythmEngine;
 
 struct TimingLineDesc {
@@ -19,7 +18,6 @@ public:
 	void Load(TimingLineDesc* timing);
 
 	void Update(double delta);
-	void Render(double delta);
 
 	double GetOffset() const;
 	double GetStartTime() const;
@@ -30,6 +28,5 @@ private:
 	double m_startTime, m_offset, m_currentTrackPosition;
 	int m_imagePos, m_imageSize;
 
-	ResizableImage* m_line;
 	RhythmEngine* m_engine;
 };
\ No newline at end of file
@@ -1,137 +1,189 @@
 #include "TimingLineManager.hpp"
 #include "RhythmEngine.hpp"
+#include <algorithm>
 
-TimingLineManager::TimingLineManager(RhythmEngine* engine) {
+namespace {
+	double CalculateLinePosition(double trackOffset, double offset, double noteSpeed, bool upscroll = false) {
+		return trackOffset + (offset * (upscroll ? -noteSpeed : noteSpeed) / 100.0);
+	}
+}
+
+TimingLineManager::TimingLineManager(RhythmEngine* engine, Chart* chart) {
 	Rect playRect = engine->GetPlayRectangle();
 	m_engine = engine;
-	m_timingLines = {};
-	m_timingInfos = {};
-
-	int mapLength = engine->GetAudioLength();
-	auto bpms = engine->GetBPMs();
-
-	for (int i = 0; i < bpms.size(); i++) {
-		double beatTime = bpms[i].StartTime;
-		double timeEnd = mapLength - 1;
-
-		if ((size_t)(i + 1) < bpms.size()) {
-			timeEnd = bpms[(size_t)(i + 1)].StartTime - 1;
-		}
-
-		while (beatTime < timeEnd) {
-			double offset = engine->GetPositionFromOffset(beatTime);
-			
-			TimingLineDesc desc = {};
-			desc.Engine = engine;
-			desc.StartTime = beatTime;
-			desc.Offset = offset;
-			desc.ImagePos = playRect.left;
-			desc.ImageSize = playRect.right;
+	m_chart = chart;
 
-			m_timingInfos.push(desc);
+	m_line = new ResizableImage(198, 1, 0xFF);
+	m_imagePos = playRect.left;
+	m_imageSize = playRect.right;
 
-			beatTime += (60000.0 / bpms[i].Value) * bpms[i].TimeSignature;
-		}
+	m_linePool.resize(kTimingLinePoolSize);
+	m_lineRing.resize(kTimingLinePoolSize, -1);
+	for (int i = 0; i < kTimingLinePoolSize; i++) {
+		m_freeLines.push_back(kTimingLinePoolSize - 1 - i);
 	}
-}
 
-TimingLineManager::TimingLineManager(RhythmEngine* engine, std::vector<double> list) {
-	Rect playRect = engine->GetPlayRectangle();
+	m_ringHead = 0;
+	m_ringCount = 0;
 
-	m_engine = engine;
-	m_timingLines = {};
-	m_timingInfos = {};
-
-	for (int i = 0; i < list.size(); i++) {
-		double offset = m_engine->GetPositionFromOffset(list[i]);
-
-		TimingLineDesc desc = {};
-		desc.Engine = engine;
-		desc.StartTime = list[i];
-		desc.Offset = offset;
-		desc.ImagePos = playRect.left;
-		desc.ImageSize = playRect.right;
-		
-		m_timingInfos.push(desc);
+	m_useMeasures = chart->m_customMeasures.size() > 0;
+	if (m_useMeasures) {
+		m_measures = chart->m_customMeasures;
+		std::sort(m_measures.begin(), m_measures.end());
 	}
+
+	ResetLines();
 }
 
 TimingLineManager::~TimingLineManager() {
-	for (int i = 0; i < m_timingInfos.size(); i++) {
-		m_timingInfos.pop();
-	}
+	m_linePool.clear();
+	m_freeLines.clear();
 
-	for (int i = 0; i < m_timingLines.size(); i++) {
-		delete m_timingLines.front();
-		m_timingLines.pop();
-	}
+	delete m_line;
 }
 
-void TimingLineManager::Init() {
-	double recycle = (300000.0 / 4.0) / m_engine->GetNotespeed();
+void TimingLineManager::Update(double delta) {
+	double recycle = (300000.0 / 4) / m_engine->GetNotespeed();
 
-	std::sort(m_timingInfos.begin(), m_timingInfos.end(), [](const auto& a, const auto& b) {
-		return a.Offset < b.Offset;
-	});
+	for (int i = 0; i < m_ringCount; i++) {
+		m_linePool[m_lineRing[(m_ringHead + i) & (static_cast<int>(m_lineRing.size()) - 1)]].Update(delta);
+	}
 
-	while (m_timingInfos.size() > 0) {
-		auto& info = m_timingInfos.front();
+	while (m_ringCount > 0) {
+		TimingLine& line = m_linePool[m_lineRing[m_ringHead]];
 
-		bool IsA = m_engine->GetTrackPosition() - info.Offset > m_engine->GetPrebufferTiming();
-		
-		if (IsA) {
-			TimingLine* t = new TimingLine();
-			t->Load(&info);
-			
-			m_timingLines.push(t);
-			m_timingInfos.pop();
-		}
-		else {
+		if (line.GetTrackPosition() <= recycle || line.GetStartTime() >= m_engine->GetGameAudioPosition()) {
 			break;
 		}
+
+		RecycleFront();
 	}
 }
 
-void TimingLineManager::Update(double delta) {
-	double recycle = (300000.0 / 4) / m_engine->GetNotespeed();
+void TimingLineManager::Spawn(double startTime, double offset) {
+	/* every line is still on screen, recycling one would make it vanish */
+	if (m_freeLines.empty()) {
+		GrowPool();
+	}
 
-	if (m_timingLines.size() > 0) {
-		for (auto it = m_timingLines.begin(); it != m_timingLines.end(); it++) {
-			(*it)->Update(delta);
-		}
+	TimingLineDesc desc = {};
+	desc.Engine = m_engine;
+	desc.StartTime = startTime;
+	desc.Offset = offset;
+	desc.ImagePos = m_imagePos;
+	desc.ImageSize = m_imageSize;
+
+	int index = m_freeLines.back();
+	m_freeLines.pop_back();
+
+	m_linePool[index].Load(&desc);
+	m_lineRing[(m_ringHead + m_ringCount) & (static_cast<int>(m_lineRing.size()) - 1)] = index;
+	m_ringCount++;
+}
+
+void TimingLineManager::RecycleFront() {
+	int index = m_lineRing[m_ringHead];
+
+	m_linePool[index].Release();
+	m_freeLines.push_back(index);
+	m_lineRing[m_ringHead] = -1;
+	m_ringHead = (m_ringHead + 1) & (static_cast<int>(m_lineRing.size()) - 1);
+	m_ringCount--;
+}
+
+void TimingLineManager::GrowPool() {
+	int size = static_cast<int>(m_linePool.size());
+
+	// Unwrap the ring into the front of the bigger one, the new lines go free
+	std::vector<int> ring(size * 2, -1);
+	for (int i = 0; i < m_ringCount; i++) {
+		ring[i] = m_lineRing[(m_ringHead + i) & (size - 1)];
 	}
 
-	while (m_timingLines.size() > 0
-		&& m_timingLines.front()->GetTrackPosition() > recycle
-		&& m_timingLines.front()->GetStartTime() < m_engine->GetGameAudioPosition()) {
-		TimingLine* t = m_timingLines.front();
-		m_timingLines.pop();
+	m_lineRing.swap(ring);
+	m_ringHead = 0;
 
-		if (m_timingInfos.size() > 0) {
-			TimingLineDesc desc = m_timingInfos.front();
-			m_timingInfos.pop();
+	m_linePool.resize(size * 2);
+	for (int i = size * 2 - 1; i >= size; i--) {
+		m_freeLines.push_back(i);
+	}
+}
 
-			t->Load(&desc);
-			m_timingLines.push(t);
+bool TimingLineManager::NextLine(double& time, double& position) {
+	if (m_useMeasures) {
+		if (m_sourceIndex >= m_measures.size()) {
+			return false;
 		}
-		else {
-			delete t;
+
+		time = m_measures[m_sourceIndex++];
+	}
+	else {
+		auto& bpms = m_chart->m_bpms;
+
+		while (true) {
+			if (m_sourceIndex >= bpms.size()) {
+				return false;
+			}
+
+			auto& bpm = bpms[m_sourceIndex];
+			double timeEnd = m_engine->GetAudioLength() - 1;
+
+			if (m_sourceIndex + 1 < bpms.size()) {
+				timeEnd = bpms[m_sourceIndex + 1].StartTime - 1;
+			}
+
+			/* a zero or negative bpm would never reach the segment end, it gets no lines */
+			double step = (60000.0 / bpm.Value) * bpm.TimeSignature;
+			if (step > 0 && m_beatTime < timeEnd) {
+				time = m_beatTime;
+				m_beatTime += step;
+				break;
+			}
+
+			m_sourceIndex++;
+			if (m_sourceIndex < bpms.size()) {
+				m_beatTime = bpms[m_sourceIndex].StartTime;
+			}
 		}
 	}
 
-	while (m_timingInfos.size() > 0 
-		&& m_engine->GetTrackPosition() - m_timingInfos.front().Offset > m_engine->GetPrebufferTiming()) {
-		TimingLine* t = new TimingLine();
-		t->Load(&m_timingInfos.front());
-		m_timingLines.push(t);
-		m_timingInfos.pop();
+	// Lines come in time order, track the sv segment instead of searching it per line
+	auto& svs = m_chart->m_svs;
+	while (m_svIndex < svs.size() && time >= svs[m_svIndex].StartTime) {
+		m_svIndex++;
 	}
+
+	position = m_engine->GetPositionFromOffset(time, static_cast<int>(m_svIndex));
+	return true;
+}
+
+void TimingLineManager::ResetLines() {
+	m_sourceIndex = 0;
+	m_svIndex = 0;
+	m_beatTime = m_chart->m_bpms.size() ? m_chart->m_bpms[0].StartTime : 0;
 }
 
-void TimingLineManager::Render(double delta) {
-	if (m_timingLines.size() > 0) {
-		for (auto it = m_timingLines.begin(); it != m_timingLines.end(); it++) {
-			(*it)->Render(delta);
+void TimingLineManager::CollectSnapshot(std::vector<double>& lines) {
+	for (int i = 0; i < m_ringCount; i++) {
+		lines.push_back(m_linePool[m_lineRing[(m_ringHead + i) & (static_cast<int>(m_lineRing.size()) - 1)]].GetOffset());
+	}
+}
+
+void TimingLineManager::Render(double delta, const std::vector<double>& lines, double trackPosition, double noteSpeed) {
+	auto hitPos = m_engine->GetHitPosition();
+	auto playRect = m_engine->GetPlayRectangle();
+
+	for (double offset : lines) {
+		double alpha = CalculateLinePosition(1000.0, trackPosition - offset, noteSpeed) / 1000.0;
+
+		double min = 0, max = hitPos;
+		double pos_y = min + (max - min) * alpha;
+
+		m_line->Size = UDim2::fromOffset(m_imageSize, 1);
+		m_line->Position = UDim2::fromOffset(m_imagePos, pos_y);
+
+		if (m_line->Position.Y.Offset >= 0 && m_line->Position.Y.Offset < hitPos + 10) {
+			m_line->Draw(&playRect);
 		}
 	}
 }
\ No newline at end of file
@@ -1,23 +1,51 @@
 #pragma once
 
 #include "TimingLine.hpp"
-#include "../Resources/iterable_queue.hpp"
+#include "../Data/Chart.hpp"
 #include <vector>
 
 class RhythmEngine;
+class ResizableImage;
+
+// Number of pooled line objects to start with, must be power of two. A chart
+// with more lines than this inside the lookahead window doubles the pool.
+constexpr int kTimingLinePoolSize = 64;
 
 class TimingLineManager {
 public:
-	TimingLineManager(RhythmEngine* engine);
-	TimingLineManager(RhythmEngine* engine, std::vector<double> list);
+	TimingLineManager(RhythmEngine* engine, Chart* chart);
 	~TimingLineManager();
 
-	void Init();
 	void Update(double delta);
-	void Render(double delta);
+	void Spawn(double startTime, double offset);
+	void CollectSnapshot(std::vector<double>& lines);
+	void Render(double delta, const std::vector<double>& lines, double trackPosition, double noteSpeed);
+
+	// Next measure line in time order, from the chart's custom measures or one
+	// per bar of the bpm list, false once the chart has no more lines
+	bool NextLine(double& time, double& position);
+	void ResetLines();
 
 private:
+	void RecycleFront();
+	void GrowPool();
+
 	RhythmEngine* m_engine;
-	iterable_queue<TimingLineDesc> m_timingInfos;
-	iterable_queue<TimingLine*> m_timingLines;
-};
\ No newline at end of file
+	Chart* m_chart;
+	ResizableImage* m_line;
+	int m_imagePos, m_imageSize;
+
+	/* live lines in spawn order, ring of pool indices */
+	std::vector<TimingLine> m_linePool;
+	std::vector<int> m_freeLines;
+	std::vector<int> m_lineRing;
+	int m_ringHead;
+	int m_ringCount;
+
+	/* line generator cursor, a bpm or custom measure index and the sv segment */
+	std::vector<double> m_measures;
+	bool m_useMeasures;
+	size_t m_sourceIndex;
+	size_t m_svIndex;
+	double m_beatTime;
+};
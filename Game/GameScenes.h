@@ -7,4 +7,8 @@ namespace GameScene {
 	constexpr int RESULT = 3;
 	constexpr int GAME = 4;
 	constexpr int EDITOR = 5;
+	constexpr int CALIBRATION = 6;
+
+	/* the main menu is the song select */
+	constexpr int SONGSELECT = MAINMENU;
 }
\ No newline at end of file
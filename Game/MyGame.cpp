@@ -17,6 +17,7 @@
 #include "./Scenes/IntroScene.hpp"
 #include "./Scenes/ResultScene.hpp"
 #include "./Scenes/EditorScene.hpp"
+#include "./Scenes/CalibrationScene.hpp"
 
 
 MyGame::~MyGame() {
@@ -69,6 +70,20 @@ bool MyGame::Init() {
 		}
 	}
 
+	{
+		auto value = Configuration::Load("Game", "FrameSlack");
+		if (value.size()) {
+			try {
+				SetFrameSlack(std::stod(value.c_str()));
+			}
+			catch (std::invalid_argument& e) {
+				std::cout << "Failed to parse Game.ini::Game::FrameSlack" << std::endl;
+			}
+		}
+	}
+
+	SetFrameStatsOverlay(Configuration::Load("Game", "FrameStats") == "1");
+
 	{
 		auto value = Configuration::Load("Game", "Skin");
 		if (!Configuration::Skin_Exist(value)) {
@@ -111,6 +126,7 @@ bool MyGame::Init() {
 		SceneManager::AddScene(GameScene::RESULT, new ResultScene());
 		SceneManager::AddScene(GameScene::GAME, new GameplayScene());
 		SceneManager::AddScene(GameScene::EDITOR, new EditorScene());
+		SceneManager::AddScene(GameScene::CALIBRATION, new CalibrationScene());
 
 		std::string title = "Unnamed O2 Clone (Beta 5)";
 		m_window->SetWindowTitle(title);
@@ -140,6 +156,10 @@ void MyGame::Update(double delta) {
 	m_sceneManager->Update(delta);
 }
 
+void MyGame::FixedUpdate(double delta) {
+	m_sceneManager->FixedUpdate(delta);
+}
+
 void MyGame::Render(double delta) {
 	m_sceneManager->Render(delta);
 }
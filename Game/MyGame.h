@@ -11,6 +11,7 @@ public:
 
 protected:
 	void Update(double deltaTime) override;
+	void FixedUpdate(double deltaTime) override;
 	void Render(double deltaTime) override;
 	void Input(double deltaTime) override;
 };
\ No newline at end of file
@@ -5,10 +5,26 @@ std::string defaultConfiguration = "[game]\n"
 	"skin = Default\n"
 	"audiopitch = 0\n"
 	"framelimit = 144\n"
+	"frameslack = 1\n"
+	"framestats = 0\n"
 	"fps = 5\n"
 	"audiooffset = 0\n"
+	"visualoffset = 0\n"
 	"audiovolume = 50\n"
 	"autosound = 1\n"
+	"keysoundvoices = 128\n"
+	"keysoundstealing = oldest\n"
+	"samplecachebudget = 512\n"
+	"pcmcachesize = 1024\n"
+	"tempocachesize = 1024\n"
+	"keysoundstorage = decoded\n"
+	"streamthreshold = 20\n"
+	"progressiveload = 1\n"
+	"loadaheadtime = 10\n"
+	"trimkeysounds = 0\n"
+	"previewlength = 20\n"
+	"previewprebuild = 1\n"
+	"replaygain = 1\n"
 	"resolution = 1280x960\n"
 	"renderer = 0\n"
 	"guideline = 2\n\n"
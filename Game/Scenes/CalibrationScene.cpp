@@ -0,0 +1,272 @@
+#include "CalibrationScene.hpp"
+#include "../../Engine/Imgui/ImGui.h"
+#include "../../Engine/Imgui/ImguiUtil.hpp"
+#include "../../Engine/Configuration.hpp"
+#include "../../Engine/SceneManager.hpp"
+#include "../../Engine/SoftwareMixer.hpp"
+#include "../../Engine/MixerSink.hpp"
+#include "../../Engine/MathUtils.hpp"
+#include "../../Engine/Window.hpp"
+#include "../../Engine/Keys.h"
+#include "../GameScenes.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+	// Metronome click, in ms and Hz, the first beat of every bar is higher
+	constexpr double kClickLength = 40.0;
+	constexpr double kClickFrequency = 1000.0;
+	constexpr double kAccentFrequency = 1500.0;
+
+	// How long the visual phase keeps the box lit after each beat, in ms
+	constexpr double kFlashLength = 80.0;
+
+	std::vector<float> CreateClick(int rate, double frequency) {
+		std::vector<float> pcm(static_cast<size_t>(rate * kClickLength / 1000.0));
+
+		for (size_t i = 0; i < pcm.size(); i++) {
+			double time = static_cast<double>(i) / rate;
+			pcm[i] = static_cast<float>(std::sin(2.0 * 3.14159265358979323846 * frequency * time) * std::exp(-time * 80.0) * 0.8);
+		}
+
+		return pcm;
+	}
+
+	void DrawResult(const char* name, const CalibrationResult& result) {
+		if (!result.Valid) {
+			ImGui::Text("%s: not enough steady taps (%d kept of %d)", name, result.Used, result.Taps);
+			return;
+		}
+
+		ImGui::Text("%s: %+.0f ms (median %+.0f ms, deviation %.1f ms, %d kept of %d taps)",
+			name, result.Mean, result.Median, result.StdDev, result.Used, result.Taps);
+	}
+}
+
+CalibrationScene::CalibrationScene() {
+	m_phase = CalibrationPhase::INTRO;
+	m_phaseStart = 0;
+	m_clickBuffer = -1;
+	m_accentBuffer = -1;
+	m_backButton = false;
+	m_saved = false;
+}
+
+double CalibrationScene::GetTime() {
+	/* same clock as KeyState::time */
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CalibrationScene::StartPhase(CalibrationPhase phase) {
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_phase = phase;
+
+	if (phase != CalibrationPhase::AUDIO && phase != CalibrationPhase::VISUAL) {
+		return;
+	}
+
+	// The clock and the mixer position are read together, a beat `at` ms from
+	// now is the frame that many ms past the current one.
+	double now = GetTime();
+	uint64_t frame = m_mixer ? m_mixer->GetRenderedFrames() : 0;
+
+	m_phaseStart = now + kCalibrationLead + kCalibrationWarmupBeats * kCalibrationInterval;
+	m_calibration.SetBeats(m_phaseStart, kCalibrationInterval, kCalibrationBeats);
+
+	if (phase != CalibrationPhase::AUDIO || !m_sink) {
+		return;
+	}
+
+	double rate = m_mixer->GetSampleRate();
+	for (int i = 0; i < kCalibrationWarmupBeats + kCalibrationBeats; i++) {
+		double at = kCalibrationLead + i * kCalibrationInterval;
+		int buffer = i % 4 == 0 ? m_accentBuffer : m_clickBuffer;
+
+		m_mixer->PlayAt(frame + static_cast<uint64_t>(at / 1000.0 * rate + 0.5), buffer, 1.0f);
+	}
+}
+
+void CalibrationScene::SaveOffsets() {
+	if (m_audioResult.Valid) {
+		Configuration::Set("Game", "AudioOffset", std::to_string(std::lround(m_audioResult.Mean)));
+	}
+
+	if (m_visualResult.Valid) {
+		Configuration::Set("Game", "VisualOffset", std::to_string(std::lround(m_visualResult.Mean)));
+	}
+
+	std::cout << "[Calibration] Audio offset " << m_audioResult.Mean << " ms, visual offset " << m_visualResult.Mean << " ms" << std::endl;
+	m_saved = true;
+}
+
+void CalibrationScene::Render(double delta) {
+	ImguiUtil::NewFrame();
+
+	ImGui::SetNextWindowPos(ImVec2(0, 0));
+	auto window = Window::GetInstance();
+
+	auto windowNextSz = ImVec2(window->GetBufferWidth(), window->GetBufferHeight());
+	ImGui::SetNextWindowSize(MathUtil::ScaleVec2(windowNextSz));
+
+	double now = GetTime();
+	bool audio = m_phase == CalibrationPhase::AUDIO;
+
+	/* a phase ends half a beat after its last beat, late taps still count */
+	double phaseEnd = m_phaseStart + (kCalibrationBeats - 0.5) * kCalibrationInterval;
+	if ((audio || m_phase == CalibrationPhase::VISUAL) && now > phaseEnd) {
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			(audio ? m_audioResult : m_visualResult) = m_calibration.GetResult();
+		}
+
+		StartPhase(audio ? CalibrationPhase::VISUAL : CalibrationPhase::DONE);
+		audio = false;
+	}
+
+	if (ImGui::Begin("#CalibrationWindow",
+		nullptr,
+		ImGuiWindowFlags_NoTitleBar
+		| ImGuiWindowFlags_NoResize
+		| ImGuiWindowFlags_NoMove
+		| ImGuiWindowFlags_NoScrollbar
+		| ImGuiWindowFlags_NoScrollWithMouse
+		| ImGuiWindowFlags_MenuBar
+	)) {
+		if (ImGui::BeginMenuBar()) {
+			if (ImGui::Button("Back", MathUtil::ScaleVec2(ImVec2(50, 0)))) {
+				m_backButton = true;
+			}
+
+			ImGui::Text("Offset calibration");
+			ImGui::EndMenuBar();
+		}
+
+		switch (m_phase) {
+			case CalibrationPhase::INTRO: {
+				ImGui::TextWrapped("Tap any key in time with the metronome, then with the flashing box. The first %d beats of each part are not counted.", kCalibrationWarmupBeats);
+				ImGui::TextWrapped("Tap to what you hear and see, not ahead of it.");
+
+				if (!m_sink) {
+					ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "The keysound mixer failed to start, only the visual offset can be measured.");
+				}
+
+				ImGui::NewLine();
+				if (ImGui::Button("Start", MathUtil::ScaleVec2(ImVec2(100, 0)))) {
+					m_audioResult = {};
+					m_visualResult = {};
+					m_saved = false;
+
+					StartPhase(m_sink ? CalibrationPhase::AUDIO : CalibrationPhase::VISUAL);
+				}
+				break;
+			}
+
+			case CalibrationPhase::AUDIO:
+			case CalibrationPhase::VISUAL: {
+				int beat = static_cast<int>(std::floor((now - m_phaseStart) / kCalibrationInterval));
+
+				ImGui::Text(audio ? "Tap with the metronome" : "Tap when the box lights up");
+				if (beat < 0) {
+					ImGui::Text("Get ready...");
+				}
+				else {
+					ImGui::Text("Beat %d / %d", (std::min)(beat + 1, kCalibrationBeats), kCalibrationBeats);
+				}
+
+				/* the audio phase shows nothing that moves with the beat so it can't be followed instead */
+				if (!audio) {
+					double first = m_phaseStart - kCalibrationWarmupBeats * kCalibrationInterval;
+					double since = std::fmod(now - first, kCalibrationInterval);
+					bool lit = now >= first && since < kFlashLength;
+
+					ImVec2 pos = ImGui::GetCursorScreenPos();
+					ImVec2 size = MathUtil::ScaleVec2(ImVec2(200, 200));
+
+					auto drawList = ImGui::GetWindowDrawList();
+					drawList->AddRectFilled(pos, ImVec2(pos.x + size.x, pos.y + size.y), lit ? ImColor(255, 255, 255) : ImColor(40, 40, 40));
+				}
+				break;
+			}
+
+			case CalibrationPhase::DONE: {
+				DrawResult("Audio offset", m_audioResult);
+				DrawResult("Visual offset", m_visualResult);
+
+				ImGui::NewLine();
+				ImGui::TextWrapped("Positive values mean you hear or see the game that much late, gameplay shifts judgement and notes to match.");
+
+				ImGui::NewLine();
+				if (m_audioResult.Valid || m_visualResult.Valid) {
+					if (ImGui::Button(m_saved ? "Saved###Save" : "Save###Save", MathUtil::ScaleVec2(ImVec2(100, 0))) && !m_saved) {
+						SaveOffsets();
+					}
+
+					ImGui::SameLine();
+				}
+
+				if (ImGui::Button("Retry", MathUtil::ScaleVec2(ImVec2(100, 0)))) {
+					StartPhase(CalibrationPhase::INTRO);
+				}
+				break;
+			}
+		}
+
+		ImGui::End();
+	}
+
+	if (m_backButton) {
+		m_backButton = false;
+
+		SceneManager::DisplayFade(100, [] {
+			SceneManager::ChangeScene(GameScene::SONGSELECT);
+		});
+	}
+}
+
+void CalibrationScene::OnKeyDown(const KeyState& state) {
+	if (state.key == Keys::EscapeK) {
+		m_backButton = true;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	if (m_phase != CalibrationPhase::AUDIO && m_phase != CalibrationPhase::VISUAL) {
+		return;
+	}
+
+	m_calibration.AddTap(state.time > 0 ? state.time * 1000.0 : GetTime());
+}
+
+bool CalibrationScene::Attach() {
+	SceneManager::DisplayFade(0, [] {});
+
+	m_phase = CalibrationPhase::INTRO;
+	m_audioResult = {};
+	m_visualResult = {};
+	m_backButton = false;
+	m_saved = false;
+
+	// Clicks go through the same mixer and sink as autoplay keysounds, so
+	// the measured latency is the one gameplay has.
+	m_mixer = std::make_unique<SoftwareMixer>();
+	m_clickBuffer = m_mixer->AddBuffer(CreateClick(m_mixer->GetSampleRate(), kClickFrequency), 1, m_mixer->GetSampleRate());
+	m_accentBuffer = m_mixer->AddBuffer(CreateClick(m_mixer->GetSampleRate(), kAccentFrequency), 1, m_mixer->GetSampleRate());
+
+	m_sink = std::make_unique<BassMixerSink>();
+	if (!m_sink->Start(m_mixer.get())) {
+		std::cout << "[Calibration] Failed to start the keysound mixer" << std::endl;
+		m_sink.reset();
+	}
+
+	return true;
+}
+
+bool CalibrationScene::Detach() {
+	m_sink.reset();
+	m_mixer.reset();
+
+	return true;
+}
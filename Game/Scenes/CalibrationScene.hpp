@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include "../../Engine/Scene.hpp"
+#include "../Engine/OffsetCalibration.hpp"
+
+class SoftwareMixer;
+class BassMixerSink;
+
+// Metronome of the calibration, in ms and beats per phase
+constexpr double kCalibrationInterval = 500.0;
+constexpr double kCalibrationLead = 1500.0;
+constexpr int kCalibrationWarmupBeats = 4;
+constexpr int kCalibrationBeats = 24;
+
+enum class CalibrationPhase {
+	INTRO,
+	AUDIO,
+	VISUAL,
+	DONE
+};
+
+/*
+ * Measures the player's audio and visual offsets. The audio phase plays a
+ * metronome through the keysound mixer, the visual phase flashes the screen
+ * without sound, and the player taps along to each. Taps use the input
+ * timestamps, beats are mapped from mixer frames to the same steady clock.
+ */
+class CalibrationScene : public Scene {
+public:
+	CalibrationScene();
+
+	void Render(double delta) override;
+	void OnKeyDown(const KeyState& state) override;
+
+	bool Attach() override;
+	bool Detach() override;
+
+private:
+	void StartPhase(CalibrationPhase phase);
+	void SaveOffsets();
+
+	static double GetTime();
+
+	std::mutex m_lock;
+	CalibrationPhase m_phase;
+
+	/* steady clock ms of the first counted beat */
+	double m_phaseStart;
+	OffsetCalibration m_calibration;
+
+	CalibrationResult m_audioResult;
+	CalibrationResult m_visualResult;
+
+	std::unique_ptr<SoftwareMixer> m_mixer;
+	std::unique_ptr<BassMixerSink> m_sink;
+	int m_clickBuffer;
+	int m_accentBuffer;
+
+	bool m_backButton;
+	bool m_saved;
+};
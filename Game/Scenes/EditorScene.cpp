@@ -932,8 +932,8 @@ void EditorScene::LoadDifficulty(int idx) {
 
 		bool result = AudioManager::GetInstance()->CreateSample(
 			std::to_string(file.RefValue),
-			file.AudioData.data(),
-			file.AudioData.size(),
+			const_cast<uint8_t*>(file.AudioData->data()),
+			file.AudioData->size(),
 			&m_audio_sample[file.RefValue]);
 
 		if (!result) {
@@ -24,7 +24,6 @@ bool CheckSkinComponent(std::filesystem::path x) {
 GameplayScene::GameplayScene() : Scene::Scene() {
 	m_keyLighting = {};
 	m_keyButtons = {};
-	m_keyState = {};
 	m_game = nullptr;
 	m_drawJam = false;
 	m_wiggleTime = 0;
@@ -49,13 +48,15 @@ void GameplayScene::Update(double delta) {
 		return;
 	}
 
-	if (!m_starting) {
-		m_starting = true;
-		m_game->Start();
-	}
+	m_game->AcquireSnapshot();
+	auto& snapshot = m_game->GetSnapshot();
+	ApplySnapshotEvents(snapshot);
 
-	if (m_game->GetState() == GameState::PosGame && !m_ended) {
+	if (snapshot.State == GameState::PosGame && !m_ended) {
 		m_ended = true;
+
+		// Only a chart played to the end is saved as a score
+		EnvironmentSetup::SetInt("Finished", 1);
 		SceneManager::DisplayFade(100, [] {
 			SceneManager::ChangeScene(GameScene::RESULT);
 			});
@@ -64,7 +65,7 @@ void GameplayScene::Update(double delta) {
 	if (m_doExit && !m_ended) {
 		m_ended = true;
 
-		auto scores = m_game->GetScoreManager()->GetScore();
+		auto& scores = snapshot.Score;
 
 		if (std::get<1>(scores) != 0 || std::get<2>(scores) != 0 || std::get<3>(scores) != 0 || std::get<4>(scores) != 0) {
 			SceneManager::DisplayFade(100, [] {
@@ -79,9 +80,69 @@ void GameplayScene::Update(double delta) {
 	}
 
 	m_exitButtonFunc->Input(delta);
+}
+
+void GameplayScene::FixedUpdate(double delta) {
+	if (m_resourceFucked) return;
+
+	if (!m_starting) {
+		m_starting = true;
+		m_game->Start();
+	}
+
+	m_game->Input(delta);
 	m_game->Update(delta);
 }
 
+// Effects used to be started from score/track callbacks, those now fire on
+// the gameplay thread so the counters in the snapshot are compared instead.
+void GameplayScene::ApplySnapshotEvents(const GameSnapshot& snapshot) {
+	auto& events = snapshot.Events;
+
+	if (events.Hit != m_seenEvents.Hit) {
+		m_scoreTimer = 0;
+		m_judgeTimer = 0;
+		m_comboTimer = 0;
+		m_judgeSize = 0.5;
+
+		m_drawCombo = true;
+		m_drawJudge = true;
+
+		m_comboLogo->SetFPS(18);
+		m_comboLogo->Reset();
+		m_judgeIndex = (int)events.HitResult;
+	}
+
+	if (events.Jam != m_seenEvents.Jam) {
+		m_jamLogo->SetFPS(13.33);
+		m_drawJam = true;
+		m_jamTimer = 0;
+		m_jamLogo->Reset();
+	}
+
+	if (events.LongNote != m_seenEvents.LongNote) {
+		m_lnLogo->SetFPS(60);
+		m_lnTimer = 0;
+		m_drawLN = true;
+	}
+
+	m_seenEvents = events;
+
+	for (int i = 0; i < 7; i++) {
+		auto& lane = snapshot.Lanes[i];
+
+		if (lane.HitEffect != m_seenHitEffect[i]) {
+			m_seenHitEffect[i] = lane.HitEffect;
+			m_hitEffect[i]->ResetIndex();
+		}
+
+		if (lane.HoldEffect != m_seenHoldEffect[i]) {
+			m_seenHoldEffect[i] = lane.HoldEffect;
+			m_holdEffect[i]->ResetIndex();
+		}
+	}
+}
+
 void GameplayScene::Render(double delta) {
 	if (m_resourceFucked) {
 		return;
@@ -91,8 +152,10 @@ void GameplayScene::Render(double delta) {
 	m_Playfield->Draw();
 	m_targetBar->Draw(delta);
 
-	for (auto& [lane, pressed] : m_keyState) {
-		if (pressed) {
+	auto& snapshot = m_game->GetSnapshot();
+
+	for (int lane = 0; lane < 7; lane++) {
+		if (snapshot.Lanes[lane].Pressed) {
 			m_keyLighting[lane]->AlphaBlend = true;
 			m_keyLighting[lane]->Draw();
 			m_keyButtons[lane]->Draw();
@@ -101,7 +164,7 @@ void GameplayScene::Render(double delta) {
 
 	m_game->Render(delta);
 
-	auto scores = m_game->GetScoreManager()->GetScore();
+	auto& scores = snapshot.Score;
 	m_scoreNum->DrawNumber(std::get<0>(scores));
 
 	// Draw stats
@@ -118,7 +181,7 @@ void GameplayScene::Render(double delta) {
 		m_statsNum->DrawNumber(std::get<8>(scores));
 	}
 
-	int numOfPills = m_game->GetScoreManager()->GetPills();
+	int numOfPills = snapshot.Pills;
 	for (int i = 0; i < numOfPills; i++) {
 		m_pills[i]->Draw();
 	}
@@ -131,7 +194,7 @@ void GameplayScene::Render(double delta) {
 	rc.top = curLifeTex->AbsolutePosition.Y;
 	rc.right = rc.left + curLifeTex->AbsoluteSize.X;
 	rc.bottom = rc.top + curLifeTex->AbsoluteSize.Y + 5; // Need to add + value because wiggle effect =w=
-	float alpha = (float)(kMaxLife - m_game->GetScoreManager()->GetLife()) / kMaxLife;
+	float alpha = (float)(kMaxLife - snapshot.Life) / kMaxLife;
 
 	// Add wiggle effect
 	float yOffset = 0.0f;
@@ -207,7 +270,7 @@ void GameplayScene::Render(double delta) {
 		}
 	}
 
-	float gaugeVal = (float)m_game->GetScoreManager()->GetJamGauge() / kMaxJamGauge;
+	float gaugeVal = (float)snapshot.JamGauge / kMaxJamGauge;
 	if (gaugeVal > 0) {
 		m_jamGauge->CalculateSize();// Thanks estrol for make this easier to fix than before :pog: because moving RECT rc to GameplayScene :D
 
@@ -238,7 +301,7 @@ void GameplayScene::Render(double delta) {
 		}
 	}
 
-	float currentProgress = m_game->GetAudioPosition() / m_game->GetAudioLength();
+	float currentProgress = snapshot.AudioPosition / m_game->GetAudioLength();
 	if (currentProgress > 0) {
 		m_waveGage->CalculateSize();
 
@@ -255,7 +318,7 @@ void GameplayScene::Render(double delta) {
 		m_waveGage->Draw(&rc);
 	}
 
-	int PlayTime = m_game->GetPlayTime();
+	int PlayTime = snapshot.PlayTime;
 	int currentMinutes = PlayTime / 60;
 	int currentSeconds = PlayTime % 60;
 
@@ -267,7 +330,7 @@ void GameplayScene::Render(double delta) {
 	for (int i = 0; i < 7; i++) {
 		m_hitEffect[i]->Draw(delta); 
 
-		if (m_drawHold[i]) {
+		if (snapshot.Lanes[i].DrawHold) {
 			m_holdEffect[i]->Draw(delta);
 		}
 	}
@@ -289,22 +352,16 @@ void GameplayScene::Render(double delta) {
 	}
 }
 
-void GameplayScene::Input(double delta) {
-	if (m_resourceFucked) return;
-
-	m_game->Input(delta);
-}
-
 void GameplayScene::OnKeyDown(const KeyState& state) {
 	if (m_resourceFucked) return;
 
-	m_game->OnKeyDown(state);
+	m_game->QueueKeyEvent(state);
 }
 
 void GameplayScene::OnKeyUp(const KeyState& state) {
 	if (m_resourceFucked) return;
 
-	m_game->OnKeyUp(state);
+	m_game->QueueKeyEvent(state);
 }
 
 void GameplayScene::OnMouseDown(const MouseState& state) {
@@ -317,6 +374,7 @@ bool GameplayScene::Attach() {
 	m_ended = false;
 	m_starting = false;
 	m_doExit = false;
+	EnvironmentSetup::SetInt("Finished", 0);
 	m_drawExitButton = false;
 	m_resourceFucked = false;
 	m_drawJudge = false;
@@ -341,10 +399,10 @@ bool GameplayScene::Attach() {
 		auto playingPath = skinPath / "Playing";
 		SkinConfig conf(playingPath / "Playing.ini", 7);
 
+		m_seenEvents = {};
 		for (int i = 0; i < 7; i++) {
-			m_keyState[i] = false;
-			m_drawHit[i] = false;
-			m_drawHold[i] = false;
+			m_seenHitEffect[i] = 0;
+			m_seenHoldEffect[i] = 0;
 		}
 
 		m_title = std::make_unique<Text>(13);
@@ -675,31 +733,6 @@ bool GameplayScene::Attach() {
 
 		m_game->SetGuideLineIndex(idx);
 
-		m_game->ListenKeyEvent([&](GameTrackEvent e) {
-			if (e.IsKeyEvent) {
-				m_keyState[e.Lane] = e.State;
-			}
-			else {
-				if (e.IsHitEvent) {
-					if (e.IsHitLongEvent) {
-						m_holdEffect[e.Lane]->ResetIndex();
-						m_drawHit[e.Lane] = false;
-						m_drawHold[e.Lane] = e.State;
-
-						if (!e.State) {
-							m_hitEffect[e.Lane]->ResetIndex();
-							m_drawHit[e.Lane] = true;
-						}
-					}
-					else {
-						m_hitEffect[e.Lane]->ResetIndex();
-						m_drawHit[e.Lane] = true;
-						m_drawHold[e.Lane] = false;
-					}
-				}
-			}
-			});
-
 		m_game->Load(chart);
 
 		std::map<int, std::vector<int>> mappedKeyIndex = {
@@ -774,34 +807,6 @@ bool GameplayScene::Attach() {
 
 			m_lifeBar->SetFPS(15);
 		}
-
-		m_game->GetScoreManager()->ListenHit([&](NoteHitInfo info) {
-			m_scoreTimer = 0;
-			m_judgeTimer = 0;
-			m_comboTimer = 0;
-			m_judgeSize = 0.5;
-
-			m_drawCombo = true;
-			m_drawJudge = true;
-
-			m_comboLogo->SetFPS(18);
-			m_comboTimer = 0; // Fix crash :troll:
-			m_comboLogo->Reset();
-			m_judgeIndex = (int)info.Result;
-			});
-
-		m_game->GetScoreManager()->ListenJam([&](int combo) {
-			m_jamLogo->SetFPS(13.33);
-			m_drawJam = true;
-			m_jamTimer = 0;
-			m_jamLogo->Reset();
-			});
-
-		m_game->GetScoreManager()->ListenLongNote([&] {
-			m_lnLogo->SetFPS(60);
-			m_lnTimer = 0;
-			m_drawLN = true;
-			});
 	}
 	catch (std::exception& e) {
 		MsgBox::Show("GameplayError", "Error", e.what(), MsgBoxType::OK);
@@ -864,6 +869,22 @@ bool GameplayScene::Detach() {
 		EnvironmentSetup::SetInt("MaxCombo", std::get<8>(score));
 		EnvironmentSetup::SetInt("LNCombo", std::get<9>(score));
 		EnvironmentSetup::SetInt("LNMaxCombo", std::get<10>(score));
+
+		// Handed over to ResultScene, which takes ownership
+		delete (HitStatistics*)EnvironmentSetup::GetObj("HitStatistics");
+
+		auto statistics = new HitStatistics(m_game->GetScoreManager()->GetStatistics());
+		EnvironmentSetup::SetObj("HitStatistics", statistics);
+
+		auto hitError = statistics->GetStats();
+		if (hitError.Count > 0) {
+			std::cout << "Hit error: mean " << hitError.Mean << "ms, stddev " << hitError.StdDev << "ms, p50 " << hitError.P50 << "ms, p95 " << hitError.P95 << "ms, p99 " << hitError.P99 << "ms over " << hitError.Count << " hits" << std::endl;
+		}
+
+		auto latency = m_game->GetInputLatency();
+		if (latency.Count > 0) {
+			std::cout << "Input latency: avg " << (latency.Total / latency.Count) << "ms, max " << latency.Max << "ms over " << latency.Count << " key events" << std::endl;
+		}
 	}
 	
 	m_game.reset();
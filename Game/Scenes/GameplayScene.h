@@ -19,8 +19,8 @@ public:
 	GameplayScene();
 
 	void Update(double delta) override;
+	void FixedUpdate(double delta) override;
 	void Render(double delta) override;
-	void Input(double delta) override;
 
 	void OnKeyDown(const KeyState& state) override;
 	void OnKeyUp(const KeyState& state) override;
@@ -31,6 +31,7 @@ public:
 	
 private:
 	void* CreateScreenshotWin32();
+	void ApplySnapshotEvents(const GameSnapshot& snapshot);
 
 	std::unordered_map<int, std::shared_ptr<Texture2D>> m_keyLighting;
 	std::unordered_map<int, std::shared_ptr<Texture2D>> m_keyButtons;
@@ -38,7 +39,6 @@ private:
 	std::unordered_map<int, std::shared_ptr<Texture2D>> m_pills;
 	std::unordered_map<int, std::shared_ptr<FrameTimer>> m_hitEffect;
 	std::unordered_map<int, std::shared_ptr<FrameTimer>> m_holdEffect;
-	std::unordered_map<int, bool> m_keyState;
 	std::unordered_map<int, UDim2> m_statsPos;
 
 	std::unique_ptr<Button> m_exitButtonFunc;
@@ -90,9 +90,10 @@ private:
 	/* other stuff */
 	double m_judgeSize;
 
-	/* Hit/Hold Effect */
-	bool m_drawHold[7];
-	bool m_drawHit[7];
+	/* Hit/Hold Effect, last snapshot counters already shown */
+	ScoreEvents m_seenEvents;
+	uint32_t m_seenHitEffect[7];
+	uint32_t m_seenHoldEffect[7];
 
 	/* Fixed Animation*/
 	double m_wiggleTime;
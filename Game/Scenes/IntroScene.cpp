@@ -7,7 +7,9 @@
 #include "../../Engine/Configuration.hpp"
 #include "../Data/Util/Util.hpp"
 #include "../Data/MusicDatabase.h"
+#include "../Data/ScoreDatabase.h"
 #include "../Data/OJN.h"
+#include "../../Engine/Threading/JobSystem.hpp"
 
 #include "../GameScenes.h"
 
@@ -54,15 +56,61 @@ void IntroScene::Render(double delta) {
 				item.CoverSize = Header.cover_size; 
 				item.ThumbnailSize = Header.bmp_size;
 
+				std::string ojmFile(Header.ojm_file, strnlen(Header.ojm_file, sizeof(Header.ojm_file)));
+				auto ojmPath = path.parent_path() / ojmFile;
+
+				/* keysound stats need every payload hashed, that runs on the job system */
+				OJMDedupStats* stats = &m_scanStats[nextIndex];
+				SampleScan* scan = m_scan.get();
+
+				m_scanJobs.push_back(JobSystem::GetInstance()->Schedule([ojmPath, stats, scan]() mutable {
+					OJM ojm = {};
+					ojm.Scan(ojmPath, *scan);
+
+					if (ojm.IsValid()) {
+						*stats = ojm.GetDedupStats();
+					}
+				}, JobPriority::LOW));
+
 				db->Insert(nextIndex++, item);
 
 				waitFrame = 0;
 			}
 		}
 		else {
-			std::filesystem::path musicPath = Configuration::Load("Music", "Folder");
+			size_t scanned = std::count_if(m_scanJobs.begin(), m_scanJobs.end(), [](const JobHandle& job) {
+				return JobSystem::GetInstance()->IsDone(job);
+			});
+
+			if (scanned < m_scanJobs.size()) {
+				m_text->Draw("Scanning keysounds: " + std::to_string(scanned) + "/" + std::to_string(m_scanJobs.size()));
+				return;
+			}
+
+			OJMDedupStats total = {};
+			for (int i = 0; i < m_scanStats.size(); i++) {
+				auto& stats = m_scanStats[i];
+				auto& item = db->GetMusicItem(i);
+
+				item.SampleCount = stats.Samples;
+				item.UniqueSampleCount = stats.UniqueSamples;
+				item.SampleBytes = stats.Bytes;
+				item.UniqueSampleBytes = stats.UniqueBytes;
+
+				total.Samples += stats.Samples;
+				total.Bytes += stats.Bytes;
+				total.UniqueSamples += stats.NewSamples;
+				total.UniqueBytes += stats.NewBytes;
+			}
+
+			m_scanJobs.clear();
+			m_scanStats.clear();
+			m_scan.reset();
 
 			db->Save(std::filesystem::current_path() / "Game.db");
+
+			std::cout << "[MusicDatabase] Keysounds: " << total.UniqueSamples << "/" << total.Samples << " unique, "
+				<< total.UniqueBytes / (1024 * 1024) << "/" << total.Bytes / (1024 * 1024) << " MB" << std::endl;
 			IsReady = true;
 		}
 	}
@@ -79,6 +127,13 @@ bool IntroScene::Attach() {
 
 	std::filesystem::path musicPath = Configuration::Load("Music", "Folder");
 
+	try {
+		ScoreDatabase::GetInstance()->Load(std::filesystem::current_path() / "Score.db");
+	}
+	catch (std::filesystem::filesystem_error& e) {
+		std::cout << "[ScoreDatabase] Failed to open Score.db: " << e.what() << std::endl;
+	}
+
 	auto db = MusicDatabase::GetInstance();
 	std::filesystem::path dbPath = std::filesystem::current_path() / "Game.db";
 	if (std::filesystem::exists(dbPath)) {
@@ -118,12 +173,22 @@ bool IntroScene::Attach() {
 		});
 
 		db->Resize(m_songFiles.size());
+
+		m_scan = std::make_unique<SampleScan>();
+		m_scanStats.assign(m_songFiles.size(), OJMDedupStats{});
 	}
 
 	return true;
 }
 
 bool IntroScene::Detach() {
+	for (auto& job : m_scanJobs) {
+		JobSystem::GetInstance()->Wait(job);
+	}
+
+	m_scanJobs.clear();
+	m_scan.reset();
+
 	SAFE_DELETE(m_text);
 	return true;
 }
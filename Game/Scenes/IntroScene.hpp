@@ -4,7 +4,10 @@
 #include "../../Engine/Scene.hpp"
 #include "../../Engine/Text.hpp"
 #include "../Engine/Button.hpp"
+#include "../Data/OJM.hpp"
+#include "../../Engine/Threading/JobSystem.hpp"
 #include <map>
+#include <memory>
 
 struct KeyState;
 
@@ -25,4 +28,9 @@ private:
 	Text* m_text;
 	int nextIndex = 0;
 	std::vector<std::filesystem::path> m_songFiles;
+
+	/* per song keysound stats, filled by the scan jobs against one scan wide hash set */
+	std::unique_ptr<SampleScan> m_scan;
+	std::vector<OJMDedupStats> m_scanStats;
+	std::vector<JobHandle> m_scanJobs;
 };
\ No newline at end of file
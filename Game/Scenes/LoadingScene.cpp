@@ -2,17 +2,20 @@
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
 
 #include "../../Engine/Configuration.hpp"
 
 #include "../Data/osu.hpp"
 #include "../Data/Chart.hpp"
+#include "../Engine/GameAudioSampleCache.hpp"
 
 #include "../EnvironmentSetup.hpp"
 #include "../GameScenes.h"
 #include "../Data/MusicDatabase.h"
 #include "../../Engine/MsgBox.hpp"
 #include "../../Engine/SDLException.hpp"
+#include "../../Engine/Threading/JobSystem.hpp"
 
 LoadingScene::LoadingScene() {
 	m_background = nullptr;
@@ -94,12 +97,14 @@ void LoadingScene::Update(double delta) {
 				chart = new Chart(beatmap);
 			}
 
-			std::filesystem::path dirPath = chart->m_beatmapDirectory;
-			dirPath /= chart->m_backgroundFile;
+			std::filesystem::path dirPath;
+			if (chart->m_backgroundFile.size() > 0) {
+				dirPath = chart->m_directoryIndex.Resolve(chart->m_backgroundFile);
+			}
 
 			try {
 				Window* window = Window::GetInstance();
-				if (chart->m_backgroundFile.size() > 0 && std::filesystem::exists(dirPath)) {
+				if (!dirPath.empty()) {
 					m_background = new Texture2D(dirPath.string());
 					m_background->Size = UDim2::fromOffset(window->GetBufferWidth(), window->GetBufferHeight());
 				}
@@ -126,10 +131,29 @@ void LoadingScene::Update(double delta) {
 			}
 
 			EnvironmentSetup::SetObj("SONG", chart);
+
+			// Keysounds load on a job while the loading screen is up, the scene
+			// only changes once the opening ones are in and RhythmEngine then
+			// finds the chart already loaded.
+			if (!fucked) {
+				double rate = 1.0;
+				if (EnvironmentSetup::Get("SongRate").size() > 0) {
+					rate = std::clamp(std::stod(EnvironmentSetup::Get("SongRate").c_str()), 0.5, 2.0);
+				}
+
+				bool pitch = Configuration::Load("Game", "AudioPitch") == "1";
+
+				m_loadJob = JobSystem::GetInstance()->Schedule([chart, rate, pitch] {
+					GameAudioSampleCache::SetRate(rate);
+					GameAudioSampleCache::Load(chart, pitch);
+				}, JobPriority::HIGH);
+			}
 		}
 	}
 
-	if (m_counter > 2.5 && obj != nullptr) {
+	bool loaded = !m_loadJob || JobSystem::GetInstance()->IsDone(m_loadJob);
+
+	if (m_counter > 2.5 && obj != nullptr && loaded) {
 		SceneManager::ChangeScene(GameScene::GAME);
 	}
 	else {
@@ -160,6 +184,7 @@ bool LoadingScene::Attach() {
 	is_shown = false;
 	is_ready = true;
 	m_counter = 0;
+	m_loadJob.reset();
 
 	m_background = (Texture2D*)EnvironmentSetup::GetObj("SongBackground");
 	dont_dispose = m_background != nullptr;
@@ -169,6 +194,11 @@ bool LoadingScene::Attach() {
 }
 
 bool LoadingScene::Detach() {
+	if (m_loadJob) {
+		JobSystem::GetInstance()->Wait(m_loadJob);
+		m_loadJob.reset();
+	}
+
 	if (m_background && !dont_dispose) {
 		delete m_background;
 		m_background = nullptr;
@@ -1,5 +1,6 @@
 #pragma once
 #include "../../Engine/EstEngine.hpp"
+#include "../../Engine/Threading/JobSystem.hpp"
 
 class LoadingScene : public Scene {
 public:
@@ -23,4 +24,7 @@ private:
 
 	double m_counter;
 	Texture2D* m_background;
+
+	/* GameAudioSampleCache::Load, off the render thread */
+	JobHandle m_loadJob;
 };
\ No newline at end of file
@@ -6,14 +6,27 @@
 #include "../../Engine/SceneManager.hpp"
 #include "../GameScenes.h"
 #include "../Data/Chart.hpp"
+#include "../Data/ScoreDatabase.h"
 #include "../EnvironmentSetup.hpp"
 #include "../../Engine/MathUtils.hpp"
 #include "../../Engine/Window.hpp"
 #include "../../Engine/Imgui/imgui_internal.h"
 #include "../../Engine/Imgui/implot.h"
 #include "../../Engine/FontResources.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	// Narrowest offset range the timing plots show, in ms, and the step their
+	// limits are rounded out to
+	constexpr double kHitPlotMinimumRange = 50.0;
+	constexpr double kHitPlotRangeStep = 25.0;
+}
 
 ResultScene::ResultScene() {
+	m_plotRange = kHitPlotMinimumRange;
 }
 
 void ResultScene::Render(double delta) {
@@ -70,6 +83,13 @@ void ResultScene::Render(double delta) {
                 ImGui::Button((std::to_string(score) + "###1").c_str(), MathUtil::ScaleVec2(ImVec2(192, 0)));
                 ImGui::PopFont();
 
+                if (m_newBest) {
+                    ImGui::Text("New personal best!");
+                }
+                else if (m_previousBest >= 0) {
+                    ImGui::Text("Personal best: %d", m_previousBest);
+                }
+
                 if (ImGui::BeginChild("#Window2", MathUtil::ScaleVec2(ImVec2(95, 0)))) {
                     ImGui::Text("Cool");
                     ImGui::PushFont(FontResources::GetButtonFont());
@@ -116,6 +136,9 @@ void ResultScene::Render(double delta) {
                 ImGui::EndChild();
             }
 
+            ImGui::SameLine();
+            RenderTiming();
+
             ImGui::EndChild();
         }
 
@@ -134,6 +157,94 @@ void ResultScene::Render(double delta) {
     }
 }
 
+void ResultScene::RenderTiming() {
+    if (!ImGui::BeginChild("#Timing", MathUtil::ScaleVec2(ImVec2(0, 0)), true)) {
+        return;
+    }
+
+    if (m_hitError.Count == 0) {
+        ImGui::Text("No timing data");
+        ImGui::EndChild();
+        return;
+    }
+
+    ImGui::Text("Hit error: mean %+.1fms  stddev %.1fms  (%d early / %d late)", m_hitError.Mean, m_hitError.StdDev, m_hitError.Early, m_hitError.Late);
+    ImGui::Text("Absolute error: p50 %.0fms  p95 %.0fms  p99 %.0fms", m_hitError.P50, m_hitError.P95, m_hitError.P99);
+    if (m_hitError.Outside > 0) {
+        ImGui::SameLine();
+        ImGui::Text("(%d hits past %dms)", m_hitError.Outside, kHitErrorRange);
+    }
+
+    float height = (ImGui::GetContentRegionAvail().y - ImGui::GetStyle().ItemSpacing.y) / 2.0f;
+
+    if (ImPlot::BeginPlot("##TimingGraph", ImVec2(-1, height), ImPlotFlags_NoLegend)) {
+        ImPlot::SetupAxes("Time (s)", "Offset (ms)");
+        ImPlot::SetupAxisLimits(ImAxis_Y1, -m_plotRange, m_plotRange);
+
+        ImPlot::PlotScatter("Hits", m_sampleTimes.data(), m_sampleOffsets.data(), static_cast<int>(m_sampleTimes.size()));
+
+        double zero = 0;
+        ImPlot::PlotInfLines("Zero", &zero, 1, ImPlotInfLinesFlags_Horizontal);
+        ImPlot::EndPlot();
+    }
+
+    if (ImPlot::BeginPlot("##TimingHistogram", ImVec2(-1, height), ImPlotFlags_NoLegend)) {
+        ImPlot::SetupAxes("Offset (ms)", "Hits");
+        ImPlot::SetupAxisLimits(ImAxis_X1, -m_plotRange, m_plotRange);
+
+        ImPlot::PlotBars("Hits", m_histogramOffsets.data(), m_histogramCounts.data(), static_cast<int>(m_histogramCounts.size()), 1.0);
+        ImPlot::EndPlot();
+    }
+
+    ImGui::EndChild();
+}
+
+void ResultScene::SaveScore(Chart* chart) {
+    DB_ScoreRecord record = {};
+    memcpy(record.Hash, chart->MD5Hash.c_str(), std::min(chart->MD5Hash.size(), sizeof(record.Hash)));
+
+    std::string songId = EnvironmentSetup::Get("Key");
+    record.SongId = songId.size() ? std::atoi(songId.c_str()) : -1;
+    record.Difficulty = std::atoi(EnvironmentSetup::Get("Difficulty").c_str());
+
+    if (EnvironmentSetup::GetInt("Mirror")) {
+        record.Mods |= SCORE_MOD_MIRROR;
+    }
+    else if (EnvironmentSetup::GetInt("Random")) {
+        record.Mods |= SCORE_MOD_RANDOM;
+    }
+    else if (EnvironmentSetup::GetInt("Rearrange")) {
+        record.Mods |= SCORE_MOD_REARRANGE;
+    }
+
+    record.Rate = 1.0f;
+    if (EnvironmentSetup::Get("SongRate").size() > 0) {
+        record.Rate = std::clamp(std::stof(EnvironmentSetup::Get("SongRate")), 0.5f, 2.0f);
+    }
+
+    record.Timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    record.Score = EnvironmentSetup::GetInt("Score");
+    record.Cool = EnvironmentSetup::GetInt("Cool");
+    record.Good = EnvironmentSetup::GetInt("Good");
+    record.Bad = EnvironmentSetup::GetInt("Bad");
+    record.Miss = EnvironmentSetup::GetInt("Miss");
+    record.MaxCombo = EnvironmentSetup::GetInt("MaxCombo");
+    record.MaxJamCombo = EnvironmentSetup::GetInt("MaxJamCombo");
+    record.LNMaxCombo = EnvironmentSetup::GetInt("LNMaxCombo");
+    record.MeanOffset = m_statistics ? static_cast<float>(m_statistics->GetStats().Mean) : 0.0f;
+
+    auto db = ScoreDatabase::GetInstance();
+
+    DB_ScoreRecord best = {};
+    if (db->GetBest(chart->MD5Hash, record.Mods, record.Rate, best)) {
+        m_previousBest = best.Score;
+    }
+
+    if (db->Insert(record)) {
+        m_newBest = record.Score > m_previousBest;
+    }
+}
+
 bool ResultScene::Attach() {
     SceneManager::DisplayFade(0, [] {});
     m_backButton = false;
@@ -164,8 +275,49 @@ bool ResultScene::Attach() {
         m_background->Size = UDim2::fromOffset(window->GetBufferWidth(), window->GetBufferHeight());
     }
 
+    m_statistics.reset((HitStatistics*)EnvironmentSetup::GetObj("HitStatistics"));
+    EnvironmentSetup::SetObj("HitStatistics", nullptr);
+
+    m_previousBest = -1;
+    m_newBest = false;
+
+    if (chart && EnvironmentSetup::GetInt("Autoplay") != 1 && EnvironmentSetup::GetInt("Finished") == 1) {
+        SaveScore(chart);
+    }
+
     delete chart;
 
+    m_hitError = {};
+    m_sampleTimes.clear();
+    m_sampleOffsets.clear();
+    m_histogramOffsets.clear();
+    m_histogramCounts.clear();
+
+    if (m_statistics) {
+        m_hitError = m_statistics->GetStats();
+
+        for (auto& sample : m_statistics->GetSamples()) {
+            m_sampleTimes.push_back(sample.Time / 1000.0);
+            m_sampleOffsets.push_back(sample.Offset);
+        }
+
+        auto histogram = m_statistics->GetHistogram();
+        for (int i = 0; i < kHitErrorBuckets; i++) {
+            m_histogramOffsets.push_back(i - kHitErrorRange);
+            m_histogramCounts.push_back(histogram[i]);
+        }
+    }
+
+    /* the graph only holds a thinned subset, the histogram has every hit */
+    double furthest = 0;
+    for (size_t i = 0; i < m_histogramCounts.size(); i++) {
+        if (m_histogramCounts[i] > 0) {
+            furthest = (std::max)(furthest, std::abs(m_histogramOffsets[i]));
+        }
+    }
+
+    m_plotRange = (std::max)(std::ceil((furthest + 1.0) / kHitPlotRangeStep) * kHitPlotRangeStep, kHitPlotMinimumRange);
+
 	return true;
 }
 
@@ -176,5 +328,6 @@ bool ResultScene::Detach() {
     }
 
     m_background.reset();
+    m_statistics.reset();
 	return true;
 }
@@ -1,7 +1,11 @@
 #pragma once
 #include <memory>
+#include <vector>
 #include "../../Engine/Scene.hpp"
 #include "../../Engine/Texture2D.hpp"
+#include "../Engine/HitStatistics.hpp"
+
+class Chart;
 
 class ResultScene : public Scene {
 public:
@@ -13,7 +17,25 @@ public:
 	bool Detach() override;
 
 private:
+	void RenderTiming();
+	void SaveScore(Chart* chart);
+
 	bool m_backButton;
 
+	/* best score of this chart/mods/rate before this play, -1 if none */
+	int m_previousBest;
+	bool m_newBest;
+
+	/* timing graph data, built once on attach */
+	std::unique_ptr<HitStatistics> m_statistics;
+	HitErrorStats m_hitError;
+	std::vector<double> m_sampleTimes;
+	std::vector<double> m_sampleOffsets;
+	std::vector<double> m_histogramOffsets;
+	std::vector<double> m_histogramCounts;
+
+	/* both plots show +-m_plotRange ms, fitted to the furthest hit */
+	double m_plotRange;
+
 	std::unique_ptr<Texture2D> m_background;
 };
\ No newline at end of file
@@ -7,6 +7,9 @@
 #include "../../Engine/Configuration.hpp"
 #include "../Resources/SkinConfig.hpp"
 #include "../Data/MusicDatabase.h"
+#include "../Data/ScoreDatabase.h"
+#include "../Engine/PreviewBuilder.hpp"
+#include "../Engine/LoudnessScanner.hpp"
 
 #include "../EnvironmentSetup.hpp"
 #include "../GameScenes.h"
@@ -41,7 +44,9 @@ void SongSelectScene::Render(double delta) {
     ImguiUtil::NewFrame();
 
     auto music = MusicDatabase::GetInstance();
+    auto scores = ScoreDatabase::GetInstance();
     auto window = Window::GetInstance();
+    int difficultyIndex = std::atoi(EnvironmentSetup::Get("Difficulty").c_str());
 	
     bool bPlay = false;
     bool bExitPopup = false;
@@ -137,6 +142,12 @@ void SongSelectScene::Render(double delta) {
                 std::string count = std::to_string(index != -1 ? item->MaxNotes[2] : 0);
                 ImGui::Button(count.c_str(), MathUtil::ScaleVec2(ImVec2(340, 0)));
 
+                ImGui::Text("Best score\r");
+
+                DB_ScoreRecord best = {};
+                bool hasBest = index != -1 && scores->GetSongBest(index, difficultyIndex, best);
+                ImGui::Button((hasBest ? std::to_string(best.Score) + "###BestScore" : std::string("-###BestScore")).c_str(), MathUtil::ScaleVec2(ImVec2(340, 0)));
+
                 ImGui::PopItemFlag();
                 ImGui::PopStyleVar();
 
@@ -284,7 +295,15 @@ void SongSelectScene::Render(double delta) {
                             ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
                         }
 
-                        std::u8string title = std::u8string(item.Title) + std::u8string(Id.begin(), Id.end());
+                        std::u8string title = std::u8string(item.Title);
+
+                        DB_ScoreRecord best = {};
+                        if (scores->GetSongBest(item.Id, difficultyIndex, best)) {
+                            std::string bestText = "  (" + std::to_string(best.Score) + ")";
+                            title += std::u8string(bestText.begin(), bestText.end());
+                        }
+
+                        title += std::u8string(Id.begin(), Id.end());
                         auto cursorPos = ImGui::GetCursorPos();
 						
                         if (ImGui::ButtonEx(
@@ -707,6 +726,8 @@ void SongSelectScene::Render(double delta) {
                                 ImGui::EndCombo();
                             }
 
+                            ImGui::Checkbox("Show frame time overlay", &showFrameStats);
+
                             ImGui::EndTabItem();
                         }
 
@@ -720,6 +741,13 @@ void SongSelectScene::Render(double delta) {
                             ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Warning: this will make keysounded sample as auto sample!");
                             ImGui::SliderInt("###Slider1", &currentOffset, -500, 500);
 
+                            ImGui::Text("Visual Offset");
+                            ImGui::SliderInt("###Slider3", &currentVisualOffset, -500, 500);
+
+                            if (ImGui::Button("Calibrate offsets###Calibrate")) {
+                                is_calibrating = true;
+                            }
+
                             ImGui::NewLine();
                             ImGui::Checkbox("Convert Sample to Auto Sample###Checkbox1", &convertAutoSound);
                             ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Convert all keysounded sample to auto sample");
@@ -809,9 +837,23 @@ void SongSelectScene::Render(double delta) {
             m_bgm->Stop();
         }
 
+        is_bgm_starting = false;
+        bgmStartWait = 0;
         m_bgm->Load(index);
     }
 
+    if (is_bgm_starting) {
+        bgmStartWait += delta;
+
+        if (bgmStartWait > 1.5) {
+            is_bgm_starting = false;
+            bgmStartWait = 0;
+
+            m_bgm->Play();
+            is_update_bgm = true;
+        }
+    }
+
     if (bPlay && index != -1 && !is_departing) {
         is_departing = true;
         SaveConfiguration();
@@ -846,6 +888,15 @@ void SongSelectScene::Render(double delta) {
         });
     }
 
+    if (is_calibrating && !is_departing) {
+        is_departing = true;
+        SaveConfiguration();
+
+        SceneManager::DisplayFade(100, [this]() {
+            SceneManager::ChangeScene(GameScene::CALIBRATION);
+        });
+    }
+
     if (is_quit) {
         SaveConfiguration();
         SceneManager::GetInstance()->StopGame();
@@ -873,6 +924,8 @@ void SongSelectScene::Update(double delta) {
     if (is_update_bgm) {
         m_bgm->Update(delta);
     }
+
+    LoudnessScanner::Update();
 }
 
 void SongSelectScene::Input(double delta) {
@@ -964,6 +1017,13 @@ bool SongSelectScene::Attach() {
         currentOffset = 0;
     }
 
+    try {
+        currentVisualOffset = std::atoi(Configuration::Load("Game", "VisualOffset").c_str());
+    }
+    catch (std::invalid_argument) {
+        currentVisualOffset = 0;
+    }
+
     try {
         currentVolume = std::atoi(Configuration::Load("Game", "AudioVolume").c_str());
     }
@@ -995,6 +1055,8 @@ bool SongSelectScene::Attach() {
         currentFPSIndex = 4;
     }
 
+    showFrameStats = Configuration::Load("Game", "FrameStats") == "1";
+
     try {
         currentGuideLineIndex = std::atoi(Configuration::Load("Game", "GuideLine").c_str());
     }
@@ -1003,9 +1065,14 @@ bool SongSelectScene::Attach() {
     }
 
     is_update_bgm = false;
+    is_bgm_starting = false;
+    bgmStartWait = 0;
     isWait = index != -1;
     waitTime = 0;
 
+    PreviewBuilder::PrebuildLibrary();
+    LoudnessScanner::ScanLibrary();
+
     if (!m_bgm) {
         m_bgm = std::make_unique<BGMPreview>();
         m_bgm->OnReady([&](bool start) {
@@ -1015,24 +1082,22 @@ bool SongSelectScene::Attach() {
                     bgm->FadeOut();
                 }
 
-                Sleep(1500);
-                if (m_bgm) {
-                    m_bgm->Play();
-                }
-
-                is_update_bgm = true;
+                /* Render starts the preview once the menu BGM has faded out */
+                is_bgm_starting = true;
             }
             else {
                 if (bgm) {
                     bgm->FadeIn();
                 }
 
+                is_bgm_starting = false;
                 is_update_bgm = false;
             }
         });
     }
 
     is_departing = false;
+    is_calibrating = false;
     return true;
 }
 
@@ -1046,7 +1111,10 @@ bool SongSelectScene::Detach() {
         m_bgm->Stop();
     }
 
+    PreviewBuilder::CancelPrebuild();
+    LoudnessScanner::CancelScan();
     isWait = false;
+    is_bgm_starting = false;
 
     return true;
 }
@@ -1055,12 +1123,16 @@ void SongSelectScene::SaveConfiguration() {
     EnvironmentSetup::Set("SongRate", std::to_string(currentRate));
     Configuration::Set("Gameplay", "Notespeed", std::to_string(static_cast<int>(currentSpeed * 100.0)));
     Configuration::Set("Game", "AudioOffset", std::to_string(currentOffset));
+    Configuration::Set("Game", "VisualOffset", std::to_string(currentVisualOffset));
 	Configuration::Set("Game", "AudioVolume", std::to_string(currentVolume));
 	Configuration::Set("Game", "AutoSound", std::to_string(convertAutoSound ? 1 : 0));
     Configuration::Set("Game", "FrameLimit", m_fps[currentFPSIndex]);
     Configuration::Set("Game", "GuideLine", std::to_string(currentGuideLineIndex));
 
+    Configuration::Set("Game", "FrameStats", showFrameStats ? "1" : "0");
+
     SceneManager::GetInstance()->SetFrameLimit(std::atof(m_fps[currentFPSIndex].c_str()));
+    SceneManager::GetInstance()->SetFrameStatsOverlay(showFrameStats);
 }
 
 void SongSelectScene::LoadChartImage() {
@@ -41,15 +41,20 @@ private:
 	int currentVolume = 100;
 	int currentFPSIndex = 0;
 	int currentOffset = 0;
+	int currentVisualOffset = 0;
 	int currentResolutionIndex = 0;
 	int currentGuideLineIndex = 0;
 	bool LongNoteLighting = false;
 	bool LongNoteOnHitPos = false;
 	bool convertAutoSound = false;
+	bool showFrameStats = false;
 
 	bool is_departing = false;
 	bool is_quit = false;
+	bool is_calibrating = false;
 	bool is_update_bgm = false;
+	std::atomic<bool> is_bgm_starting = false;
+	float bgmStartWait = 0;
 	bool imgui_modal_quit_confirm = false;
 
 	char lanePos[8];
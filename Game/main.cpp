@@ -191,7 +191,7 @@ int wmain(int argc, wchar_t* argv[]) {
 				DebugBreak();
 			}
 
-			file.write((const char*)sample.AudioData.data(), sample.AudioData.size());
+			file.write((const char*)sample.AudioData->data(), sample.AudioData->size());
 			file.close();
 		}
 	}*/
@@ -0,0 +1,94 @@
+#include "TestFramework.hpp"
+#include "../Game/Engine/ChartTimeline.hpp"
+#include <vector>
+
+namespace {
+	// A line every 100 ms up to 1 s, counts how far it has been pulled
+	struct LineSource {
+		double Next = 0;
+		int Generated = 0;
+
+		bool operator()(TimelineEvent& e) {
+			if (Next >= 1000) {
+				return false;
+			}
+
+			e.Time = Next;
+			e.Position = Next * 2;
+			Next += 100;
+			Generated++;
+
+			return true;
+		}
+	};
+}
+
+TEST_CASE(ChartTimelineMergesSourcesInOrder) {
+	ChartTimeline timeline;
+	LineSource lines;
+
+	timeline.Add(TimelineEventType::NOTE_SPAWN, 0, 150);
+	timeline.Add(TimelineEventType::NOTE_SPAWN, 1, 420);
+	timeline.AddSource(TimelineEventType::MEASURE_LINE, [&](TimelineEvent& e) {
+		return lines(e);
+	}, [&] {
+		lines = {};
+	});
+
+	std::vector<double> order;
+	timeline.Subscribe(TimelineEventType::NOTE_SPAWN, [&](const TimelineEvent& e) {
+		order.push_back(e.Time);
+	});
+
+	timeline.Subscribe(TimelineEventType::MEASURE_LINE, [&](const TimelineEvent& e) {
+		CHECK(e.Position == e.Time * 2);
+		order.push_back(e.Time);
+	});
+
+	timeline.Schedule([](const TimelineEvent& e) {
+		return e.Time;
+	});
+
+	timeline.Advance(250);
+	CHECK((order == std::vector<double>{ 0, 100, 150, 200 }));
+
+	// Only the one line past the window has been generated, not the whole chart
+	CHECK(lines.Generated == 4);
+
+	timeline.Advance(2000);
+	CHECK(order.size() == 12);
+	CHECK(order[6] == 420);
+
+	for (size_t i = 1; i < order.size(); i++) {
+		CHECK(order[i - 1] <= order[i]);
+	}
+}
+
+TEST_CASE(ChartTimelineSeekRewindsSources) {
+	ChartTimeline timeline;
+	LineSource lines;
+
+	timeline.AddSource(TimelineEventType::MEASURE_LINE, [&](TimelineEvent& e) {
+		return lines(e);
+	}, [&] {
+		lines = {};
+	});
+
+	std::vector<double> order;
+	timeline.Subscribe(TimelineEventType::MEASURE_LINE, [&](const TimelineEvent& e) {
+		order.push_back(e.Time);
+	});
+
+	// Lines dispatch 50 ms ahead of their time
+	timeline.Schedule([](const TimelineEvent& e) {
+		return e.Time - 50;
+	});
+
+	timeline.Advance(1000);
+	CHECK(order.size() == 10);
+
+	order.clear();
+	timeline.Seek(430);
+	timeline.Advance(700);
+	CHECK((order == std::vector<double>{ 500, 600, 700 }));
+}
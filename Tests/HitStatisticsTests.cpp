@@ -0,0 +1,93 @@
+#include "TestFramework.hpp"
+#include "../Game/Engine/HitStatistics.hpp"
+#include <vector>
+
+TEST_CASE(HitStatisticsRangeCoversBadWindow) {
+	// The Bad window at the slowest tempo the histogram is sized for
+	CHECK(kHitErrorRange >= static_cast<int>(CalculateHitWindow(kHitErrorMinimumBpm).Bad));
+	CHECK(kHitErrorRange >= static_cast<int>(CalculateHitWindow(120.0).Bad));
+}
+
+TEST_CASE(HitStatisticsClampsOutsideRange) {
+	HitStatistics statistics;
+	statistics.Record(0, 0, 10);
+	statistics.Record(0, 1, -(kHitErrorRange + 300.0));
+	statistics.Record(1, 2, kHitErrorRange + 1.0);
+	statistics.Record(1, 3, kHitErrorRange);
+
+	auto stats = statistics.GetStats();
+	CHECK(stats.Count == 4);
+	CHECK(stats.Outside == 2);
+	CHECK(stats.Early == 1);
+	CHECK(stats.Late == 3);
+	CHECK(statistics.GetStats(0).Outside == 1);
+
+	// The mean still uses the real offsets
+	CHECK_NEAR(stats.Mean, (10.0 - kHitErrorRange - 300.0 + kHitErrorRange + 1.0 + kHitErrorRange) / 4.0, 0.001);
+
+	auto histogram = statistics.GetHistogram();
+	CHECK(histogram.front() == 1);
+	CHECK(histogram.back() == 2);
+	CHECK(histogram[kHitErrorRange + 10] == 1);
+
+	// Invalid lanes are ignored
+	statistics.Record(-1, 4, 0);
+	statistics.Record(kHitStatisticsLanes, 5, 0);
+	CHECK(statistics.GetStats().Count == 4);
+}
+
+TEST_CASE(HitStatisticsPercentiles) {
+	HitStatistics statistics;
+
+	// |offset| 1..100 ms once each, alternating early and late, spread over lanes
+	for (int i = 1; i <= 100; i++) {
+		statistics.Record(i % kHitStatisticsLanes, i, i % 2 ? -i : i);
+	}
+
+	auto stats = statistics.GetStats();
+	CHECK(stats.Count == 100);
+	CHECK(stats.Early == 50);
+	CHECK(stats.Late == 50);
+	CHECK(stats.Outside == 0);
+	CHECK(stats.P50 == 50);
+	CHECK(stats.P95 == 95);
+	CHECK(stats.P99 == 99);
+
+	// Hits past the range saturate the high percentiles at kHitErrorRange
+	for (int i = 0; i < 10; i++) {
+		statistics.Record(0, 200 + i, kHitErrorRange * 2.0);
+	}
+
+	stats = statistics.GetStats();
+	CHECK(stats.Outside == 10);
+	CHECK(stats.P99 == kHitErrorRange);
+	CHECK(stats.P50 < kHitErrorRange);
+
+	statistics.Reset();
+	CHECK(statistics.GetStats().Count == 0);
+	CHECK(statistics.GetSamples().empty());
+}
+
+TEST_CASE(HitStatisticsThinsGraphSamples) {
+	constexpr int kHits = kHitGraphSamples * 5 + 123;
+
+	HitStatistics statistics;
+	for (int i = 0; i < kHits; i++) {
+		statistics.Record(i % kHitStatisticsLanes, i, 0);
+		CHECK(statistics.GetSamples().size() <= kHitGraphSamples);
+	}
+
+	// Every stride-th hit from the first one, so the graph spans the whole chart evenly
+	auto& samples = statistics.GetSamples();
+	CHECK(samples.size() > kHitGraphSamples / 2);
+
+	int stride = static_cast<int>(samples[1].Time - samples[0].Time);
+	CHECK(samples.front().Time == 0);
+	CHECK(stride == 8);
+
+	for (size_t i = 0; i < samples.size(); i++) {
+		CHECK(samples[i].Time == static_cast<double>(i * stride));
+	}
+
+	CHECK(samples.back().Time > kHits - 1 - stride);
+}
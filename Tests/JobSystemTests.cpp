@@ -0,0 +1,339 @@
+#include "TestFramework.hpp"
+#include "../Engine/Threading/JobSystem.hpp"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+	void WaitAll(const std::vector<JobHandle>& jobs) {
+		for (auto& job : jobs) {
+			JobSystem::GetInstance()->Wait(job);
+		}
+	}
+
+	// Busy work the optimizer can't drop
+	uint64_t Spin(int iterations) {
+		uint64_t value = 0x9E3779B97F4A7C15ull;
+		for (int i = 0; i < iterations; i++) {
+			value ^= value << 13;
+			value ^= value >> 7;
+			value ^= value << 17;
+		}
+
+		return value;
+	}
+
+	// Occupies every worker until Open is called, so the queues can be filled
+	// while nothing drains them
+	class WorkerGate {
+	public:
+		WorkerGate(JobPriority priority) {
+			m_open = false;
+			m_started = 0;
+
+			int count = JobSystem::GetInstance()->GetWorkerCount();
+			for (int i = 0; i < count; i++) {
+				m_jobs.push_back(JobSystem::GetInstance()->Schedule([this] {
+					m_started++;
+
+					while (!m_open) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				}, priority));
+			}
+
+			while (m_started < count) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+
+		~WorkerGate() {
+			Open();
+			WaitAll(m_jobs);
+		}
+
+		void Open() {
+			m_open = true;
+		}
+
+		const std::vector<JobHandle>& GetJobs() const {
+			return m_jobs;
+		}
+
+	private:
+		std::atomic<bool> m_open;
+		std::atomic<int> m_started;
+		std::vector<JobHandle> m_jobs;
+	};
+
+	uint64_t ParallelSum(uint64_t begin, uint64_t end) {
+		if (end - begin <= 1024) {
+			uint64_t sum = 0;
+			for (uint64_t i = begin; i < end; i++) {
+				sum += i;
+			}
+
+			return sum;
+		}
+
+		uint64_t middle = begin + (end - begin) / 2;
+		uint64_t left = 0, right = 0;
+
+		auto job = JobSystem::GetInstance()->Schedule([&] {
+			left = ParallelSum(begin, middle);
+		});
+
+		right = ParallelSum(middle, end);
+		JobSystem::GetInstance()->Wait(job);
+
+		return left + right;
+	}
+}
+
+TEST_CASE(JobSystemRunsEveryJob) {
+	constexpr int kJobs = 200000;
+
+	std::atomic<int> counter = 0;
+	std::vector<JobHandle> jobs;
+	jobs.reserve(kJobs);
+
+	for (int i = 0; i < kJobs; i++) {
+		JobPriority priority = static_cast<JobPriority>(i % kJobPriorityCount);
+		jobs.push_back(JobSystem::GetInstance()->Schedule([&counter] {
+			counter++;
+		}, priority));
+	}
+
+	WaitAll(jobs);
+	CHECK(counter == kJobs);
+
+	for (auto& job : jobs) {
+		CHECK(JobSystem::GetInstance()->IsDone(job));
+	}
+}
+
+TEST_CASE(JobSystemRunsDependenciesFirst) {
+	constexpr int kJobs = 5000;
+
+	std::mt19937 random(1234);
+	auto flags = std::make_unique<std::atomic<bool>[]>(kJobs);
+	std::atomic<int> violations = 0;
+
+	std::vector<JobHandle> jobs;
+	for (int i = 0; i < kJobs; i++) {
+		flags[i] = false;
+
+		std::vector<int> parents;
+		std::vector<JobHandle> dependencies;
+		for (int j = 0; j < 3 && i > 0; j++) {
+			int parent = static_cast<int>(random() % i);
+			parents.push_back(parent);
+			dependencies.push_back(jobs[parent]);
+		}
+
+		jobs.push_back(JobSystem::GetInstance()->Schedule([&flags, &violations, parents, i] {
+			for (int parent : parents) {
+				if (!flags[parent]) {
+					violations++;
+				}
+			}
+
+			Spin(200);
+			flags[i] = true;
+		}, dependencies, static_cast<JobPriority>(i % kJobPriorityCount)));
+	}
+
+	WaitAll(jobs);
+	CHECK(violations == 0);
+}
+
+TEST_CASE(JobSystemNestedWaitDoesNotDeadlock) {
+	constexpr uint64_t kCount = 1 << 22;
+
+	for (int round = 0; round < 8; round++) {
+		uint64_t sum = 0;
+		auto job = JobSystem::GetInstance()->Schedule([&sum] {
+			sum = ParallelSum(0, kCount);
+		});
+
+		JobSystem::GetInstance()->Wait(job);
+		CHECK(sum == kCount * (kCount - 1) / 2);
+	}
+}
+
+TEST_CASE(JobSystemWaitSkipsLessUrgentJobs) {
+	constexpr int kLowJobs = 64;
+
+	auto caller = std::this_thread::get_id();
+	std::atomic<int> ranOnCaller = 0;
+	std::vector<JobHandle> low;
+
+	{
+		WorkerGate gate(JobPriority::NORMAL);
+
+		for (int i = 0; i < kLowJobs; i++) {
+			low.push_back(JobSystem::GetInstance()->Schedule([&] {
+				if (std::this_thread::get_id() == caller) {
+					ranOnCaller++;
+				}
+			}, JobPriority::LOW));
+		}
+
+		std::thread opener([&gate] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			gate.Open();
+		});
+
+		// Every worker is stuck in the gate, a waiting NORMAL caller has to sleep
+		// instead of draining the LOW queue itself
+		JobSystem::GetInstance()->Wait(gate.GetJobs().front());
+		opener.join();
+
+		CHECK(ranOnCaller == 0);
+	}
+
+	WaitAll(low);
+}
+
+TEST_CASE(JobSystemPriorityIsGlobal) {
+	constexpr int kHighJobs = 512;
+	constexpr int kLowJobs = 512;
+
+	int workers = JobSystem::GetInstance()->GetWorkerCount();
+	std::atomic<int> highStarted = 0;
+	std::atomic<int> highStartedAtFirstLow = -1;
+
+	std::vector<JobHandle> high, low;
+	{
+		WorkerGate gate(JobPriority::HIGH);
+
+		// LOW first so per-worker FIFO or LIFO order alone can't pass this
+		for (int i = 0; i < kLowJobs; i++) {
+			low.push_back(JobSystem::GetInstance()->Schedule([&] {
+				int expected = -1;
+				highStartedAtFirstLow.compare_exchange_strong(expected, highStarted.load());
+			}, JobPriority::LOW));
+		}
+
+		for (int i = 0; i < kHighJobs; i++) {
+			high.push_back(JobSystem::GetInstance()->Schedule([&] {
+				highStarted++;
+				Spin(2000);
+			}, JobPriority::HIGH));
+		}
+	}
+
+	WaitAll(high);
+	WaitAll(low);
+
+	// Every HIGH job was popped before the first LOW one, at most one per
+	// worker (and this thread) could still be between the pop and its first line
+	CHECK(highStartedAtFirstLow >= kHighJobs - (workers + 1));
+}
+
+TEST_CASE(JobSystemStress) {
+	constexpr int kRounds = 20;
+	constexpr int kJobsPerRound = 2000;
+
+	std::atomic<int> counter = 0;
+
+	for (int round = 0; round < kRounds; round++) {
+		std::vector<JobHandle> roots;
+
+		// Jobs scheduling jobs with dependencies on each other from every
+		// worker at once, across all priorities
+		for (int i = 0; i < kJobsPerRound / 10; i++) {
+			roots.push_back(JobSystem::GetInstance()->Schedule([&counter, i] {
+				std::vector<JobHandle> children;
+				for (int j = 0; j < 9; j++) {
+					std::vector<JobHandle> dependencies;
+					if (j > 0) {
+						dependencies.push_back(children.back());
+					}
+
+					children.push_back(JobSystem::GetInstance()->Schedule([&counter] {
+						counter++;
+					}, dependencies, static_cast<JobPriority>((i + j) % kJobPriorityCount)));
+				}
+
+				WaitAll(children);
+				counter++;
+			}, static_cast<JobPriority>(i % kJobPriorityCount)));
+		}
+
+		WaitAll(roots);
+	}
+
+	CHECK(counter == kRounds * kJobsPerRound);
+}
+
+BENCHMARK(JobSystemThroughput) {
+	constexpr int kJobs = 500000;
+
+	std::atomic<int> counter = 0;
+	std::vector<JobHandle> jobs;
+	jobs.reserve(kJobs);
+
+	double seconds = MeasureSeconds([&] {
+		for (int i = 0; i < kJobs; i++) {
+			jobs.push_back(JobSystem::GetInstance()->Schedule([&counter] {
+				counter++;
+			}));
+		}
+
+		WaitAll(jobs);
+	});
+
+	ReportBenchmark("empty jobs from one thread", kJobs / seconds, "jobs/s");
+
+	jobs.clear();
+	seconds = MeasureSeconds([&] {
+		auto root = JobSystem::GetInstance()->Schedule([&] {
+			std::vector<JobHandle> children;
+			children.reserve(kJobs);
+
+			for (int i = 0; i < kJobs; i++) {
+				children.push_back(JobSystem::GetInstance()->Schedule([&counter] {
+					counter++;
+				}));
+			}
+
+			WaitAll(children);
+		});
+
+		JobSystem::GetInstance()->Wait(root);
+	});
+
+	ReportBenchmark("empty jobs from a worker", kJobs / seconds, "jobs/s");
+}
+
+BENCHMARK(JobSystemParallelSpeedup) {
+	constexpr int kJobs = 512;
+	constexpr int kIterations = 200000;
+
+	std::atomic<uint64_t> sink = 0;
+
+	double serial = MeasureSeconds([&] {
+		for (int i = 0; i < kJobs; i++) {
+			sink += Spin(kIterations);
+		}
+	});
+
+	double parallel = MeasureSeconds([&] {
+		std::vector<JobHandle> jobs;
+		for (int i = 0; i < kJobs; i++) {
+			jobs.push_back(JobSystem::GetInstance()->Schedule([&sink] {
+				sink += Spin(kIterations);
+			}));
+		}
+
+		WaitAll(jobs);
+	});
+
+	ReportBenchmark("workers", JobSystem::GetInstance()->GetWorkerCount(), "");
+	ReportBenchmark("serial", serial * 1000.0, "ms");
+	ReportBenchmark("parallel", parallel * 1000.0, "ms");
+	ReportBenchmark("speedup", serial / parallel, "x");
+}
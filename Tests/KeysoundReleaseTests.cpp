@@ -0,0 +1,34 @@
+#include "TestFramework.hpp"
+#include "../Game/Engine/GameAudioSampleCache.hpp"
+#include <vector>
+
+TEST_CASE(KeysoundReleaseKeepsLongSamplePlaying) {
+	// A 30 s BGM keysound triggered once at 1 s
+	std::vector<double> uses = { 1000.0 };
+	double length = 30000.0;
+
+	CHECK(length > kKeysoundReleaseDelay);
+
+	// Still sounding well past the release delay after its trigger
+	CHECK(GameAudioSampleCache::IsSampleNeeded(uses, 1000.0 + kKeysoundReleaseDelay + 1000.0, length));
+	CHECK(GameAudioSampleCache::IsSampleNeeded(uses, 1000.0 + length, length));
+
+	// Released only once it has ended and the delay has passed
+	CHECK(GameAudioSampleCache::IsSampleNeeded(uses, 1000.0 + length + kKeysoundReleaseDelay - 1.0, length));
+	CHECK(!GameAudioSampleCache::IsSampleNeeded(uses, 1000.0 + length + kKeysoundReleaseDelay + 1.0, length));
+}
+
+TEST_CASE(KeysoundReleaseShortSample) {
+	std::vector<double> uses = { 1000.0, 60000.0 };
+	double length = 200.0;
+
+	CHECK(GameAudioSampleCache::IsSampleNeeded(uses, 1000.0 + length + kKeysoundReleaseDelay - 1.0, length));
+	CHECK(!GameAudioSampleCache::IsSampleNeeded(uses, 1000.0 + length + kKeysoundReleaseDelay + 1.0, length));
+
+	// Kept again as the next use comes within twice the decode lead
+	CHECK(GameAudioSampleCache::IsSampleNeeded(uses, 60000.0 - kKeysoundDecodeLead * 2, length));
+	CHECK(!GameAudioSampleCache::IsSampleNeeded(uses, 60000.0 - kKeysoundDecodeLead * 2 - 1.0, length));
+
+	// Never used before `time` and nothing coming
+	CHECK(!GameAudioSampleCache::IsSampleNeeded({}, 5000.0, length));
+}
@@ -0,0 +1,75 @@
+#include "TestFramework.hpp"
+#include "../Engine/LoudnessMeter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+	// Stereo 1 kHz sine at `dbfs` peak on both channels, `seconds` long
+	std::vector<float> CreateSine(int rate, double dbfs, double seconds) {
+		double amplitude = std::pow(10.0, dbfs / 20.0);
+		size_t frames = static_cast<size_t>(rate * seconds);
+
+		std::vector<float> pcm(frames * 2);
+		for (size_t i = 0; i < frames; i++) {
+			float value = static_cast<float>(amplitude * std::sin(2.0 * 3.14159265358979323846 * 1000.0 * i / rate));
+			pcm[i * 2] = value;
+			pcm[i * 2 + 1] = value;
+		}
+
+		return pcm;
+	}
+
+	// Fed in mixer sized blocks like LoudnessScanner does
+	void Feed(LoudnessMeter& meter, const std::vector<float>& pcm) {
+		constexpr size_t kBlockFrames = 4096;
+
+		size_t frames = pcm.size() / 2;
+		for (size_t frame = 0; frame < frames; frame += kBlockFrames) {
+			meter.Process(pcm.data() + frame * 2, (std::min)(kBlockFrames, frames - frame));
+		}
+	}
+}
+
+TEST_CASE(LoudnessMeterReferenceSine) {
+	for (int rate : { 44100, 48000 }) {
+		LoudnessMeter meter(rate);
+		Feed(meter, CreateSine(rate, -20.0, 10.0));
+
+		CHECK_NEAR(meter.GetIntegratedLoudness(), -20.0, 0.1);
+	}
+}
+
+TEST_CASE(LoudnessMeterSilence) {
+	LoudnessMeter empty(44100);
+	CHECK(empty.GetIntegratedLoudness() == kLoudnessSilence);
+
+	LoudnessMeter meter(44100);
+	Feed(meter, std::vector<float>(44100 * 2 * 5, 0.0f));
+	CHECK(meter.GetIntegratedLoudness() == kLoudnessSilence);
+
+	// Below the absolute gate counts as silence too
+	LoudnessMeter quiet(44100);
+	Feed(quiet, CreateSine(44100, -80.0, 5.0));
+	CHECK(quiet.GetIntegratedLoudness() == kLoudnessSilence);
+}
+
+TEST_CASE(LoudnessMeterRelativeGate) {
+	constexpr int kRate = 48000;
+
+	// The tail alone is well above the absolute gate
+	LoudnessMeter tail(kRate);
+	Feed(tail, CreateSine(kRate, -50.0, 10.0));
+	CHECK_NEAR(tail.GetIntegratedLoudness(), -50.0, 0.1);
+
+	// 5 s loud then 60 s quiet, ungated that would average out near -31 LUFS
+	auto pcm = CreateSine(kRate, -20.0, 5.0);
+	auto quiet = CreateSine(kRate, -50.0, 60.0);
+	pcm.insert(pcm.end(), quiet.begin(), quiet.end());
+
+	LoudnessMeter meter(kRate);
+	Feed(meter, pcm);
+
+	// The quiet blocks fall more than 10 LU under and are gated out
+	CHECK_NEAR(meter.GetIntegratedLoudness(), -20.0, 0.5);
+}
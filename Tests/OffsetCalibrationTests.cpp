@@ -0,0 +1,90 @@
+#include "TestFramework.hpp"
+#include "../Game/Engine/OffsetCalibration.hpp"
+#include <vector>
+
+namespace {
+	constexpr double kStart = 10000.0;
+	constexpr double kInterval = 500.0;
+
+	// One tap per beat, each `errors[i]` ms off its beat
+	OffsetCalibration TapAll(const std::vector<double>& errors) {
+		OffsetCalibration calibration;
+		calibration.SetBeats(kStart, kInterval, static_cast<int>(errors.size()));
+
+		for (size_t i = 0; i < errors.size(); i++) {
+			calibration.AddTap(kStart + i * kInterval + errors[i]);
+		}
+
+		return calibration;
+	}
+}
+
+TEST_CASE(OffsetCalibrationRejectsOutliers) {
+	// Steady 20 ms late with a little jitter, plus two wild taps
+	auto calibration = TapAll({ 18, 22, 19, 21, 20, 23, 17, 20, 21, 19, 180, -150 });
+	auto result = calibration.GetResult();
+
+	CHECK(result.Taps == 12);
+	CHECK(result.Used == 10);
+	CHECK(result.Valid);
+	CHECK_NEAR(result.Mean, 20.0, 0.001);
+	CHECK_NEAR(result.Median, 20.0, 0.001);
+	CHECK(result.StdDev < 2.0);
+}
+
+TEST_CASE(OffsetCalibrationKeepsSteadyTaps) {
+	// Every tap equal, the spread floor keeps them all instead of a zero MAD rejecting any deviation
+	auto calibration = TapAll({ 30, 30, 30, 30, 30, 30, 30, 30, 34 });
+	auto result = calibration.GetResult();
+
+	CHECK(result.Used == 9);
+	CHECK(result.Valid);
+	CHECK_NEAR(result.Median, 30.0, 0.001);
+}
+
+TEST_CASE(OffsetCalibrationIgnoresDuplicateTaps) {
+	OffsetCalibration calibration;
+	calibration.SetBeats(kStart, kInterval, 10);
+
+	for (int i = 0; i < 10; i++) {
+		calibration.AddTap(kStart + i * kInterval + 10);
+
+		// A second tap on the same beat only counts towards Taps
+		calibration.AddTap(kStart + i * kInterval + 60);
+	}
+
+	auto result = calibration.GetResult();
+	CHECK(result.Taps == 20);
+	CHECK(result.Used == 10);
+	CHECK(calibration.GetErrors().size() == 10);
+	CHECK_NEAR(result.Mean, 10.0, 0.001);
+
+	// Before the first beat and after the last by more than half a beat
+	calibration.AddTap(kStart - kInterval);
+	calibration.AddTap(kStart + 10 * kInterval);
+	CHECK(calibration.GetErrors().size() == 10);
+}
+
+TEST_CASE(OffsetCalibrationEvenCountMedian) {
+	auto calibration = TapAll({ 40, 10, 30, 20, 15, 35, 25, 45 });
+	auto result = calibration.GetResult();
+
+	// Average of the two middle errors, 25 and 30
+	CHECK_NEAR(result.Median, 27.5, 0.001);
+	CHECK(result.Used == 8);
+	CHECK(result.Valid);
+	CHECK_NEAR(result.Mean, 27.5, 0.001);
+}
+
+TEST_CASE(OffsetCalibrationNeedsEnoughTaps) {
+	auto calibration = TapAll({ 20, 21, 19, 20, 22, 18, 20 });
+	auto result = calibration.GetResult();
+
+	CHECK(result.Used == 7);
+	CHECK(!result.Valid);
+
+	calibration.Reset();
+	result = calibration.GetResult();
+	CHECK(result.Taps == 0);
+	CHECK(!result.Valid);
+}
@@ -0,0 +1,137 @@
+#include "TestFramework.hpp"
+#include "../Engine/SampleAnalysis.hpp"
+#include <cstring>
+#include <vector>
+
+namespace {
+	// `lead` silent frames, `body` audible ones, `tail` silent ones
+	std::vector<uint8_t> CreateU8(int lead, int body, int tail) {
+		std::vector<uint8_t> pcm(lead + body + tail, 128);
+		for (int i = 0; i < body; i++) {
+			pcm[lead + i] = i % 2 ? 200 : 56;
+		}
+
+		return pcm;
+	}
+
+	std::vector<uint8_t> CreateS16(int lead, int body, int tail, int channels, int audibleChannel) {
+		std::vector<uint8_t> pcm((lead + body + tail) * channels * 2, 0);
+		for (int i = 0; i < body; i++) {
+			int16_t value = i % 2 ? 12000 : -12000;
+			size_t offset = ((lead + i) * channels + audibleChannel) * 2;
+
+			pcm[offset] = static_cast<uint8_t>(value & 0xFF);
+			pcm[offset + 1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+		}
+
+		return pcm;
+	}
+
+	std::vector<uint8_t> CreateF32(const std::vector<float>& samples) {
+		std::vector<uint8_t> pcm(samples.size() * sizeof(float));
+		memcpy(pcm.data(), samples.data(), pcm.size());
+
+		return pcm;
+	}
+}
+
+TEST_CASE(SampleAnalysisFindsU8OnsetAndTail) {
+	auto pcm = CreateU8(100, 50, 30);
+	auto silence = SampleAnalysis::Analyze(pcm.data(), pcm.size(), SampleFormat::U8, 1);
+
+	CHECK(silence.Length == 180);
+	CHECK(silence.Onset == 100);
+	CHECK(silence.Tail == 30);
+	CHECK(!silence.IsSilent());
+}
+
+TEST_CASE(SampleAnalysisFindsS16OnsetAndTail) {
+	/* only the right channel sounds, a frame counts when any channel does */
+	auto pcm = CreateS16(480, 1000, 2400, 2, 1);
+	auto silence = SampleAnalysis::Analyze(pcm.data(), pcm.size(), SampleFormat::S16, 2);
+
+	CHECK(silence.Length == 3880);
+	CHECK(silence.Onset == 480);
+	CHECK(silence.Tail == 2400);
+
+	/* no leading or trailing silence at all */
+	pcm = CreateS16(0, 64, 0, 1, 0);
+	silence = SampleAnalysis::Analyze(pcm.data(), pcm.size(), SampleFormat::S16, 1);
+
+	CHECK(silence.Length == 64);
+	CHECK(silence.Onset == 0);
+	CHECK(silence.Tail == 0);
+}
+
+TEST_CASE(SampleAnalysisFindsF32OnsetAndTail) {
+	/* stereo, noise right at the threshold is still silence */
+	std::vector<float> samples(200 * 2, kSilenceThreshold);
+	samples[40 * 2] = -0.5f;
+	samples[149 * 2 + 1] = 0.25f;
+
+	auto pcm = CreateF32(samples);
+	auto silence = SampleAnalysis::Analyze(pcm.data(), pcm.size(), SampleFormat::F32, 2);
+
+	CHECK(silence.Length == 200);
+	CHECK(silence.Onset == 40);
+	CHECK(silence.Tail == 50);
+}
+
+TEST_CASE(SampleAnalysisSilentSample) {
+	auto pcm = CreateU8(500, 0, 0);
+	auto silence = SampleAnalysis::Analyze(pcm.data(), pcm.size(), SampleFormat::U8, 1);
+
+	CHECK(silence.IsSilent());
+	CHECK(silence.Onset == 500);
+	CHECK(silence.Tail == 0);
+
+	uint32_t lead = 1, tail = 1;
+	SampleAnalysis::GetTrim(silence, 48000, lead, tail);
+	CHECK(lead == 0 && tail == 0);
+
+	/* no data or no channels analyzes as empty */
+	silence = SampleAnalysis::Analyze(nullptr, 0, SampleFormat::S16, 2);
+	CHECK(silence.Length == 0);
+}
+
+TEST_CASE(SampleAnalysisTrimKeepsMargins) {
+	constexpr int kFrequency = 48000;
+
+	/* 2 ms margin and 5 ms minimum lead at 48 kHz */
+	constexpr uint32_t kMargin = 96;
+	constexpr uint32_t kMinimumLead = 240;
+
+	SampleSilence silence = {};
+	silence.Length = 48000;
+	silence.Onset = 1000;
+	silence.Tail = 500;
+
+	uint32_t lead = 0, tail = 0;
+	SampleAnalysis::GetTrim(silence, kFrequency, lead, tail);
+	CHECK(lead == 1000 - kMargin);
+	CHECK(tail == 500 - kMargin);
+
+	/* a lead that would end up under the minimum is left alone */
+	silence.Onset = kMinimumLead + kMargin - 1;
+	SampleAnalysis::GetTrim(silence, kFrequency, lead, tail);
+	CHECK(lead == 0);
+
+	silence.Onset = kMinimumLead + kMargin;
+	SampleAnalysis::GetTrim(silence, kFrequency, lead, tail);
+	CHECK(lead == kMinimumLead);
+
+	/* a tail inside the margin is kept whole */
+	silence.Tail = kMargin;
+	SampleAnalysis::GetTrim(silence, kFrequency, lead, tail);
+	CHECK(tail == 0);
+
+	/* margins scale with the rate */
+	silence.Onset = 1000;
+	silence.Tail = 500;
+	SampleAnalysis::GetTrim(silence, 44100, lead, tail);
+	CHECK(lead == 1000 - 88);
+	CHECK(tail == 500 - 88);
+
+	SampleAnalysis::GetTrim(silence, 0, lead, tail);
+	CHECK(lead == 0 && tail == 0);
+}
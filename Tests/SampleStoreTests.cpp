@@ -0,0 +1,55 @@
+#include "TestFramework.hpp"
+#include "../Game/Data/SampleStore.hpp"
+#include <thread>
+#include <vector>
+
+TEST_CASE(SampleStoreSharesEqualPayloads) {
+	uint64_t hashA = 0, hashB = 0, hashC = 0;
+
+	auto a = SampleStore::Intern(std::vector<uint8_t>{ 1, 2, 3, 4 }, hashA);
+	auto b = SampleStore::Intern(std::vector<uint8_t>{ 1, 2, 3, 4 }, hashB);
+	auto c = SampleStore::Intern(std::vector<uint8_t>{ 1, 2, 3, 5 }, hashC);
+
+	CHECK(a == b);
+	CHECK(a != c);
+	CHECK(hashA == hashB && hashA != hashC);
+
+	/* once the last holder is gone the same content is stored anew */
+	a.reset();
+	b.reset();
+
+	auto d = SampleStore::Intern(std::vector<uint8_t>{ 1, 2, 3, 4 }, hashA);
+	CHECK(d && d->size() == 4 && (*d)[3] == 4);
+}
+
+TEST_CASE(SampleStoreReleasesFromAnyThread) {
+	constexpr int kThreads = 4;
+	constexpr int kRounds = 20000;
+
+	/* threads interning and dropping the same few payloads, the last drop runs while others intern */
+	std::vector<std::thread> threads;
+	for (int t = 0; t < kThreads; t++) {
+		threads.emplace_back([] {
+			for (int i = 0; i < kRounds; i++) {
+				uint64_t hash = 0;
+				auto buffer = SampleStore::Intern(std::vector<uint8_t>(16, static_cast<uint8_t>(i % 8)), hash);
+				CHECK(buffer->size() == 16 && (*buffer)[0] == i % 8);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+TEST_CASE(SampleScanCountsContentOnce) {
+	SampleScan scan;
+
+	CHECK(scan.Add(42, 100));
+	CHECK(!scan.Add(42, 100));
+
+	/* same hash with another size is different content */
+	CHECK(scan.Add(42, 101));
+	CHECK(scan.Add(43, 100));
+}
@@ -0,0 +1,57 @@
+#include "TestFramework.hpp"
+#include "../Game/Data/ScoreDatabase.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+	DB_ScoreRecord MakeRecord(int songId, int score) {
+		DB_ScoreRecord record = {};
+		memset(record.Hash, 'a' + songId, sizeof(record.Hash));
+		record.SongId = songId;
+		record.Rate = 1.0f;
+		record.Score = score;
+
+		return record;
+	}
+}
+
+TEST_CASE(ScoreDatabaseSkipsDamagedRecords) {
+	auto path = std::filesystem::temp_directory_path() / "O2GameScoreTest.db";
+	std::filesystem::remove(path);
+
+	auto db = ScoreDatabase::GetInstance();
+	db->Load(path);
+	for (int i = 0; i < 4; i++) {
+		CHECK(db->Insert(MakeRecord(i, 1000 + i)));
+	}
+
+	// Corrupt the second record and leave half a record at the end
+	{
+		std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+		fs.seekp(sizeof(DB_ScoreHeader) + sizeof(DB_ScoreRecord) + offsetof(DB_ScoreRecord, Score));
+		int score = 999999;
+		fs.write((char*)&score, sizeof(score));
+
+		fs.seekp(0, std::ios::end);
+		DB_ScoreRecord partial = MakeRecord(9, 1);
+		fs.write((char*)&partial, sizeof(DB_ScoreRecord) / 2);
+	}
+
+	db->Load(path);
+	CHECK(db->GetRecordCount() == 3);
+	CHECK(std::filesystem::file_size(path) == sizeof(DB_ScoreHeader) + 4 * sizeof(DB_ScoreRecord));
+
+	DB_ScoreRecord record = {};
+	CHECK(!db->GetSongBest(1, 0, record));
+	CHECK(db->GetSongBest(3, 0, record) && record.Score == 1003);
+
+	// Appends after the trim still land on a record boundary
+	CHECK(db->Insert(MakeRecord(5, 1005)));
+	db->Load(path);
+	CHECK(db->GetRecordCount() == 4);
+	CHECK(db->GetSongBest(5, 0, record) && record.Score == 1005);
+
+	ScoreDatabase::Release();
+	std::filesystem::remove(path);
+}
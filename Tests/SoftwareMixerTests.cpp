@@ -0,0 +1,169 @@
+#include "TestFramework.hpp"
+#include "../Engine/SoftwareMixer.hpp"
+#include "../Engine/MixerSink.hpp"
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	std::vector<float> CreateNoise(size_t frames, int channels, unsigned seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> value(-0.5f, 0.5f);
+
+		std::vector<float> pcm(frames * channels);
+		for (auto& it : pcm) {
+			it = value(random);
+		}
+
+		return pcm;
+	}
+
+	// Renders one second with `voices` voices sounding the whole time
+	void BenchmarkVoices(int voices, float rate, const char* name) {
+		constexpr int kSampleRate = 48000;
+		constexpr int kBuffers = 16;
+		constexpr int kBlockFrames = 512;
+
+		SoftwareMixer mixer(kSampleRate, voices);
+
+		/* longer than the render even at the faster rate, no voice ends early */
+		std::vector<int> buffers;
+		for (int i = 0; i < kBuffers; i++) {
+			buffers.push_back(mixer.AddBuffer(CreateNoise(kSampleRate * 2, i % 2 + 1, i), i % 2 + 1, kSampleRate));
+		}
+
+		NullMixerSink sink;
+		sink.Start(&mixer);
+
+		/* the command queue holds kMixerCommandCapacity triggers per block */
+		for (int i = 0; i < voices; i++) {
+			mixer.Play(buffers[i % kBuffers], 0.1f, (i % 21 - 10) / 10.0f, rate);
+
+			if ((i + 1) % kMixerCommandCapacity == 0) {
+				sink.Render(1, 1);
+			}
+		}
+
+		sink.Render(1, 1);
+		CHECK(mixer.GetActiveVoices() == voices);
+
+		double seconds = MeasureSeconds([&] {
+			sink.Render(kSampleRate, kBlockFrames);
+		});
+
+		CHECK(mixer.GetActiveVoices() == voices);
+		sink.Stop();
+
+		ReportBenchmark(name, 1.0 / seconds, "x realtime");
+		ReportBenchmark((std::string(name) + ", per voice frame").c_str(), seconds * 1e9 / (static_cast<double>(voices) * kSampleRate), "ns");
+	}
+}
+
+TEST_CASE(SoftwareMixerPlayAtStartsMidBlock) {
+	constexpr int kBlockFrames = 333;
+
+	SoftwareMixer mixer(48000);
+
+	/* a click on the first frame, silence after it */
+	std::vector<float> pcm(64, 0.0f);
+	pcm[0] = 1.0f;
+	int buffer = mixer.AddBuffer(pcm, 1, 48000);
+
+	NullMixerSink sink(true);
+	sink.Start(&mixer);
+
+	/* first frame of a block, mid-block, the last frame of one and the first of the next */
+	std::vector<uint64_t> frames = { 999, 1100, 1331, 1332 };
+	for (auto frame : frames) {
+		mixer.PlayAt(frame, buffer, 1.0f);
+	}
+
+	sink.Render(2000, kBlockFrames);
+
+	auto& starts = sink.GetStarts();
+	CHECK(starts.size() == frames.size());
+
+	for (size_t i = 0; i < starts.size() && i < frames.size(); i++) {
+		CHECK(starts[i].Buffer == buffer);
+		CHECK(starts[i].Frame == frames[i]);
+	}
+
+	/* a frame already rendered starts with the next block */
+	mixer.PlayAt(10, buffer, 1.0f);
+	sink.Render(kBlockFrames, kBlockFrames);
+	CHECK(starts.size() == frames.size() + 1 && starts.back().Frame == 2000);
+
+	sink.Stop();
+}
+
+TEST_CASE(SoftwareMixerPlayAtOutputOffset) {
+	constexpr int kBlockFrames = 256;
+
+	SoftwareMixer mixer(48000);
+
+	std::vector<float> pcm(16, 0.0f);
+	pcm[0] = 1.0f;
+	int buffer = mixer.AddBuffer(pcm, 1, 48000);
+
+	mixer.PlayAt(700, buffer, 1.0f);
+
+	/* the click lands on exactly that frame of the output, in both channels */
+	std::vector<float> output(1024 * 2);
+	for (int block = 0; block < 4; block++) {
+		mixer.Render(output.data() + block * kBlockFrames * 2, kBlockFrames);
+	}
+
+	int first = -1;
+	for (size_t i = 0; i < output.size(); i++) {
+		if (output[i] != 0.0f) {
+			first = static_cast<int>(i);
+			break;
+		}
+	}
+
+	CHECK(first == 700 * 2);
+	CHECK(output[700 * 2] == 1.0f && output[700 * 2 + 1] == 1.0f);
+}
+
+TEST_CASE(SoftwareMixerAddsBuffersWhileRendering) {
+	constexpr int kBuffers = 2000;
+
+	SoftwareMixer mixer(48000, 64);
+	NullMixerSink sink(true);
+	sink.Start(&mixer);
+
+	/* a loader adding and triggering buffers while the output thread renders */
+	std::atomic<bool> done = false;
+	std::thread loader([&] {
+		for (int i = 0; i < kBuffers; i++) {
+			int buffer = mixer.AddBuffer(CreateNoise(32, 1, i), 1, 48000);
+			mixer.Play(buffer, 0.5f);
+		}
+
+		done = true;
+	});
+
+	while (!done) {
+		sink.Render(128, 128);
+	}
+
+	loader.join();
+	sink.Render(128, 128);
+
+	auto& starts = sink.GetStarts();
+	CHECK(starts.size() == kBuffers);
+
+	for (size_t i = 0; i < starts.size(); i++) {
+		CHECK(starts[i].Buffer == static_cast<int>(i));
+	}
+
+	sink.Stop();
+}
+
+BENCHMARK(SoftwareMixerManyVoices) {
+	BenchmarkVoices(256, 1.0f, "256 voices, unit rate");
+	BenchmarkVoices(4096, 1.0f, "4096 voices, unit rate");
+	BenchmarkVoices(4096, 1.5f, "4096 voices, resampled");
+}
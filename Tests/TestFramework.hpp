@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Minimal headless test runner. Cases register themselves at static init,
+ * main runs every TEST_CASE by default and every BENCHMARK with --bench.
+ * Nothing here may touch a window, a renderer or an audio device.
+ */
+struct TestCase {
+	const char* Name;
+	std::function<void()> Run;
+	bool Benchmark;
+};
+
+std::vector<TestCase>& GetTestCases();
+void ReportFailure(const char* file, int line, const std::string& expression);
+void ReportBenchmark(const char* name, double value, const char* unit);
+
+struct TestRegistrar {
+	TestRegistrar(const char* name, std::function<void()> run, bool benchmark) {
+		GetTestCases().push_back({ name, run, benchmark });
+	}
+};
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, name, false); \
+	static void name()
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, name, true); \
+	static void name()
+
+#define CHECK(expression) \
+	do { \
+		if (!(expression)) { \
+			ReportFailure(__FILE__, __LINE__, #expression); \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+	do { \
+		double checkActual = static_cast<double>(actual); \
+		double checkExpected = static_cast<double>(expected); \
+		if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) { \
+			ReportFailure(__FILE__, __LINE__, #actual " ~= " #expected " (got " + std::to_string(checkActual) + ", expected " + std::to_string(checkExpected) + ")"); \
+		} \
+	} while (0)
+
+/* wall clock seconds spent in `callback` */
+inline double MeasureSeconds(const std::function<void()>& callback) {
+	auto start = std::chrono::steady_clock::now();
+	callback();
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,71 @@
+#include "TestFramework.hpp"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace {
+	std::mutex g_reportLock;
+	std::atomic<int> g_failures = 0;
+}
+
+std::vector<TestCase>& GetTestCases() {
+	static std::vector<TestCase> cases;
+	return cases;
+}
+
+void ReportFailure(const char* file, int line, const std::string& expression) {
+	std::lock_guard<std::mutex> lock(g_reportLock);
+	g_failures++;
+
+	std::cout << "  " << file << "(" << line << "): CHECK failed: " << expression << std::endl;
+}
+
+void ReportBenchmark(const char* name, double value, const char* unit) {
+	std::lock_guard<std::mutex> lock(g_reportLock);
+
+	std::cout << "  " << name << ": " << value << " " << unit << std::endl;
+}
+
+/*
+ * Tests.exe               run every test
+ * Tests.exe --bench       run every benchmark
+ * Tests.exe [--bench] X   only the cases whose name contains X
+ */
+int main(int argc, char* argv[]) {
+	bool benchmark = false;
+	const char* filter = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--bench") == 0) {
+			benchmark = true;
+		}
+		else {
+			filter = argv[i];
+		}
+	}
+
+	int run = 0, failed = 0;
+	for (auto& test : GetTestCases()) {
+		if (test.Benchmark != benchmark || (filter && !strstr(test.Name, filter))) {
+			continue;
+		}
+
+		std::cout << "[" << (benchmark ? "BENCH" : "RUN") << "] " << test.Name << std::endl;
+
+		int before = g_failures;
+		double seconds = MeasureSeconds(test.Run);
+
+		run++;
+		if (g_failures != before) {
+			failed++;
+			std::cout << "[FAILED] " << test.Name << std::endl;
+		}
+		else {
+			std::cout << "[OK] " << test.Name << " (" << static_cast<int>(seconds * 1000.0) << " ms)" << std::endl;
+		}
+	}
+
+	std::cout << run - failed << "/" << run << " passed" << std::endl;
+	return failed == 0 ? 0 : 1;
+}